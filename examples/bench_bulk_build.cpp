@@ -0,0 +1,85 @@
+// Benchmark: building keyed_vector / ordered_dict element by element
+// vs. in bulk, with the keys hashed in parallel on a thread pool
+
+#include <clue/keyed_vector.hpp>
+#include <clue/flat_hash_map.hpp>
+#include <clue/ordered_dict.hpp>
+#include <clue/thread_pool.hpp>
+#include <clue/timing.hpp>
+#include <clue/sformat.hpp>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+using namespace clue;
+
+using entry_t = std::pair<std::string, size_t>;
+using kvec_t = keyed_vector<size_t, std::string, std::hash<std::string>,
+                            std::allocator<size_t>, flat_hash_map>;
+using dict_t = ordered_dict<std::string, size_t>;
+
+void report(const char *title, const calibrated_timing_result& r, size_t n, double base) {
+    double t = r.elapsed_secs / r.count_runs;
+    std::printf("  %-28s %7.1f ns/entry   speedup: %5.2fx\n",
+        title, t * 1.0e9 / n, base > 0 ? base / t : 1.0);
+}
+
+template<class F>
+calibrated_timing_result measure(F&& f) {
+    return calibrated_time(std::forward<F>(f), 1.0, 1.0e-2);
+}
+
+int main() {
+    const size_t n = 1000000;
+    std::mt19937_64 rng(12345);
+
+    // long-ish keys, so that hashing is a noticeable part of the cost
+    std::vector<entry_t> src(n);
+    for (size_t i = 0; i < n; ++i) {
+        src[i] = entry_t(sstr("session/", rng(), "/", rng()), i);
+    }
+
+    std::printf("bulk build benchmark (n = %zu, %u hardware threads)\n",
+        n, std::thread::hardware_concurrency());
+
+    std::printf("keyed_vector (flat_hash_map index):\n");
+    auto r0 = measure([&](){
+        kvec_t a;
+        for (const entry_t& e: src) a.push_back(e.first, e.second);
+    });
+    double base = r0.elapsed_secs / r0.count_runs;
+    report("push_back", r0, n, 0);
+    report("extend", measure([&](){
+        kvec_t a;
+        a.extend(src.begin(), src.end());
+    }), n, base);
+    for (size_t nt: {1, 8, 32}) {
+        thread_pool pool(nt);
+        report(sstr("extend (", nt, " threads)").c_str(), measure([&](){
+            kvec_t a;
+            a.extend(src.begin(), src.end(), pool);
+        }), n, base);
+        pool.wait_done();
+    }
+
+    std::printf("ordered_dict:\n");
+    auto r1 = measure([&](){
+        dict_t d;
+        for (const entry_t& e: src) d.insert(e);
+    });
+    base = r1.elapsed_secs / r1.count_runs;
+    report("insert (one by one)", r1, n, 0);
+    report("insert (range)", measure([&](){
+        dict_t d;
+        d.insert(src.begin(), src.end());
+    }), n, base);
+    for (size_t nt: {1, 8, 32}) {
+        thread_pool pool(nt);
+        report(sstr("insert (", nt, " threads)").c_str(), measure([&](){
+            dict_t d;
+            d.insert(src.begin(), src.end(), pool);
+        }), n, base);
+        pool.wait_done();
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Benchmark: a read-heavy workload on a shared hash map, comparing
+// concurrent_dict (striped shard locks) against an ordered_dict
+// guarded by a single shared_mutex, at increasing thread counts
+
+#include <clue/concurrent_dict.hpp>
+#include <clue/ordered_dict.hpp>
+#include <clue/shared_mutex.hpp>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace clue;
+
+// a baseline: one lock around the whole map
+class locked_dict {
+private:
+    mutable shared_mutex mut_;
+    ordered_dict<uint64_t, uint64_t> dict_;
+
+public:
+    bool find(uint64_t k, uint64_t& v) const {
+        shared_lock<shared_mutex> lk(mut_);
+        auto it = dict_.find(k);
+        if (it == dict_.end()) return false;
+        v = it->second;
+        return true;
+    }
+
+    void insert_or_assign(uint64_t k, uint64_t v) {
+        std::lock_guard<shared_mutex> lk(mut_);
+        dict_[k] = v;
+    }
+};
+
+class striped_dict {
+private:
+    concurrent_dict<uint64_t, uint64_t> dict_;
+
+public:
+    bool find(uint64_t k, uint64_t& v) const {
+        return dict_.find(k, v);
+    }
+
+    void insert_or_assign(uint64_t k, uint64_t v) {
+        dict_.insert_or_assign(k, v);
+    }
+};
+
+// run nt threads, each doing nops operations, of which 1/write_every
+// are writes; returns the throughput in million ops per second
+template<class Dict>
+double run(Dict& d, size_t nt, size_t nkeys, size_t nops, size_t write_every) {
+    std::vector<std::thread> threads;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < nt; ++t) {
+        threads.emplace_back([&d,t,nkeys,nops,write_every](){
+            std::mt19937_64 rng(t + 1);
+            uint64_t v = 0, acc = 0;
+            for (size_t i = 0; i < nops; ++i) {
+                uint64_t k = rng() % nkeys;
+                if (i % write_every == 0) {
+                    d.insert_or_assign(k, i);
+                } else if (d.find(k, v)) {
+                    acc += v;
+                }
+            }
+            if (acc == 1) std::printf(" ");  // keep acc alive
+        });
+    }
+    for (std::thread& th: threads) th.join();
+    double e = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t0).count();
+    return static_cast<double>(nt * nops) / e * 1.0e-6;
+}
+
+template<class Dict>
+void fill(Dict& d, size_t nkeys) {
+    for (size_t k = 0; k < nkeys; ++k) d.insert_or_assign(k, k);
+}
+
+int main() {
+    const size_t nkeys = 100000;
+    const size_t nops = 1000000;
+
+    std::printf("concurrent dict benchmark (%zu keys, %u hardware threads)\n",
+        nkeys, std::thread::hardware_concurrency());
+
+    for (size_t write_every: {20, 4}) {
+        std::printf("%zu%% writes:\n", 100 / write_every);
+        std::printf("  %-8s %24s %24s\n",
+            "threads", "ordered_dict+shared_mutex", "concurrent_dict");
+        for (size_t nt: {1, 2, 4, 8, 16}) {
+            locked_dict a;
+            striped_dict b;
+            fill(a, nkeys);
+            fill(b, nkeys);
+            double ra = run(a, nt, nkeys, nops, write_every);
+            double rb = run(b, nt, nkeys, nops, write_every);
+            std::printf("  %-8zu %18.2f Mop/s %18.2f Mop/s  (%.2fx)\n",
+                nt, ra, rb, rb / ra);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Benchmark: splitting CSV text into fields, with line_stream and
+// foreach_token_of (no quoting), and with clue::csv_reader, on unquoted
+// and quoted input; and extracting typed columns with read_csv_columns
+
+#include <clue/csv.hpp>
+#include <clue/textio.hpp>
+#include <clue/timing.hpp>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace clue;
+
+template<class F>
+double gb_per_sec(const std::string& text, F&& f) {
+    size_t acc = 0;
+    auto r = calibrated_time([&](){ acc += f(); }, 1.0, 1.0e-2);
+    if (acc == 1) std::printf(" ");  // keep acc alive
+    return text.size() * (r.count_runs / r.elapsed_secs) * 1.0e-9;
+}
+
+std::string make_csv(size_t nbytes, bool quoted) {
+    std::mt19937 rng(42);
+    std::string text;
+    text.reserve(nbytes + 256);
+    while (text.size() < nbytes) {
+        text += std::to_string(rng() % 100000);
+        text += ',';
+        text += std::to_string((rng() % 100000) * 0.01);
+        text += ',';
+        if (quoted) text += '"';
+        for (size_t k = 3 + rng() % 12; k > 0; --k) text += static_cast<char>('a' + rng() % 26);
+        if (quoted) text += ", x\"";
+        text += ',';
+        text += std::to_string(rng() % 1000);
+        text += '\n';
+    }
+    return text;
+}
+
+int main() {
+    const size_t nbytes = 64 * 1024 * 1024;
+
+    std::printf("CSV splitting benchmark (GB/s)\n");
+    std::printf("  %10s %18s %12s %14s\n",
+        "input", "foreach_token_of", "csv_reader", "read_columns");
+    for (bool quoted: {false, true}) {
+        std::string text = make_csv(nbytes, quoted);
+
+        double t0 = gb_per_sec(text, [&](){
+            size_t s = 0;
+            for (string_view line: line_stream(text)) {
+                foreach_token_of(line, ',', [&s](const char*, size_t n) {
+                    s += n;
+                    return true;
+                });
+            }
+            return s;
+        });
+        double t1 = gb_per_sec(text, [&](){
+            csv_reader rdr(text);
+            csv_row row;
+            size_t s = 0;
+            while (rdr.next(row)) {
+                for (string_view f: row) s += f.size();
+            }
+            return s;
+        });
+        fast_vector<int> c0, c3;
+        fast_vector<double> c1;
+        double t2 = gb_per_sec(text, [&](){
+            c0.clear(); c1.clear(); c3.clear();
+            csv_reader rdr(text);
+            return read_csv_columns(rdr,
+                csv_column(0, c0), csv_column(1, c1), csv_column(3, c3));
+        });
+        std::printf("  %10s %18.2f %12.2f %14.2f\n",
+            quoted ? "quoted" : "unquoted", t0, t1, t2);
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Benchmark: hashing strings of various lengths with std::hash<std::string>,
+// byte-at-a-time FNV-1a, and clue::hash_bytes
+
+#include <clue/hash.hpp>
+#include <clue/string_view.hpp>
+#include <clue/timing.hpp>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+inline uint64_t fnv1a(const char* p, size_t n) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+template<class F>
+double ns_per_key(const std::vector<std::string>& keys, F&& f) {
+    size_t acc = 0;
+    auto r = calibrated_time([&](){
+        for (const std::string& k: keys) acc += f(k);
+    }, 1.0, 1.0e-2);
+    if (acc == 1) std::printf(" ");  // keep acc alive
+    return r.elapsed_secs / r.count_runs / keys.size() * 1.0e9;
+}
+
+int main() {
+    const size_t nkeys = 10000;
+    std::mt19937_64 rng(42);
+
+    std::printf("string hashing benchmark (ns per key)\n");
+    std::printf("  %6s %12s %12s %12s\n", "length", "std::hash", "fnv1a", "hash_bytes");
+    for (size_t len: {4, 8, 16, 24, 32, 64, 128, 1024}) {
+        std::vector<std::string> keys(nkeys);
+        for (std::string& k: keys) {
+            k.resize(len);
+            for (char& c: k) c = static_cast<char>('a' + rng() % 26);
+        }
+        double t0 = ns_per_key(keys, [](const std::string& k) {
+            return std::hash<std::string>()(k);
+        });
+        double t1 = ns_per_key(keys, [](const std::string& k) {
+            return static_cast<size_t>(fnv1a(k.data(), k.size()));
+        });
+        double t2 = ns_per_key(keys, [](const std::string& k) {
+            return static_cast<size_t>(hash_bytes(k.data(), k.size()));
+        });
+        std::printf("  %6zu %12.2f %12.2f %12.2f\n", len, t0, t1, t2);
+    }
+    return 0;
+}
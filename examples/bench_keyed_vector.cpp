@@ -0,0 +1,82 @@
+// Benchmark: keyed_vector with the std::unordered_map index
+// vs. the flat_hash_map (SwissTable-style) index
+
+#include <clue/keyed_vector.hpp>
+#include <clue/flat_hash_map.hpp>
+#include <clue/timing.hpp>
+#include <clue/sformat.hpp>
+#include <cstdio>
+#include <random>
+
+using namespace clue;
+
+template<class Key>
+using std_kvec = keyed_vector<size_t, Key>;
+
+template<class Key>
+using flat_kvec = keyed_vector<size_t, Key, std::hash<Key>,
+                               std::allocator<size_t>, flat_hash_map>;
+
+template<class KVec, class Key>
+void build(KVec& a, const std::vector<Key>& keys, bool presize) {
+    a.clear();
+    if (presize) a.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        a.push_back(keys[i], i);
+    }
+}
+
+template<class KVec, class Key>
+size_t lookup(const KVec& a, const std::vector<Key>& queries) {
+    size_t s = 0;
+    for (const Key& k: queries) {
+        auto it = a.find(k);
+        if (it != a.end()) s += *it;
+    }
+    return s;
+}
+
+template<class KVec, class Key>
+void bench(const char *title,
+           const std::vector<Key>& keys,
+           const std::vector<Key>& queries) {
+    KVec a;
+    auto r_ins = calibrated_time([&](){ build(a, keys, false); }, 1.0, 1.0e-2);
+    auto r_res = calibrated_time([&](){ build(a, keys, true); }, 1.0, 1.0e-2);
+
+    volatile size_t sink = 0;
+    auto r_lookup = calibrated_time([&](){ sink += lookup(a, queries); }, 1.0, 1.0e-2);
+
+    double n = static_cast<double>(keys.size());
+    double q = static_cast<double>(queries.size());
+    std::printf("  %-24s insert: %7.2f ns/key   insert (reserved): %7.2f ns/key"
+                "   lookup: %7.2f ns/query\n",
+        title,
+        r_ins.elapsed_secs * 1.0e9 / (r_ins.count_runs * n),
+        r_res.elapsed_secs * 1.0e9 / (r_res.count_runs * n),
+        r_lookup.elapsed_secs * 1.0e9 / (r_lookup.count_runs * q));
+}
+
+int main() {
+    const size_t n = 1000000;
+    std::mt19937_64 rng(12345);
+
+    // half of the queries hit, the other half miss
+    std::vector<uint64_t> ikeys(n), iqueries(n);
+    for (size_t i = 0; i < n; ++i) ikeys[i] = rng();
+    for (size_t i = 0; i < n; ++i) iqueries[i] = (i % 2 == 0) ? ikeys[(i * 7919) % n] : rng();
+
+    std::vector<std::string> skeys(n), squeries(n);
+    for (size_t i = 0; i < n; ++i) skeys[i] = sstr("key_", ikeys[i]);
+    for (size_t i = 0; i < n; ++i) squeries[i] = sstr("key_", iqueries[i]);
+
+    std::printf("keyed_vector benchmark (n = %zu, 50%% hit rate)\n", n);
+    std::printf("uint64 keys:\n");
+    bench<std_kvec<uint64_t>>("std::unordered_map", ikeys, iqueries);
+    bench<flat_kvec<uint64_t>>("flat_hash_map", ikeys, iqueries);
+
+    std::printf("string keys:\n");
+    bench<std_kvec<std::string>>("std::unordered_map", skeys, squeries);
+    bench<flat_kvec<std::string>>("flat_hash_map", skeys, squeries);
+    return 0;
+}
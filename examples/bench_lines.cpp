@@ -0,0 +1,66 @@
+// Benchmark: splitting a text into lines, with a byte-at-a-time scan
+// (the former line_stream iterator), line_stream (vectorized), and
+// clue::line_offsets, for various average line lengths
+
+#include <clue/textio.hpp>
+#include <clue/timing.hpp>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace clue;
+
+// the line boundaries found by scanning one byte at a time
+inline size_t scalar_count_lines(const std::string& text) {
+    const char* p = text.data();
+    const size_t n = text.size();
+    size_t cnt = 0, e = 0;
+    while (e < n) {
+        while (e < n && p[e] != '\n') e++;
+        if (e < n) e++;
+        cnt++;
+    }
+    return cnt;
+}
+
+template<class F>
+double gb_per_sec(const std::string& text, F&& f) {
+    size_t acc = 0;
+    auto r = calibrated_time([&](){ acc += f(); }, 1.0, 1.0e-2);
+    if (acc == 1) std::printf(" ");  // keep acc alive
+    return text.size() * (r.count_runs / r.elapsed_secs) * 1.0e-9;
+}
+
+int main() {
+    const size_t nbytes = 64 * 1024 * 1024;
+    std::mt19937 rng(42);
+
+    std::printf("line splitting benchmark (GB/s)\n");
+    std::printf("  %8s %12s %12s %12s\n",
+        "line_len", "scalar", "line_stream", "line_offsets");
+    for (size_t len: {8, 20, 80, 200, 1000}) {
+        std::string text;
+        text.reserve(nbytes + 2 * len);
+        while (text.size() < nbytes) {
+            size_t k = len / 2 + rng() % len;
+            for (size_t i = 0; i < k; ++i) text += static_cast<char>('a' + rng() % 26);
+            text += '\n';
+        }
+
+        double t0 = gb_per_sec(text, [&](){
+            return scalar_count_lines(text);
+        });
+        double t1 = gb_per_sec(text, [&](){
+            size_t cnt = 0;
+            for (string_view line: line_stream(text)) cnt += line.size() > 0;
+            return cnt;
+        });
+        fast_vector<uint32_t> offs;
+        double t2 = gb_per_sec(text, [&](){
+            line_offsets(text, offs);
+            return offs.size();
+        });
+        std::printf("  %8zu %12.2f %12.2f %12.2f\n", len, t0, t1, t2);
+    }
+    return 0;
+}
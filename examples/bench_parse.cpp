@@ -0,0 +1,150 @@
+// Benchmark: parsing integers and floating-point numbers from strings,
+// with strtol/strtod (on which try_parse was built before), with
+// try_parse, and with clue::from_chars; and parsing a buffer of
+// delimited numbers, token by token, and with clue::parse_numbers
+
+#include <clue/stringex.hpp>
+#include <clue/charconv.hpp>
+#include <clue/parse_numbers.hpp>
+#include <clue/timing.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace clue;
+
+template<class F>
+double mvals_per_sec(size_t n, F&& f) {
+    double acc = 0;
+    auto r = calibrated_time([&](){ acc += f(); }, 1.0, 1.0e-2);
+    if (acc == 1.2345) std::printf(" ");  // keep acc alive
+    return n * (r.count_runs / r.elapsed_secs) * 1.0e-6;
+}
+
+int main() {
+    const size_t n = 100000;
+    std::mt19937_64 rng(42);
+    std::vector<std::string> ints(n), reals(n);
+    char buf[64];
+    for (size_t i = 0; i < n; ++i) {
+        ints[i] = std::to_string(static_cast<long>(rng() % 100000000) - 50000000);
+        std::snprintf(buf, sizeof(buf), "%.*g", static_cast<int>(rng() % 12) + 4,
+            (rng() % 10000000) * 1.0e-3);
+        reals[i] = buf;
+    }
+
+    auto int_strtol = [&]() {
+        long s = 0;
+        for (const std::string& t: ints) s += std::strtol(t.c_str(), nullptr, 10);
+        return static_cast<double>(s);
+    };
+    auto int_try_parse = [&]() {
+        long s = 0, x = 0;
+        for (const std::string& t: ints) {
+            if (try_parse(string_view(t), x)) s += x;
+        }
+        return static_cast<double>(s);
+    };
+    auto int_from_chars = [&]() {
+        long s = 0, x = 0;
+        for (const std::string& t: ints) {
+            from_chars(t.data(), t.data() + t.size(), x);
+            s += x;
+        }
+        return static_cast<double>(s);
+    };
+
+    auto real_strtod = [&]() {
+        double s = 0;
+        for (const std::string& t: reals) s += std::strtod(t.c_str(), nullptr);
+        return s;
+    };
+    auto real_try_parse = [&]() {
+        double s = 0, x = 0;
+        for (const std::string& t: reals) {
+            if (try_parse(string_view(t), x)) s += x;
+        }
+        return s;
+    };
+    auto real_from_chars = [&]() {
+        double s = 0, x = 0;
+        for (const std::string& t: reals) {
+            from_chars(t.data(), t.data() + t.size(), x);
+            s += x;
+        }
+        return s;
+    };
+
+    std::printf("parsing %zu values (millions per second):\n", n);
+    std::printf("  %-20s %10s %10s\n", "", "long", "double");
+    std::printf("  %-20s %10.1f %10.1f\n", "strtol / strtod",
+        mvals_per_sec(n, int_strtol), mvals_per_sec(n, real_strtod));
+    std::printf("  %-20s %10.1f %10.1f\n", "try_parse",
+        mvals_per_sec(n, int_try_parse), mvals_per_sec(n, real_try_parse));
+    std::printf("  %-20s %10.1f %10.1f\n", "from_chars",
+        mvals_per_sec(n, int_from_chars), mvals_per_sec(n, real_from_chars));
+
+    // a buffer of 2M numbers, 10 per line (about 14 MB of floats)
+    const size_t nb = 2000000;
+    std::string ibuf, rbuf;
+    for (size_t i = 0; i < nb; ++i) {
+        const char d = (i % 10 == 9) ? '\n' : ',';
+        ibuf += ints[i % n];
+        ibuf += d;
+        rbuf += reals[i % n];
+        rbuf += d;
+    }
+
+    auto tokens_int = [&]() {
+        fast_vector<long> xs;
+        foreach_token_of(view(ibuf), ",\n", [&](const char* p, size_t m) {
+            long x = 0;
+            if (try_parse(string_view(p, m), x)) xs.push_back(x);
+            return true;
+        });
+        return static_cast<double>(xs.size());
+    };
+    auto tokens_real = [&]() {
+        fast_vector<double> xs;
+        foreach_token_of(view(rbuf), ",\n", [&](const char* p, size_t m) {
+            double x = 0;
+            if (try_parse(string_view(p, m), x)) xs.push_back(x);
+            return true;
+        });
+        return static_cast<double>(xs.size());
+    };
+    auto bulk_int = [&]() {
+        fast_vector<long> xs;
+        return static_cast<double>(parse_numbers(ibuf, ",\n", xs).count);
+    };
+    auto bulk_real = [&]() {
+        fast_vector<double> xs;
+        return static_cast<double>(parse_numbers(rbuf, ",\n", xs).count);
+    };
+
+    const size_t nthreads = std::max(2u, std::thread::hardware_concurrency());
+    thread_pool pool(nthreads);
+    auto par_int = [&]() {
+        fast_vector<long> xs;
+        return static_cast<double>(parse_numbers(pool, ibuf, ",\n", xs).count);
+    };
+    auto par_real = [&]() {
+        fast_vector<double> xs;
+        return static_cast<double>(parse_numbers(pool, rbuf, ",\n", xs).count);
+    };
+
+    std::printf("\nparsing a buffer of %zu values (millions per second):\n", nb);
+    std::printf("  %-28s %10s %10s\n", "", "long", "double");
+    std::printf("  %-28s %10.1f %10.1f\n", "foreach_token_of + try_parse",
+        mvals_per_sec(nb, tokens_int), mvals_per_sec(nb, tokens_real));
+    std::printf("  %-28s %10.1f %10.1f\n", "parse_numbers",
+        mvals_per_sec(nb, bulk_int), mvals_per_sec(nb, bulk_real));
+    std::printf("  %-28s %10.1f %10.1f\n",
+        ("parse_numbers (" + std::to_string(nthreads) + " threads)").c_str(),
+        mvals_per_sec(nb, par_int), mvals_per_sec(nb, par_real));
+    pool.wait_done();
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Benchmark: tokenizing text and finding characters of a set, with
+// delimiter sets of various sizes, by scanning the set for each character
+// (as before), and with a 256-bit table (clue::details::byte_set); and
+// splitting lines into a fresh vector of strings, or into reused views
+
+#include <clue/stringex.hpp>
+#include <clue/timing.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+// the membership test by scanning the set
+struct linear_set {
+    const char* s;
+    bool operator()(char c) const noexcept {
+        const char* p = s;
+        while (*p && *p != c) ++p;
+        return *p != '\0';
+    }
+};
+
+template<class F>
+double mb_per_sec(size_t nbytes, F&& f) {
+    size_t acc = 0;
+    auto r = calibrated_time([&](){ acc += f(); }, 1.0, 1.0e-2);
+    if (acc == 1) std::printf(" ");  // keep acc alive
+    return nbytes * (r.count_runs / r.elapsed_secs) * 1.0e-6;
+}
+
+int main() {
+    const char* all_delims = " ,;:|\t/\\-_=+*&^%$#@!~?.()[]{}<>'\"";
+    const size_t n = 1 << 20;
+
+    std::printf("tokenizing %zu bytes (MB/s):\n", n);
+    std::printf("  %6s %12s %12s %12s %12s\n",
+        "#delim", "tokens/lin", "tokens/tab", "find/lin", "find/tab");
+
+    for (size_t k: {1, 2, 4, 8, 16, 32}) {
+        std::string delims(all_delims, k);
+
+        // words of 1 - 8 letters, separated by one of the delimiters
+        std::mt19937 rng(42);
+        std::string text;
+        while (text.size() < n) {
+            size_t len = rng() % 8 + 1;
+            for (size_t i = 0; i < len; ++i) text.push_back(static_cast<char>('a' + rng() % 26));
+            text.push_back(delims[rng() % k]);
+        }
+        text.resize(n);
+        string_view sv(text);
+
+        auto count = [](const char*, size_t) { return true; };
+        auto tokens_lin = [&]() {
+            size_t c = 0;
+            details::foreach_token_of_(sv, linear_set{delims.c_str()},
+                [&](const char* p, size_t m) { c += count(p, m); return true; });
+            return c;
+        };
+        auto tokens_tab = [&]() {
+            size_t c = 0;
+            foreach_token_of(sv, delims.c_str(),
+                [&](const char* p, size_t m) { c += count(p, m); return true; });
+            return c;
+        };
+
+        // the positions of all delimiters
+        auto find_lin = [&]() {
+            size_t c = 0;
+            linear_set pred{delims.c_str()};
+            const char* p = sv.data();
+            const char* e = p + sv.size();
+            while ((p = std::find_if(p, e, pred)) != e) {
+                ++c;
+                ++p;
+            }
+            return c;
+        };
+        auto find_tab = [&]() {
+            size_t c = 0;
+            size_t i = 0;
+            while ((i = sv.find_first_of(delims, i)) != string_view::npos) {
+                ++c;
+                ++i;
+            }
+            return c;
+        };
+
+        std::printf("  %6zu %12.1f %12.1f %12.1f %12.1f\n", k,
+            mb_per_sec(n, tokens_lin), mb_per_sec(n, tokens_tab),
+            mb_per_sec(n, find_lin), mb_per_sec(n, find_tab));
+    }
+
+    // lines of 12 numeric fields
+    std::mt19937 rng(7);
+    std::vector<std::string> lines(20000);
+    size_t nbytes = 0;
+    for (std::string& ln: lines) {
+        for (int j = 0; j < 12; ++j) {
+            if (j > 0) ln += ", ";
+            ln += std::to_string(rng() % 100000);
+        }
+        nbytes += ln.size();
+    }
+
+    auto split_strings = [&]() {
+        size_t c = 0;
+        for (const std::string& ln: lines) {
+            std::vector<std::string> fs;
+            foreach_token_of(view(ln), ", ", [&](const char* p, size_t m) {
+                fs.emplace_back(p, m);
+                return true;
+            });
+            c += fs.back().size();
+        }
+        return c;
+    };
+    auto split_views = [&]() {
+        size_t c = 0;
+        fast_vector<string_view, 16> fs;
+        for (const std::string& ln: lines) {
+            split_into(view(ln), ", ", fs);
+            c += fs.back().size();
+        }
+        return c;
+    };
+    std::array<string_view, 4> fs4;
+    auto split_array = [&]() {
+        size_t c = 0;
+        std::array<string_view, 4>& fs = fs4;
+        for (const std::string& ln: lines) {
+            split_into(view(ln), ", ", fs);
+            c += fs[3].size();
+        }
+        return c;
+    };
+    const std::array<size_t, 2> idx{{2, 5}};
+    auto split_sel = [&]() {
+        size_t c = 0;
+        fast_vector<string_view, 16> fs;
+        for (const std::string& ln: lines) {
+            split_select(view(ln), ", ", idx, fs);
+            c += fs[1].size();
+        }
+        return c;
+    };
+
+    std::printf("\nsplitting %zu lines of 12 fields (MB/s):\n", lines.size());
+    std::printf("  %-36s %10.1f\n", "into std::vector<std::string>", mb_per_sec(nbytes, split_strings));
+    std::printf("  %-36s %10.1f\n", "split_into (fast_vector, reused)", mb_per_sec(nbytes, split_views));
+    std::printf("  %-36s %10.1f\n", "split_into (first 4, std::array)", mb_per_sec(nbytes, split_array));
+    std::printf("  %-36s %10.1f\n", "split_select (fields 2 and 5)", mb_per_sec(nbytes, split_sel));
+    return 0;
+}
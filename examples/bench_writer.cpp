@@ -0,0 +1,116 @@
+// Benchmark: writing a table of integers and floating-point numbers as
+// text, with std::ostringstream, and with clue::text_writer; and
+// formatting single numbers, with snprintf, and with clue::to_chars
+
+#include <clue/text_writer.hpp>
+#include <clue/timing.hpp>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+template<class F>
+double m_per_sec(size_t n, F&& f) {
+    size_t acc = 0;
+    auto r = calibrated_time([&](){ acc += f(); }, 1.0, 1.0e-2);
+    if (acc == 1) std::printf(" ");  // keep acc alive
+    return n * (r.count_runs / r.elapsed_secs) * 1.0e-6;
+}
+
+template<class F>
+double mb_per_sec(size_t nbytes, F&& f) {
+    size_t acc = 0;
+    auto r = calibrated_time([&](){ acc += f(); }, 1.0, 1.0e-2);
+    if (acc == 1) std::printf(" ");  // keep acc alive
+    return nbytes * (r.count_runs / r.elapsed_secs) * 1.0e-6;
+}
+
+int main() {
+    const size_t n = 100000;
+    std::mt19937 rng(42);
+    std::vector<int> ids(n);
+    std::vector<long> counts(n);
+    std::vector<double> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        ids[i] = static_cast<int>(i);
+        counts[i] = static_cast<long>(rng() % 1000000);
+        values[i] = (rng() % 1000000) * 0.001;
+    }
+
+    auto with_ostream = [&]() {
+        std::ostringstream out;
+        for (size_t i = 0; i < n; ++i)
+            out << ids[i] << ',' << counts[i] << '\n';
+        return out.str().size();
+    };
+    auto with_writer = [&]() {
+        text_writer out;
+        for (size_t i = 0; i < n; ++i)
+            out << ids[i] << ',' << counts[i] << '\n';
+        return out.size();
+    };
+    auto with_ostream_f = [&]() {
+        std::ostringstream out;
+        out.precision(15);
+        for (size_t i = 0; i < n; ++i)
+            out << ids[i] << ',' << values[i] << '\n';
+        return out.str().size();
+    };
+    auto with_writer_f = [&]() {
+        text_writer out;
+        for (size_t i = 0; i < n; ++i)
+            out << ids[i] << ',' << values[i] << '\n';
+        return out.size();
+    };
+
+    const size_t ni = with_writer();
+    const size_t nf = with_writer_f();
+    std::printf("writing %zu rows (MB/s):\n", n);
+    std::printf("  %-24s %10s %10s\n", "", "ints", "floats");
+    std::printf("  %-24s %10.1f %10.1f\n", "std::ostringstream",
+        mb_per_sec(ni, with_ostream), mb_per_sec(nf, with_ostream_f));
+    std::printf("  %-24s %10.1f %10.1f\n", "text_writer",
+        mb_per_sec(ni, with_writer), mb_per_sec(nf, with_writer_f));
+
+    // numbers with all digits significant, where "%.17g" is needed
+    // for snprintf to read back exactly
+    std::vector<double> reals(n);
+    for (size_t i = 0; i < n; ++i)
+        reals[i] = std::uniform_real_distribution<double>(-1.0e6, 1.0e6)(rng);
+    char buf[32];
+    auto snprintf_i = [&]() {
+        size_t m = 0;
+        for (size_t i = 0; i < n; ++i)
+            m += std::snprintf(buf, sizeof(buf), "%ld", counts[i]);
+        return m;
+    };
+    auto to_chars_i = [&]() {
+        size_t m = 0;
+        for (size_t i = 0; i < n; ++i)
+            m += to_chars(buf, buf + sizeof(buf), counts[i]).ptr - buf;
+        return m;
+    };
+    auto snprintf_f = [&]() {
+        size_t m = 0;
+        for (size_t i = 0; i < n; ++i)
+            m += std::snprintf(buf, sizeof(buf), "%.17g", reals[i]);
+        return m;
+    };
+    auto to_chars_f = [&]() {
+        size_t m = 0;
+        for (size_t i = 0; i < n; ++i)
+            m += to_chars(buf, buf + sizeof(buf), reals[i]).ptr - buf;
+        return m;
+    };
+
+    std::printf("\nformatting numbers (M/s):\n");
+    std::printf("  %-24s %10s %10s\n", "", "ints", "doubles");
+    std::printf("  %-24s %10.1f %10.1f\n", "snprintf",
+        m_per_sec(n, snprintf_i), m_per_sec(n, snprintf_f));
+    std::printf("  %-24s %10.1f %10.1f\n", "to_chars",
+        m_per_sec(n, to_chars_i), m_per_sec(n, to_chars_f));
+    return 0;
+}
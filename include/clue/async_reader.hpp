@@ -0,0 +1,311 @@
+/**
+ * @file async_reader.hpp
+ *
+ * Reading a file with read-ahead in the background: a dedicated I/O
+ * thread fills a small ring of buffers with pread(2), while the consumer
+ * processes the blocks read before, so that the disk and the CPU work
+ * at the same time. Filled buffers are handed over to the consumer, and
+ * back, without copying.
+ */
+
+#ifndef CLUE_ASYNC_READER__
+#define CLUE_ASYNC_READER__
+
+#include <clue/textio.hpp>
+#include <clue/memscan.hpp>
+#include <clue/concurrent_queue.hpp>
+
+#ifdef CLUE_HAS_POSIX_IO
+
+#include <atomic>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace clue {
+
+class async_file_reader {
+public:
+    static constexpr size_t default_block_size = 4 * 1024 * 1024;
+    static constexpr size_t default_num_buffers = 3;
+
+    // A block of the file, which holds a buffer of the reader until it
+    // is released (by release(), destruction, or assignment). It is
+    // movable but not copyable, and must not outlive the reader.
+    class block {
+    private:
+        async_file_reader* r_;
+        size_t buf_;
+        const char* data_;
+        size_t size_;
+        uint64_t offset_;
+
+        friend class async_file_reader;
+
+        block(async_file_reader* r, size_t b, const char* data, size_t n, uint64_t off) noexcept
+            : r_(r), buf_(b), data_(data), size_(n), offset_(off) {}
+
+    public:
+        block() noexcept
+            : r_(nullptr), buf_(0), data_(nullptr), size_(0), offset_(0) {}
+
+        block(const block&) = delete;
+        block& operator=(const block&) = delete;
+
+        block(block&& other) noexcept
+            : r_(other.r_), buf_(other.buf_), data_(other.data_)
+            , size_(other.size_), offset_(other.offset_) {
+            other.r_ = nullptr;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+
+        block& operator=(block&& other) noexcept {
+            if (this != &other) {
+                release();
+                r_ = other.r_;
+                buf_ = other.buf_;
+                data_ = other.data_;
+                size_ = other.size_;
+                offset_ = other.offset_;
+                other.r_ = nullptr;
+                other.data_ = nullptr;
+                other.size_ = 0;
+            }
+            return *this;
+        }
+
+        ~block() {
+            release();
+        }
+
+        const char* data() const noexcept { return data_; }
+        size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+
+        // the offset of the block in the file
+        uint64_t offset() const noexcept { return offset_; }
+
+        string_view view() const noexcept {
+            return string_view(data_, size_);
+        }
+
+        // return the buffer to the reader, to be filled again
+        void release() noexcept {
+            if (r_) {
+                r_->free_.push(buf_);
+                r_ = nullptr;
+                data_ = nullptr;
+                size_ = 0;
+            }
+        }
+    };
+
+private:
+    struct filled_ {
+        size_t buf;
+        size_t size;
+        uint64_t offset;
+        bool eof;
+        std::exception_ptr err;
+    };
+
+    static constexpr size_t stop_signal_ = static_cast<size_t>(-1);
+
+    int fd_;
+    size_t bsize_;
+    std::vector<char*> bufs_;
+    concurrent_queue<size_t> free_;     // the buffers to be filled
+    concurrent_queue<filled_> ready_;   // the buffers filled, in order
+    std::atomic<bool> stop_;
+    bool done_;
+    std::thread th_;
+
+public:
+    // block_size: the size of each buffer, i.e. the size of each read
+    // nbuffers:   the number of buffers (at least 2), e.g. 2 for double
+    //             buffering, 3 for triple buffering
+    explicit async_file_reader(const std::string& filename,
+                               size_t block_size = default_block_size,
+                               size_t nbuffers = default_num_buffers)
+        : fd_(-1)
+        , bsize_(block_size > 0 ? block_size : 1)
+        , stop_(false)
+        , done_(false) {
+        if (nbuffers < 2) throw
+            std::invalid_argument("async_file_reader: nbuffers must be at least 2.");
+        fd_ = ::open(filename.c_str(), O_RDONLY);
+        if (fd_ < 0) throw
+            std::runtime_error(std::string("Failed to open file ") + filename);
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        try {
+            for (size_t i = 0; i < nbuffers; ++i) {
+                bufs_.push_back(static_cast<char*>(aligned_alloc(bsize_, 64)));
+                free_.push(i);
+            }
+            th_ = std::thread([this](){ run_(); });
+        } catch (...) {
+            destroy_();
+            throw;
+        }
+    }
+
+    async_file_reader(const async_file_reader&) = delete;
+    async_file_reader& operator=(const async_file_reader&) = delete;
+
+    ~async_file_reader() {
+        if (th_.joinable()) {
+            stop_ = true;
+            free_.push(size_t(stop_signal_));
+            th_.join();
+        }
+        destroy_();
+    }
+
+    size_t block_size() const noexcept {
+        return bsize_;
+    }
+
+    size_t num_buffers() const noexcept {
+        return bufs_.size();
+    }
+
+    // get the next block (releasing the one held by b), waiting for it
+    // to be read if needed; it returns false at the end of the file, and
+    // rethrows the exception if reading fails. The consumer must not hold
+    // all buffers when calling this.
+    bool next(block& b) {
+        b.release();
+        if (done_) return false;
+        filled_ f = ready_.wait_pop();
+        if (f.err) {
+            done_ = true;
+            std::rethrow_exception(f.err);
+        }
+        if (f.eof) {
+            done_ = true;
+            return false;
+        }
+        b = block(this, f.buf, bufs_[f.buf], f.size, f.offset);
+        return true;
+    }
+
+private:
+    // the I/O thread
+    void run_() {
+        uint64_t off = 0;
+        for(;;) {
+            const size_t b = free_.wait_pop();
+            if (b == stop_signal_ || stop_) return;
+            filled_ f{b, 0, off, false, nullptr};
+            try {
+                // fill the buffer entirely, unless at the end of the file
+                char* p = bufs_[b];
+                while (f.size < bsize_) {
+                    ssize_t r = ::pread(fd_, p + f.size, bsize_ - f.size,
+                                        static_cast<off_t>(off + f.size));
+                    if (r < 0) {
+                        if (errno == EINTR) continue;
+                        throw std::runtime_error("Failed to read file.");
+                    }
+                    if (r == 0) break;
+                    f.size += static_cast<size_t>(r);
+                }
+                f.eof = f.size == 0;
+            } catch (...) {
+                f.err = std::current_exception();
+            }
+            off += f.size;
+            const bool last = f.eof || f.err;
+            ready_.push(std::move(f));
+            if (last) return;
+        }
+    }
+
+    void destroy_() noexcept {
+        for (char* p: bufs_) aligned_free(p);
+        bufs_.clear();
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+};
+
+
+// Read the lines of a file with an async_file_reader. A line within a
+// block refers to the block directly; only a line that spans blocks is
+// copied (to join its parts). Like file_line_reader, each line includes
+// its delimiter '\n' (except possibly the last one), and is valid until
+// the next one is read.
+
+class async_line_reader {
+public:
+    using iterator = details::line_input_iterator<async_line_reader>;
+
+private:
+    async_file_reader rdr_;
+    async_file_reader::block blk_;  // destroyed (released) before rdr_
+    size_t pos_;
+    std::string carry_;     // the parts of a line spanning blocks
+    bool carried_;          // whether the last line was in carry_
+
+public:
+    explicit async_line_reader(const std::string& filename,
+                               size_t block_size = async_file_reader::default_block_size,
+                               size_t nbuffers = async_file_reader::default_num_buffers)
+        : rdr_(filename, block_size, nbuffers)
+        , pos_(0)
+        , carried_(false) {}
+
+    // read the next line, returning false at the end of the file
+    bool next(string_view& line) {
+        if (carried_) {
+            carry_.clear();
+            carried_ = false;
+        }
+        for(;;) {
+            if (pos_ < blk_.size()) {
+                const char* p = blk_.data() + pos_;
+                const size_t n = blk_.size() - pos_;
+                const char* q = find_byte(p, n, '\n');
+                if (q) {
+                    const size_t k = static_cast<size_t>(q - p) + 1;
+                    pos_ += k;
+                    if (carry_.empty()) {
+                        line = string_view(p, k);
+                    } else {
+                        carry_.append(p, k);
+                        line = carry_;
+                        carried_ = true;
+                    }
+                    return true;
+                }
+                carry_.append(p, n);
+                pos_ = blk_.size();
+            }
+            pos_ = 0;
+            if (!rdr_.next(blk_)) {
+                if (carry_.empty()) return false;
+                line = carry_;
+                carried_ = true;
+                return true;
+            }
+        }
+    }
+
+    iterator begin() {
+        return iterator(this);
+    }
+
+    iterator end() {
+        return iterator(nullptr);
+    }
+};
+
+} // end namespace clue
+
+#endif  // CLUE_HAS_POSIX_IO
+
+#endif
@@ -0,0 +1,1042 @@
+/**
+ * @file charconv.hpp
+ *
+ * Locale-free conversion between numbers and character sequences, in the
+ * manner of C++17 std::from_chars and std::to_chars.
+ *
+ * The input is a bounded range [first, last), which need not be
+ * terminated by '\0', so a string_view can be parsed in place. Decimal
+ * integers are converted eight digits at a time (SWAR). Floating-point
+ * numbers are correctly rounded with the Eisel-Lemire algorithm, which
+ * multiplies the decimal significand by a 128-bit approximation of the
+ * power of ten, and falls back to strtod in the rare cases where that is
+ * not precise enough to decide the rounding.
+ *
+ * In the other direction, integers are written two digits at a time, and
+ * floating-point numbers are written with the fewest digits that read
+ * back as the same value (with the Schubfach algorithm, which needs a
+ * single 128-bit multiplication per bound).
+ */
+
+#ifndef CLUE_CHARCONV__
+#define CLUE_CHARCONV__
+
+#include <clue/common.hpp>
+#include <clue/type_traits.hpp>
+#include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+// strtod with a locale argument, for the fallback of the floating-point
+// parsing to be independent of LC_NUMERIC
+#if defined(_MSC_VER)
+#include <locale.h>
+#define CLUE_HAS_STRTOD_L 1
+#elif defined(__GLIBC__) && defined(_GNU_SOURCE)
+#include <locale.h>
+#define CLUE_HAS_STRTOD_L 1
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+#include <locale.h>
+#include <xlocale.h>
+#define CLUE_HAS_STRTOD_L 1
+#endif
+
+namespace clue {
+
+struct from_chars_result {
+    const char* ptr;
+    std::errc ec;
+};
+
+namespace details {
+
+inline bool cc_is_digit(char c) noexcept {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// the value of c as a digit in bases up to 36, or 255
+inline unsigned cc_digit_value(char c) noexcept {
+    if (c >= '0' && c <= '9') return static_cast<unsigned>(c - '0');
+    if (c >= 'a' && c <= 'z') return static_cast<unsigned>(c - 'a' + 10);
+    if (c >= 'A' && c <= 'Z') return static_cast<unsigned>(c - 'A' + 10);
+    return 255;
+}
+
+inline char cc_lower(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// eight digits at a time (SWAR)
+
+inline uint64_t cc_load8(const char* p) noexcept {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+inline bool cc_is_eight_digits(uint64_t v) noexcept {
+    return !(((v + 0x4646464646464646ULL) | (v - 0x3030303030303030ULL)) &
+             0x8080808080808080ULL);
+}
+
+inline uint32_t cc_parse_eight_digits(uint64_t v) noexcept {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL;   // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL;   // 1 + (10000 << 32)
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(v);
+}
+
+// parse the digits of an unsigned integer at [p, last) into v;
+// overflow is set if the value exceeds UINT64_MAX
+inline const char* cc_parse_uint(const char* p, const char* last, int base,
+                                 uint64_t& v, bool& overflow) noexcept {
+    v = 0;
+    overflow = false;
+    if (base == 10) {
+        while (p != last && *p == '0') ++p;
+        const char* s = p;
+        // up to 16 digits cannot overflow
+        if (last - p >= 8) {
+            uint64_t x = cc_load8(p);
+            if (cc_is_eight_digits(x)) {
+                v = cc_parse_eight_digits(x);
+                p += 8;
+                if (last - p >= 8) {
+                    x = cc_load8(p);
+                    if (cc_is_eight_digits(x)) {
+                        v = v * 100000000 + cc_parse_eight_digits(x);
+                        p += 8;
+                    }
+                }
+            }
+        }
+        for (; p != last && cc_is_digit(*p); ++p) {
+            const unsigned d = static_cast<unsigned>(*p - '0');
+            if (CLUE_UNLIKELY(p - s >= 19)) {
+                if (p - s > 19 || v > (UINT64_MAX - d) / 10) {
+                    overflow = true;
+                    continue;
+                }
+            }
+            v = v * 10 + d;
+        }
+    } else {
+        const uint64_t b = static_cast<uint64_t>(base);
+        for (; p != last; ++p) {
+            const unsigned d = cc_digit_value(*p);
+            if (d >= static_cast<unsigned>(base)) break;
+            if (overflow) continue;
+            if (v > (UINT64_MAX - d) / b) {
+                overflow = true;
+            } else {
+                v = v * b + d;
+            }
+        }
+    }
+    return p;
+}
+
+
+// 128-bit arithmetics
+
+struct cc_u128 {
+    uint64_t lo;
+    uint64_t hi;
+};
+
+inline cc_u128 cc_mul128(uint64_t a, uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return cc_u128{static_cast<uint64_t>(r), static_cast<uint64_t>(r >> 64)};
+#else
+    const uint64_t a0 = a & 0xFFFFFFFFu, a1 = a >> 32;
+    const uint64_t b0 = b & 0xFFFFFFFFu, b1 = b >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFFu) + (p10 & 0xFFFFFFFFu);
+    return cc_u128{(mid << 32) | (p00 & 0xFFFFFFFFu),
+                   p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32)};
+#endif
+}
+
+inline int cc_clz64(uint64_t x) noexcept {
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & (uint64_t(1) << 63))) { x <<= 1; ++n; }
+    return n;
+#endif
+}
+
+
+// big integers, as arrays of little-endian 32-bit words, for computing
+// the tables of powers below
+
+// bits [pos, pos + 64) of a big integer
+inline uint64_t cc_big_bits(const uint32_t* w, int n, int pos) noexcept {
+    uint64_t r = 0;
+    for (int i = 0; i < 64; ++i) {
+        const int b = pos + i;
+        if (b >= 0 && b < n * 32 && ((w[b / 32] >> (b % 32)) & 1u))
+            r |= uint64_t(1) << i;
+    }
+    return r;
+}
+
+inline int cc_big_length(const uint32_t* w, int n) noexcept {
+    while (n > 0 && w[n - 1] == 0) --n;
+    if (n == 0) return 0;
+    int k = 32;
+    while (!((w[n - 1] >> (k - 1)) & 1u)) --k;
+    return (n - 1) * 32 + k;
+}
+
+inline void cc_big_mul_small(uint32_t* w, int n, uint32_t m) noexcept {
+    uint64_t c = 0;
+    for (int i = 0; i < n; ++i) {
+        c += static_cast<uint64_t>(w[i]) * m;
+        w[i] = static_cast<uint32_t>(c);
+        c >>= 32;
+    }
+}
+
+inline void cc_big_div_small(uint32_t* w, int n, uint32_t d) noexcept {
+    uint64_t r = 0;
+    for (int i = n - 1; i >= 0; --i) {
+        r = (r << 32) | w[i];
+        w[i] = static_cast<uint32_t>(r / d);
+        r %= d;
+    }
+}
+
+
+// The 128-bit approximations of the powers of five 5^q, q in [-342, 308],
+// normalized so that the most significant bit is set: truncated for
+// q >= 0, and the reciprocals (rounded up for q >= -27, truncated
+// otherwise) for q < 0. They are computed with a simple big integer
+// arithmetic upon the first use, rather than written as a table of 1302
+// literals.
+
+constexpr int cc_smallest_pow5 = -342;
+constexpr int cc_largest_pow5 = 308;
+
+class cc_pow5_table {
+private:
+    uint64_t v_[2 * (cc_largest_pow5 - cc_smallest_pow5 + 1)];
+
+    // the top 128 bits of a big integer
+    void set_(int q, const uint32_t* w, int n) noexcept {
+        const int s = cc_big_length(w, n) - 128;
+        uint64_t* e = v_ + 2 * (q - cc_smallest_pow5);
+        e[0] = cc_big_bits(w, n, s + 64);
+        e[1] = cc_big_bits(w, n, s);
+    }
+
+public:
+    cc_pow5_table() noexcept {
+        const int nw = 36;  // enough for 5^308 and 2^1088
+        uint32_t w[nw];
+
+        // 5^q for q >= 0
+        std::memset(w, 0, sizeof(w));
+        w[0] = 1;
+        for (int q = 0; q <= cc_largest_pow5; ++q) {
+            set_(q, w, nw);
+            cc_big_mul_small(w, nw, 5);
+        }
+
+        // floor(2^1088 / 5^k) for k = -q > 0
+        std::memset(w, 0, sizeof(w));
+        w[34] = 1;
+        for (int k = 1; k <= -cc_smallest_pow5; ++k) {
+            cc_big_div_small(w, nw, 5);
+            uint64_t* e = v_ + 2 * (-k - cc_smallest_pow5);
+            if (k <= 27) {
+                set_(-k, w, nw);
+                if (++e[1] == 0) ++e[0];
+            } else {
+                uint32_t t[nw];
+                std::memcpy(t, w, sizeof(t));
+                for (int i = 0; i < nw && ++t[i] == 0; ++i) {}
+                set_(-k, t, nw);
+            }
+        }
+    }
+
+    // {high, low} of the entry for 5^q
+    const uint64_t* operator[](int q) const noexcept {
+        return v_ + 2 * (q - cc_smallest_pow5);
+    }
+};
+
+inline const cc_pow5_table& cc_pow5() {
+    static const cc_pow5_table t;
+    return t;
+}
+
+
+// the binary formats
+
+template<typename T> struct cc_binary;
+
+template<> struct cc_binary<double> {
+    using bits_type = uint64_t;
+    static constexpr int mantissa_bits() { return 52; }
+    static constexpr int minimum_exponent() { return -1023; }
+    static constexpr int infinite_power() { return 0x7FF; }
+    static constexpr int smallest_pow10() { return -342; }
+    static constexpr int largest_pow10() { return 308; }
+    static constexpr int min_round_to_even() { return -4; }
+    static constexpr int max_round_to_even() { return 23; }
+    static constexpr int max_fast_pow10() { return 22; }
+    static constexpr uint64_t max_fast_mantissa() { return uint64_t(1) << 53; }
+};
+
+template<> struct cc_binary<float> {
+    using bits_type = uint32_t;
+    static constexpr int mantissa_bits() { return 23; }
+    static constexpr int minimum_exponent() { return -127; }
+    static constexpr int infinite_power() { return 0xFF; }
+    static constexpr int smallest_pow10() { return -65; }
+    static constexpr int largest_pow10() { return 38; }
+    static constexpr int min_round_to_even() { return -17; }
+    static constexpr int max_round_to_even() { return 10; }
+    static constexpr int max_fast_pow10() { return 10; }
+    static constexpr uint64_t max_fast_mantissa() { return uint64_t(1) << 24; }
+};
+
+// a binary floating-point number: mantissa (without the implicit bit),
+// and biased exponent, or power2 < 0 if the result is undecided
+struct cc_adjusted {
+    uint64_t mantissa;
+    int power2;
+};
+
+inline bool operator == (const cc_adjusted& a, const cc_adjusted& b) noexcept {
+    return a.mantissa == b.mantissa && a.power2 == b.power2;
+}
+
+// floor(log2(10^q)) + 63
+inline int cc_power(int q) noexcept {
+    return (((152170 + 65536) * q) >> 16) + 63;
+}
+
+// the binary number nearest to w * 10^q (Eisel-Lemire)
+template<typename T>
+inline cc_adjusted cc_compute_float(int64_t q, uint64_t w) noexcept {
+    using B = cc_binary<T>;
+    const int mb = B::mantissa_bits();
+    if (w == 0 || q < B::smallest_pow10()) return cc_adjusted{0, 0};
+    if (q > B::largest_pow10()) return cc_adjusted{0, B::infinite_power()};
+
+    const int lz = cc_clz64(w);
+    w <<= lz;
+
+    // the product with the 128-bit power of five, of which the first
+    // 64 bits suffice, unless the bits below the mantissa are all ones
+    const uint64_t* p5 = cc_pow5()[static_cast<int>(q)];
+    cc_u128 prod = cc_mul128(w, p5[0]);
+    const uint64_t precision_mask = UINT64_MAX >> (mb + 3);
+    if ((prod.hi & precision_mask) == precision_mask) {
+        cc_u128 second = cc_mul128(w, p5[1]);
+        prod.lo += second.hi;
+        if (second.hi > prod.lo) ++prod.hi;
+        if (prod.lo == UINT64_MAX && (q < -27 || q > 55)) {
+            return cc_adjusted{0, -1};
+        }
+    }
+
+    const int upperbit = static_cast<int>(prod.hi >> 63);
+    const int shift = upperbit + 64 - mb - 3;
+    cc_adjusted a;
+    a.mantissa = prod.hi >> shift;
+    a.power2 = cc_power(static_cast<int>(q)) + upperbit - lz - B::minimum_exponent();
+
+    if (a.power2 <= 0) {
+        // subnormal
+        if (-a.power2 + 1 >= 64) return cc_adjusted{0, 0};
+        a.mantissa >>= -a.power2 + 1;
+        a.mantissa += (a.mantissa & 1);
+        a.mantissa >>= 1;
+        a.power2 = a.mantissa < (uint64_t(1) << mb) ? 0 : 1;
+        a.mantissa &= (uint64_t(1) << mb) - 1;
+        return a;
+    }
+
+    // round half to even, where exactly halfway
+    if (prod.lo <= 1 && q >= B::min_round_to_even() && q <= B::max_round_to_even() &&
+        (a.mantissa & 3) == 1 && (a.mantissa << shift) == prod.hi) {
+        a.mantissa &= ~uint64_t(1);
+    }
+    a.mantissa += (a.mantissa & 1);
+    a.mantissa >>= 1;
+    if (a.mantissa >= (uint64_t(2) << mb)) {
+        a.mantissa = uint64_t(1) << mb;
+        ++a.power2;
+    }
+    a.mantissa &= ~(uint64_t(1) << mb);
+    if (a.power2 >= B::infinite_power()) return cc_adjusted{0, B::infinite_power()};
+    return a;
+}
+
+template<typename T>
+inline T cc_to_float(const cc_adjusted& a, bool neg) noexcept {
+    using B = cc_binary<T>;
+    using bits_t = typename B::bits_type;
+    const int nbits = static_cast<int>(sizeof(bits_t) * 8);
+    bits_t bits = static_cast<bits_t>(
+        a.mantissa | (static_cast<uint64_t>(a.power2) << B::mantissa_bits()) |
+        (static_cast<uint64_t>(neg) << (nbits - 1)));
+    T x;
+    std::memcpy(&x, &bits, sizeof(T));
+    return x;
+}
+
+// the decimal form of a number: w * 10^q
+struct cc_decimal {
+    uint64_t w;
+    int64_t q;
+    bool neg;
+    bool truncated;     // w holds the first 19 significant digits only
+    const char* end;
+};
+
+inline const char* cc_skip_digits(const char* p, const char* last, uint64_t& w) noexcept {
+    while (last - p >= 8) {
+        const uint64_t x = cc_load8(p);
+        if (!cc_is_eight_digits(x)) break;
+        w = w * 100000000 + cc_parse_eight_digits(x);
+        p += 8;
+    }
+    for (; p != last && cc_is_digit(*p); ++p) {
+        w = w * 10 + static_cast<unsigned>(*p - '0');
+    }
+    return p;
+}
+
+// parse [-]digits[.digits][(e|E)[+|-]digits], where at least one digit
+// is required in the significand
+inline bool cc_parse_decimal(const char* p, const char* last, cc_decimal& r) noexcept {
+    r.neg = false;
+    if (p != last && *p == '-') {
+        r.neg = true;
+        ++p;
+    }
+    uint64_t w = 0;
+    const char* int_begin = p;
+    p = cc_skip_digits(p, last, w);
+    const char* int_end = p;
+    int64_t ndigits = int_end - int_begin;
+    int64_t exponent = 0;
+
+    const char* frac_begin = p;
+    const char* frac_end = p;
+    if (p != last && *p == '.') {
+        frac_begin = ++p;
+        p = cc_skip_digits(p, last, w);
+        frac_end = p;
+        exponent = frac_begin - frac_end;
+        ndigits += frac_end - frac_begin;
+    }
+    if (ndigits == 0) return false;
+
+    int64_t exp_number = 0;
+    if (p != last && (*p == 'e' || *p == 'E')) {
+        const char* s = p + 1;
+        bool eneg = false;
+        if (s != last && (*s == '-' || *s == '+')) {
+            eneg = *s == '-';
+            ++s;
+        }
+        if (s != last && cc_is_digit(*s)) {
+            for (; s != last && cc_is_digit(*s); ++s) {
+                if (exp_number < 0x10000000) exp_number = exp_number * 10 + (*s - '0');
+            }
+            if (eneg) exp_number = -exp_number;
+            exponent += exp_number;
+            p = s;
+        }
+        // otherwise, the 'e' is not part of the number
+    }
+    r.end = p;
+    r.truncated = false;
+
+    if (ndigits > 19) {
+        // leading zeros are not significant
+        for (const char* s = int_begin; s != frac_end && (*s == '0' || *s == '.'); ++s) {
+            if (*s == '0') --ndigits;
+        }
+        if (ndigits > 19) {
+            // keep the first 19 significant digits
+            const uint64_t minimal = 1000000000000000000ULL;
+            r.truncated = true;
+            w = 0;
+            const char* s = int_begin;
+            while (w < minimal && s != int_end) w = w * 10 + static_cast<unsigned>(*s++ - '0');
+            if (w >= minimal) {
+                exponent = (int_end - s) + exp_number;
+            } else {
+                s = frac_begin;
+                while (w < minimal && s != frac_end) w = w * 10 + static_cast<unsigned>(*s++ - '0');
+                exponent = (frac_begin - s) + exp_number;
+            }
+        }
+    }
+    r.w = w;
+    r.q = exponent;
+    return true;
+}
+
+// inf, infinity, nan, nan(chars), case-insensitively
+template<typename T>
+inline const char* cc_parse_special(const char* p, const char* last, bool neg, T& x) noexcept {
+    auto match = [&](const char* s, size_t n) {
+        if (static_cast<size_t>(last - p) < n) return false;
+        for (size_t i = 0; i < n; ++i) {
+            if (cc_lower(p[i]) != s[i]) return false;
+        }
+        return true;
+    };
+    if (match("nan", 3)) {
+        p += 3;
+        if (p != last && *p == '(') {
+            const char* s = p + 1;
+            while (s != last && (cc_is_digit(*s) || cc_digit_value(*s) < 36 || *s == '_')) ++s;
+            if (s != last && *s == ')') p = s + 1;
+        }
+        x = neg ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN();
+        return p;
+    }
+    if (match("inf", 3)) {
+        p += match("infinity", 8) ? 8 : 3;
+        x = neg ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+        return p;
+    }
+    return nullptr;
+}
+
+// strtod in the "C" locale (created once), on a bounded copy of [first, last)
+#if defined(_MSC_VER)
+inline _locale_t cc_c_locale() {
+    static const _locale_t loc = _create_locale(LC_NUMERIC, "C");
+    return loc;
+}
+inline double cc_strto(const char* s, char** e, double*) { return _strtod_l(s, e, cc_c_locale()); }
+inline float cc_strto(const char* s, char** e, float*) { return _strtof_l(s, e, cc_c_locale()); }
+inline long double cc_strto(const char* s, char** e, long double*) { return _strtold_l(s, e, cc_c_locale()); }
+#elif defined(CLUE_HAS_STRTOD_L)
+inline locale_t cc_c_locale() {
+    static const locale_t loc = newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+    return loc;
+}
+inline double cc_strto(const char* s, char** e, double*) { return strtod_l(s, e, cc_c_locale()); }
+inline float cc_strto(const char* s, char** e, float*) { return strtof_l(s, e, cc_c_locale()); }
+inline long double cc_strto(const char* s, char** e, long double*) { return strtold_l(s, e, cc_c_locale()); }
+#else
+// (depends on LC_NUMERIC, where no strtod_l is available)
+inline double cc_strto(const char* s, char** e, double*) { return std::strtod(s, e); }
+inline float cc_strto(const char* s, char** e, float*) { return std::strtof(s, e); }
+inline long double cc_strto(const char* s, char** e, long double*) { return std::strtold(s, e); }
+#endif
+
+template<typename T>
+inline const char* cc_strto_bounded(const char* first, const char* last, T& x) {
+    const size_t n = static_cast<size_t>(last - first);
+    char buf[128];
+    std::string tmp;
+    char* s = buf;
+    if (n < sizeof(buf)) {
+        std::memcpy(buf, first, n);
+        buf[n] = '\0';
+    } else {
+        tmp.assign(first, n);
+        s = &tmp[0];
+    }
+    char* e;
+    x = cc_strto(s, &e, static_cast<T*>(nullptr));
+    return first + (e - s);
+}
+
+template<typename T>
+inline from_chars_result cc_from_chars_float(const char* first, const char* last, T& value) {
+    using B = cc_binary<T>;
+    cc_decimal d;
+    if (!cc_parse_decimal(first, last, d)) {
+        const char* p = first;
+        const bool neg = p != last && *p == '-';
+        if (neg) ++p;
+        T x;
+        const char* e = cc_parse_special(p, last, neg, x);
+        if (!e) return from_chars_result{first, std::errc::invalid_argument};
+        value = x;
+        return from_chars_result{e, std::errc()};
+    }
+
+    // exact when both the significand and the power of ten are exact
+    // in T (Clinger's fast path)
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    if (!d.truncated && d.w <= B::max_fast_mantissa() &&
+        d.q >= -B::max_fast_pow10() && d.q <= B::max_fast_pow10()) {
+        static const T pow10[] = {
+            T(1e0), T(1e1), T(1e2), T(1e3), T(1e4), T(1e5), T(1e6), T(1e7),
+            T(1e8), T(1e9), T(1e10), T(1e11), T(1e12), T(1e13), T(1e14), T(1e15),
+            T(1e16), T(1e17), T(1e18), T(1e19), T(1e20), T(1e21), T(1e22)};
+        T x = static_cast<T>(d.w);
+        x = d.q < 0 ? x / pow10[-d.q] : x * pow10[d.q];
+        value = d.neg ? -x : x;
+        return from_chars_result{d.end, std::errc()};
+    }
+#endif
+
+    cc_adjusted a = cc_compute_float<T>(d.q, d.w);
+    if (d.truncated && a.power2 >= 0 && !(a == cc_compute_float<T>(d.q, d.w + 1))) {
+        a.power2 = -1;
+    }
+    T x;
+    if (a.power2 >= 0) {
+        x = cc_to_float<T>(a, d.neg);
+    } else {
+        cc_strto_bounded(first, d.end, x);
+    }
+
+    if (x == 0 ? d.w != 0 : (x - x) != (x - x)) {
+        return from_chars_result{d.end, std::errc::result_out_of_range};
+    }
+    value = x;
+    return from_chars_result{d.end, std::errc()};
+}
+
+} // end namespace details
+
+
+// parse an integer in the given base (2 to 36) at [first, last): an
+// optional '-' (for signed types) followed by digits, without a prefix.
+// Upon success, value is set, and ptr points after the digits; otherwise,
+// value is not altered, and ec is invalid_argument (if there are no
+// digits, with ptr == first) or result_out_of_range.
+
+template<typename T>
+inline enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                   from_chars_result>
+from_chars(const char* first, const char* last, T& value, int base = 10) {
+    const char* p = first;
+    bool neg = false;
+    if (std::is_signed<T>::value && p != last && *p == '-') {
+        neg = true;
+        ++p;
+    }
+    uint64_t v;
+    bool overflow;
+    const char* e = details::cc_parse_uint(p, last, base, v, overflow);
+    if (e == p) return from_chars_result{first, std::errc::invalid_argument};
+
+    using U = typename std::make_unsigned<T>::type;
+    const uint64_t vmax = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (neg ? 1 : 0);
+    if (overflow || v > vmax)
+        return from_chars_result{e, std::errc::result_out_of_range};
+    value = neg ? static_cast<T>(static_cast<U>(0) - static_cast<U>(v))
+                : static_cast<T>(v);
+    return from_chars_result{e, std::errc()};
+}
+
+// parse a floating-point number at [first, last): an optional '-'
+// followed by the decimal (fixed or scientific) notation, or inf,
+// infinity, nan (case-insensitive). The result is correctly rounded
+// (to nearest, ties to even). A value whose magnitude is too large (or
+// too small but not zero) to be represented gives result_out_of_range.
+
+inline from_chars_result from_chars(const char* first, const char* last, double& value) {
+    return details::cc_from_chars_float(first, last, value);
+}
+
+inline from_chars_result from_chars(const char* first, const char* last, float& value) {
+    return details::cc_from_chars_float(first, last, value);
+}
+
+
+//===============================================
+//
+//   Number to characters
+//
+//===============================================
+
+struct to_chars_result {
+    char* ptr;
+    std::errc ec;
+};
+
+namespace details {
+
+// integers: two digits at a time, from a table of 00 - 99
+
+inline const char* cc_digit_pairs() noexcept {
+    static const char tab[201] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+    return tab;
+}
+
+inline int cc_count_digits(uint64_t v) noexcept {
+    int n = 1;
+    for(;;) {
+        if (v < 10) return n;
+        if (v < 100) return n + 1;
+        if (v < 1000) return n + 2;
+        if (v < 10000) return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
+
+// write the decimal digits of v at p (at most 20), and return the end
+// (backwards, with every write at p[k] for k in [0, n), where n is the
+// number of digits, so the bounds are clear to the compiler as well)
+inline char* cc_write_uint(char* p, uint64_t v) noexcept {
+    const char* tab = cc_digit_pairs();
+    const int n = cc_count_digits(v);
+    int k = n;
+    while (k >= 2) {
+        const unsigned i = static_cast<unsigned>(v % 100) * 2;
+        v /= 100;
+        k -= 2;
+        p[k] = tab[i];
+        p[k + 1] = tab[i + 1];
+    }
+    if (k) p[0] = static_cast<char>('0' + v);
+    return p + n;
+}
+
+// the same, in bases 2 to 36
+inline char* cc_write_uint(char* p, uint64_t v, int base) noexcept {
+    if (base == 10) return cc_write_uint(p, v);
+    char buf[64];
+    char* q = buf + 64;
+    const uint64_t b = static_cast<uint64_t>(base);
+    do {
+        *--q = "0123456789abcdefghijklmnopqrstuvwxyz"[v % b];
+        v /= b;
+    } while (v);
+    const size_t n = static_cast<size_t>(buf + 64 - q);
+    std::memcpy(p, q, n);
+    return p + n;
+}
+
+
+// The 128-bit approximations of the powers of ten 10^k, k in [-292, 324],
+// rounded up, and normalized so that the most significant bit is set
+// (i.e. the table of Schubfach and Dragonbox), computed upon the first use.
+
+constexpr int cc_smallest_pow10 = -292;
+constexpr int cc_largest_pow10 = 324;
+
+class cc_pow10_table {
+private:
+    uint64_t v_[2 * (cc_largest_pow10 - cc_smallest_pow10 + 1)];
+
+    // the top 128 bits of a big integer, rounded up if inexact
+    void set_(int k, const uint32_t* w, int n, bool inexact) noexcept {
+        const int s = cc_big_length(w, n) - 128;
+        uint64_t* e = v_ + 2 * (k - cc_smallest_pow10);
+        e[0] = cc_big_bits(w, n, s + 64);
+        e[1] = cc_big_bits(w, n, s);
+        for (int i = 0; i < s && !inexact; ++i) {
+            inexact = ((w[i / 32] >> (i % 32)) & 1u) != 0;
+        }
+        if (inexact && ++e[1] == 0) ++e[0];
+    }
+
+public:
+    cc_pow10_table() noexcept {
+        const int nw = 36;  // enough for 10^324 and 2^1120
+        uint32_t w[nw];
+
+        std::memset(w, 0, sizeof(w));
+        w[0] = 1;
+        for (int k = 0; k <= cc_largest_pow10; ++k) {
+            set_(k, w, nw, false);
+            cc_big_mul_small(w, nw, 10);
+        }
+
+        // floor(2^1120 / 10^k), which is never exact
+        std::memset(w, 0, sizeof(w));
+        w[35] = 1;
+        for (int k = 1; k <= -cc_smallest_pow10; ++k) {
+            cc_big_div_small(w, nw, 10);
+            set_(-k, w, nw, true);
+        }
+    }
+
+    // {high, low} of the entry for 10^k
+    const uint64_t* operator[](int k) const noexcept {
+        return v_ + 2 * (k - cc_smallest_pow10);
+    }
+};
+
+inline const cc_pow10_table& cc_pow10() {
+    static const cc_pow10_table t;
+    return t;
+}
+
+inline int cc_floor_log2_pow10(int e) noexcept {
+    return (e * 1741647) >> 19;
+}
+
+inline int cc_floor_log10_pow2(int e) noexcept {
+    return (e * 1262611) >> 22;
+}
+
+inline int cc_floor_log10_three_quarters_pow2(int e) noexcept {
+    return (e * 1262611 - 524031) >> 22;
+}
+
+// the top bits of g * cp, rounded to odd (with the bits below)
+inline uint64_t cc_round_to_odd(const uint64_t* g, uint64_t cp) noexcept {
+    const cc_u128 x = cc_mul128(g[1], cp);
+    const cc_u128 y = cc_mul128(g[0], cp);
+    const uint64_t lo = y.lo + x.hi;
+    const uint64_t hi = y.hi + (lo < y.lo ? 1 : 0);
+    return hi | (lo > 1 ? 1 : 0);
+}
+
+inline uint32_t cc_round_to_odd(uint64_t g, uint32_t cp) noexcept {
+    const uint64_t b01 = (g & 0xFFFFFFFFu) * cp;
+    const uint64_t b11 = (g >> 32) * cp;
+    const uint64_t hi = b11 + (b01 >> 32);
+    return static_cast<uint32_t>(hi >> 32) | ((hi & 0xFFFFFFFFu) > 1 ? 1u : 0u);
+}
+
+template<typename T> struct cc_schubfach;
+
+template<> struct cc_schubfach<double> {
+    using uint_t = uint64_t;
+    static uint_t round_to_odd(int k, uint_t cp) noexcept {
+        return cc_round_to_odd(cc_pow10()[k], cp);
+    }
+};
+
+template<> struct cc_schubfach<float> {
+    using uint_t = uint32_t;
+    static uint_t round_to_odd(int k, uint_t cp) noexcept {
+        // the first 64 bits of the entry, rounded up
+        const uint64_t* g = cc_pow10()[k];
+        return cc_round_to_odd(g[0] + (g[1] != 0 ? 1 : 0), cp);
+    }
+};
+
+// the shortest decimal d * 10^e that reads back as the (positive,
+// finite) binary number c * 2^q, and is the nearest to it among such
+// decimals (Schubfach); the digits may have trailing zeros
+template<typename T, typename U>
+inline void cc_shortest(U c, int q, bool closer, U& d, int& e) noexcept {
+    using S = cc_schubfach<T>;
+    const bool is_even = (c % 2) == 0;
+    const U cbl = 4 * c - 2 + (closer ? 1 : 0);
+    const U cb = 4 * c;
+    const U cbr = 4 * c + 2;
+
+    const int k = closer ? cc_floor_log10_three_quarters_pow2(q) : cc_floor_log10_pow2(q);
+    const int h = q + cc_floor_log2_pow10(-k) + 1;
+    const U vbl = S::round_to_odd(-k, static_cast<U>(cbl << h));
+    const U vb  = S::round_to_odd(-k, static_cast<U>(cb << h));
+    const U vbr = S::round_to_odd(-k, static_cast<U>(cbr << h));
+    const U lower = vbl + (is_even ? 0 : 1);
+    const U upper = vbr - (is_even ? 0 : 1);
+
+    // one digit fewer, if possible
+    const U s = vb / 4;
+    if (s >= 10) {
+        const U sp = s / 10;
+        const bool up_inside = lower <= 40 * sp;
+        const bool wp_inside = 40 * sp + 40 <= upper;
+        if (up_inside != wp_inside) {
+            d = sp + (wp_inside ? 1 : 0);
+            e = k + 1;
+            return;
+        }
+    }
+    const bool u_inside = lower <= 4 * s;
+    const bool w_inside = 4 * s + 4 <= upper;
+    if (u_inside != w_inside) {
+        d = s + (w_inside ? 1 : 0);
+        e = k;
+        return;
+    }
+    const U mid = 4 * s + 2;
+    const bool round_up = vb > mid || (vb == mid && (s & 1) != 0);
+    d = s + (round_up ? 1 : 0);
+    e = k;
+}
+
+// write digits * 10^e in the shorter of the fixed and the scientific
+// notations (preferring the fixed one), as std::to_chars does
+inline char* cc_write_decimal(char* p, uint64_t digits, int e) noexcept {
+    while (digits % 10 == 0) {
+        digits /= 10;
+        ++e;
+    }
+    char d[20];
+    const int n = static_cast<int>(cc_write_uint(d, digits) - d);
+    const int x = e + n - 1;
+    const int ax = x < 0 ? -x : x;
+    const int sci_len = n + (n > 1 ? 1 : 0) + 2 + (ax >= 100 ? 3 : 2);
+    const int fix_len = e >= 0 ? n + e : (-e < n ? n + 1 : 2 - e);
+
+    if (fix_len <= sci_len) {
+        if (e >= 0) {
+            std::memcpy(p, d, n);
+            std::memset(p + n, '0', e);
+            return p + n + e;
+        } else if (-e < n) {
+            const int m = n + e;
+            std::memcpy(p, d, m);
+            p[m] = '.';
+            std::memcpy(p + m + 1, d + m, -e);
+            return p + n + 1;
+        } else {
+            p[0] = '0';
+            p[1] = '.';
+            std::memset(p + 2, '0', -e - n);
+            std::memcpy(p + 2 - e - n, d, n);
+            return p + 2 - e;
+        }
+    }
+    *p++ = d[0];
+    if (n > 1) {
+        *p++ = '.';
+        std::memcpy(p, d + 1, n - 1);
+        p += n - 1;
+    }
+    *p++ = 'e';
+    *p++ = x < 0 ? '-' : '+';
+    if (ax >= 100) {
+        *p++ = static_cast<char>('0' + ax / 100);
+    }
+    const char* tab = cc_digit_pairs();
+    p[0] = tab[(ax % 100) * 2];
+    p[1] = tab[(ax % 100) * 2 + 1];
+    return p + 2;
+}
+
+// write the shortest representation of x that reads back as x
+// (at most 24 characters for double, and 15 for float)
+template<typename T>
+inline char* cc_write_shortest(char* p, T x) noexcept {
+    using B = cc_binary<T>;
+    using U = typename cc_schubfach<T>::uint_t;
+    const int mb = B::mantissa_bits();
+    const int bias = -B::minimum_exponent() + mb;
+    typename B::bits_type bits;
+    std::memcpy(&bits, &x, sizeof(T));
+    const int nb = static_cast<int>(sizeof(bits) * 8);
+    const U sig = static_cast<U>(bits & ((U(1) << mb) - 1));
+    const int ieee_exp = static_cast<int>((bits >> mb) & static_cast<U>(B::infinite_power()));
+
+    if (bits >> (nb - 1)) *p++ = '-';
+    if (ieee_exp == B::infinite_power()) {
+        std::memcpy(p, sig ? "nan" : "inf", 3);
+        return p + 3;
+    }
+    if (ieee_exp == 0 && sig == 0) {
+        *p = '0';
+        return p + 1;
+    }
+
+    U c;
+    int q;
+    if (ieee_exp != 0) {
+        c = (U(1) << mb) | sig;
+        q = ieee_exp - bias;
+        // integers are exact
+        if (q <= 0 && -q <= mb && (c & ((U(1) << -q) - 1)) == 0) {
+            return cc_write_decimal(p, c >> -q, 0);
+        }
+    } else {
+        c = sig;
+        q = 1 - bias;
+    }
+    U d;
+    int e;
+    cc_shortest<T>(c, q, sig == 0 && ieee_exp > 1, d, e);
+    return cc_write_decimal(p, d, e);
+}
+
+template<typename T>
+inline to_chars_result cc_to_chars_bounded(char* first, char* last, T x) noexcept {
+    const size_t maxlen = 24;
+    if (static_cast<size_t>(last - first) >= maxlen) {
+        return to_chars_result{cc_write_shortest(first, x), std::errc()};
+    }
+    char buf[maxlen];
+    const size_t n = static_cast<size_t>(cc_write_shortest(buf, x) - buf);
+    if (n > static_cast<size_t>(last - first))
+        return to_chars_result{last, std::errc::value_too_large};
+    std::memcpy(first, buf, n);
+    return to_chars_result{first + n, std::errc()};
+}
+
+} // end namespace details
+
+
+// write an integer in the given base (2 to 36, with lowercase letters) to
+// [first, last). Upon success, ptr points after the characters written;
+// otherwise, ec is value_too_large, and ptr is last.
+
+template<typename T>
+inline enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                   to_chars_result>
+to_chars(char* first, char* last, T value, int base = 10) noexcept {
+    using U = typename std::make_unsigned<T>::type;
+    char buf[72];
+    char* p = buf;
+    U u = static_cast<U>(value);
+    if (value < 0) {
+        *p++ = '-';
+        u = static_cast<U>(U(0) - u);
+    }
+    if (last - first >= 24 && base == 10) {
+        // directly, when there is room enough
+        if (p != buf) *first++ = '-';
+        return to_chars_result{details::cc_write_uint(first, u), std::errc()};
+    }
+    p = details::cc_write_uint(p, u, base);
+    const size_t n = static_cast<size_t>(p - buf);
+    if (n > static_cast<size_t>(last - first))
+        return to_chars_result{last, std::errc::value_too_large};
+    std::memcpy(first, buf, n);
+    return to_chars_result{first + n, std::errc()};
+}
+
+// write the shortest representation of a floating-point number that reads
+// back as the same value (with from_chars or strtod), in the fixed or the
+// scientific notation, whichever is shorter (e.g. "0.1", "1e+100", "inf")
+
+inline to_chars_result to_chars(char* first, char* last, double value) noexcept {
+    return details::cc_to_chars_bounded(first, last, value);
+}
+
+inline to_chars_result to_chars(char* first, char* last, float value) noexcept {
+    return details::cc_to_chars_bounded(first, last, value);
+}
+
+} // end namespace clue
+
+#endif
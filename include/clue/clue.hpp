@@ -4,6 +4,7 @@
 #define CLUE_CLUE__
 
 #include <clue/misc.hpp>
+#include <clue/hash.hpp>
 
 // type traits & meta-programming
 #include <clue/type_traits.hpp>
@@ -13,6 +14,8 @@
 // string and formatting
 #include <clue/string_view.hpp>
 #include <clue/stringex.hpp>
+#include <clue/charconv.hpp>
+#include <clue/symbol_table.hpp>
 #include <clue/mparser.hpp>
 #include <clue/sformat.hpp>
 
@@ -23,18 +26,30 @@
 #include <clue/fast_vector.hpp>
 #include <clue/ordered_dict.hpp>
 #include <clue/keyed_vector.hpp>
+#include <clue/flat_map.hpp>
+#include <clue/flat_hash_map.hpp>
+#include <clue/frozen_dict.hpp>
+#include <clue/snapshot.hpp>
 
 // other facilities
 #include <clue/optional.hpp>
 #include <clue/timing.hpp>
 #include <clue/memory.hpp>
 #include <clue/type_name.hpp>
+#include <clue/memscan.hpp>
 #include <clue/textio.hpp>
+#include <clue/csv.hpp>
+#include <clue/parse_numbers.hpp>
+#include <clue/text_writer.hpp>
 
 // concurrency
 #include <clue/shared_mutex.hpp>
 #include <clue/concurrent_queue.hpp>
+#include <clue/concurrent_dict.hpp>
 #include <clue/concurrent_counter.hpp>
 #include <clue/thread_pool.hpp>
+#include <clue/parallel_lines.hpp>
+#include <clue/async_reader.hpp>
+#include <clue/line_index.hpp>
 
 #endif
@@ -0,0 +1,273 @@
+/**
+ * @file concurrent_dict.hpp
+ *
+ * The concurrent_dict class, a hash map that can be shared among
+ * threads. Entries are partitioned into shards by their hash values,
+ * each shard being a flat_hash_map guarded by its own reader-writer
+ * lock, so that operations on different shards do not contend, and
+ * readers of the same shard proceed in parallel.
+ */
+
+#ifndef CLUE_CONCURRENT_DICT__
+#define CLUE_CONCURRENT_DICT__
+
+#include <clue/flat_hash_map.hpp>
+#include <clue/optional.hpp>
+#include <clue/shared_mutex.hpp>
+#include <vector>
+
+namespace clue {
+
+template<class Key,
+         class T,
+         class Hash = std::hash<Key>,
+         class KeyEqual = std::equal_to<Key>,
+         class Allocator = std::allocator<std::pair<Key, T>>>
+class concurrent_dict final {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+    using map_type = flat_hash_map<Key, T, Hash, KeyEqual, Allocator>;
+    using mutex_type = details::rw_spinlock;
+
+    static constexpr size_t default_shard_count = 64;
+
+private:
+    struct shard_body_ {
+        mutable mutex_type mut;
+        map_type map;
+    };
+
+    // pad each shard to a multiple of the cache line size,
+    // such that the locks of different shards do not share a line
+    struct shard_ : public shard_body_ {
+        char pad_[64 - sizeof(shard_body_) % 64];
+    };
+
+    using read_lock = shared_lock<mutex_type>;
+    using write_lock = std::unique_lock<mutex_type>;
+
+    std::unique_ptr<shard_[]> shards_;
+    size_t nshards_;
+    Hash hash_;
+
+public:
+    explicit concurrent_dict(size_t nshards = default_shard_count,
+                             const Hash& hf = Hash(),
+                             const KeyEqual& eq = KeyEqual(),
+                             const Allocator& a = Allocator())
+        : nshards_(shard_count_for_(nshards))
+        , hash_(hf) {
+        shards_.reset(new shard_[nshards_]);
+        for (size_t i = 0; i < nshards_; ++i) {
+            shards_[i].map = map_type(0, hf, eq, a);
+        }
+    }
+
+    concurrent_dict(const concurrent_dict&) = delete;
+    concurrent_dict& operator=(const concurrent_dict&) = delete;
+
+public:
+    size_t shard_count() const noexcept {
+        return nshards_;
+    }
+
+    hasher hash_function() const {
+        return hash_;
+    }
+
+    // the number of entries (all shards are locked while counting)
+    size_type size() const {
+        all_locked_<read_lock> lk(*this);
+        size_t n = 0;
+        for (size_t i = 0; i < nshards_; ++i) n += shards_[i].map.size();
+        return n;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    void clear() {
+        all_locked_<write_lock> lk(*this);
+        for (size_t i = 0; i < nshards_; ++i) shards_[i].map.clear();
+    }
+
+    // reserve room for n entries, assuming they spread evenly over shards
+    void reserve(size_type n) {
+        size_t m = (n + nshards_ - 1) / nshards_;
+        for (size_t i = 0; i < nshards_; ++i) {
+            write_lock lk(shards_[i].mut);
+            shards_[i].map.reserve(m);
+        }
+    }
+
+public:
+    // lookup returns a copy of the value, as a reference into the map
+    // could be invalidated by a concurrent writer
+
+    optional<T> find(const Key& k) const {
+        size_t h = hash_(k);
+        const shard_& s = shard_of_(h);
+        read_lock lk(s.mut);
+        auto it = s.map.find_hashed(h, k);
+        if (it == s.map.end()) return nullopt;
+        return optional<T>(it->second);
+    }
+
+    bool find(const Key& k, T& out) const {
+        size_t h = hash_(k);
+        const shard_& s = shard_of_(h);
+        read_lock lk(s.mut);
+        auto it = s.map.find_hashed(h, k);
+        if (it == s.map.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    size_type count(const Key& k) const {
+        size_t h = hash_(k);
+        const shard_& s = shard_of_(h);
+        read_lock lk(s.mut);
+        return s.map.find_hashed(h, k) == s.map.end() ? 0 : 1;
+    }
+
+    bool contains(const Key& k) const {
+        return count(k) > 0;
+    }
+
+    // invoke f(const T&) on the value associated with k (if any) while
+    // holding the shard in shared mode, which saves a copy of the value.
+    // Returns whether k was found.
+    template<class F>
+    bool visit(const Key& k, F&& f) const {
+        size_t h = hash_(k);
+        const shard_& s = shard_of_(h);
+        read_lock lk(s.mut);
+        auto it = s.map.find_hashed(h, k);
+        if (it == s.map.end()) return false;
+        f(static_cast<const T&>(it->second));
+        return true;
+    }
+
+public:
+    // insert (k, v) if k is absent, returns whether it is inserted
+    template<class M>
+    bool insert(const Key& k, M&& v) {
+        size_t h = hash_(k);
+        shard_& s = shard_of_(h);
+        write_lock lk(s.mut);
+        return s.map.try_emplace_hashed(h, k, std::forward<M>(v)).second;
+    }
+
+    template<class... Args>
+    bool try_emplace(const Key& k, Args&&... args) {
+        size_t h = hash_(k);
+        shard_& s = shard_of_(h);
+        write_lock lk(s.mut);
+        return s.map.try_emplace_hashed(h, k, std::forward<Args>(args)...).second;
+    }
+
+    // insert (k, v), or assign v to the existing value,
+    // returns whether it is inserted
+    template<class M>
+    bool insert_or_assign(const Key& k, M&& v) {
+        size_t h = hash_(k);
+        shard_& s = shard_of_(h);
+        write_lock lk(s.mut);
+        // try_emplace leaves v untouched when k exists
+        auto r = s.map.try_emplace_hashed(h, k, std::forward<M>(v));
+        if (!r.second) r.first->second = std::forward<M>(v);
+        return r.second;
+    }
+
+    // invoke f(T&) on the value associated with k, which is
+    // default-constructed if absent, while holding the shard exclusively
+    template<class F>
+    void update(const Key& k, F&& f) {
+        size_t h = hash_(k);
+        shard_& s = shard_of_(h);
+        write_lock lk(s.mut);
+        f(s.map.try_emplace_hashed(h, k).first->second);
+    }
+
+    size_type erase(const Key& k) {
+        size_t h = hash_(k);
+        shard_& s = shard_of_(h);
+        write_lock lk(s.mut);
+        return s.map.erase_hashed(h, k);
+    }
+
+public:
+    // invoke f(const value_type&) on each entry, on a consistent
+    // snapshot: all shards are held in shared mode throughout, so no
+    // writer can intervene (f must not call back into this dict)
+    template<class F>
+    void for_each(F&& f) const {
+        all_locked_<read_lock> lk(*this);
+        for (size_t i = 0; i < nshards_; ++i) {
+            for (const value_type& e: shards_[i].map) f(e);
+        }
+    }
+
+    // copy the entries, on a consistent snapshot
+    std::vector<value_type> snapshot() const {
+        all_locked_<read_lock> lk(*this);
+        std::vector<value_type> r;
+        size_t n = 0;
+        for (size_t i = 0; i < nshards_; ++i) n += shards_[i].map.size();
+        r.reserve(n);
+        for (size_t i = 0; i < nshards_; ++i) {
+            r.insert(r.end(), shards_[i].map.begin(), shards_[i].map.end());
+        }
+        return r;
+    }
+
+private:
+    // holds all shards, acquired in ascending order (the same
+    // order is used everywhere, which rules out deadlocks)
+    template<class Lock>
+    struct all_locked_ {
+        std::vector<Lock> locks;
+
+        explicit all_locked_(const concurrent_dict& d) {
+            locks.reserve(d.nshards_);
+            for (size_t i = 0; i < d.nshards_; ++i) {
+                locks.emplace_back(d.shards_[i].mut);
+            }
+        }
+    };
+
+    static size_t shard_count_for_(size_t n) noexcept {
+        size_t c = 1;
+        while (c < n && c < (size_t(1) << 24)) c <<= 1;
+        return c;
+    }
+
+    // The shard is chosen with the middle bits of the mixed hash,
+    // which are disjoint from those flat_hash_map uses to place
+    // entries within a shard.
+    size_t shard_index_(size_t h) const noexcept {
+        return static_cast<size_t>(details::swiss_mix(h) >> 40) & (nshards_ - 1);
+    }
+
+    shard_& shard_of_(size_t h) noexcept {
+        return shards_[shard_index_(h)];
+    }
+
+    const shard_& shard_of_(size_t h) const noexcept {
+        return shards_[shard_index_(h)];
+    }
+};
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+constexpr size_t concurrent_dict<Key, T, Hash, KeyEqual, Allocator>::default_shard_count;
+
+} // end namespace clue
+
+#endif
@@ -78,7 +78,7 @@ public:
         T x = std::move(queue_.front());
         queue_.pop();
         if (empty()) cv2_.notify_all();
-        return std::move(x);
+        return x;
     }
 
     // Wait until empty
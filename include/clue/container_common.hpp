@@ -8,5 +8,65 @@
 #include <initializer_list>
 #include <iterator>
 #include <limits>
+#include <vector>
+
+namespace clue {
+
+class thread_pool;
+
+namespace details {
+
+template<class F>
+struct index_task {
+    F* fun;
+    size_t index;
+
+    void operator()(size_t) const {
+        (*fun)(index);
+    }
+};
+
+// Call f(i) for each i in [0, n), as tasks on the pool (a clue::thread_pool),
+// or in the calling thread if the pool has no threads. It returns after all
+// tasks have finished, rethrowing the first exception (in the order of i).
+template<class Pool, class F>
+void parallel_run(Pool& pool, size_t n, F&& f) {
+    if (pool.size() == 0) {
+        for (size_t i = 0; i < n; ++i) f(i);
+        return;
+    }
+    using task_t = index_task<remove_reference_t<F>>;
+    using future_t = decltype(pool.schedule(task_t{&f, 0}));
+    std::vector<future_t> futs;
+    futs.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        futs.push_back(pool.schedule(task_t{&f, i}));
+    }
+    // the tasks refer to the states of the caller, so all of them
+    // have to be finished before any exception propagates
+    for (future_t& fu: futs) fu.wait();
+    for (future_t& fu: futs) fu.get();
+}
+
+// Split [0, n) into contiguous chunks (of at least min_chunk indices,
+// except the last one), and call f(first, last) for each of them,
+// as tasks on the pool (with parallel_run).
+template<class Pool, class F>
+void parallel_chunks(Pool& pool, size_t n, size_t min_chunk, const F& f) {
+    size_t nt = pool.size();
+    if (nt <= 1 || n <= min_chunk) {
+        f(0, n);
+        return;
+    }
+    size_t nc = (std::min)(nt * 4, (n + min_chunk - 1) / min_chunk);
+    size_t csz = (n + nc - 1) / nc;
+    parallel_run(pool, (n + csz - 1) / csz, [&](size_t i) {
+        f(i * csz, (std::min)((i + 1) * csz, n));
+    });
+}
+
+} // end namespace details
+
+} // end namespace clue
 
 #endif
@@ -0,0 +1,361 @@
+/**
+ * @file csv.hpp
+ *
+ * A zero-copy reader of delimited text (CSV, TSV, etc), which yields
+ * the fields of each row as string views into the text.
+ *
+ * Quoting follows RFC 4180: a field enclosed in quotes may contain
+ * delimiters, line breaks, and quotes (written twice).
+ *
+ * The text is scanned 64 bytes at a time: the positions of quotes,
+ * delimiters and newlines in a block are found as bit masks (with SSE2
+ * where available), and the mask of the bytes inside quotes is derived
+ * from the quote mask by a prefix XOR. Hence the field boundaries are
+ * found without examining the bytes one by one, and quoting costs nothing
+ * extra.
+ */
+
+#ifndef CLUE_CSV__
+#define CLUE_CSV__
+
+#include <clue/stringex.hpp>
+#include <clue/fast_vector.hpp>
+#include <clue/memscan.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+namespace clue {
+
+// the format of delimited text
+
+struct csv_format {
+    char delim;     // the field delimiter
+    char quote;     // the quote character, or '\0' for no quoting
+
+    constexpr csv_format(char d = ',', char q = '"') noexcept
+        : delim(d), quote(q) {}
+
+    // comma-separated, with quoting
+    static constexpr csv_format csv() noexcept {
+        return csv_format(',', '"');
+    }
+
+    // tab-separated, without quoting
+    static constexpr csv_format tsv() noexcept {
+        return csv_format('\t', '\0');
+    }
+};
+
+
+// a row of fields, as views into the text
+
+class csv_row {
+public:
+    using const_iterator = const string_view*;
+
+private:
+    fast_vector<string_view, 16> fields_;
+    fast_vector<uint32_t, 4> escaped_;  // the fields with doubled quotes
+    char quote_ = '"';
+
+    friend class csv_reader;
+
+public:
+    size_t size() const noexcept {
+        return fields_.size();
+    }
+
+    bool empty() const noexcept {
+        return fields_.empty();
+    }
+
+    // the content of field i (without the enclosing quotes,
+    // but with doubled quotes as they are)
+    string_view operator[](size_t i) const noexcept {
+        return fields_[i];
+    }
+
+    string_view at(size_t i) const {
+        if (i >= fields_.size())
+            throw std::out_of_range("csv_row::at: field index out of range.");
+        return fields_[i];
+    }
+
+    const_iterator begin() const noexcept { return fields_.data(); }
+    const_iterator end()   const noexcept { return fields_.data() + fields_.size(); }
+
+    // whether field i contains doubled quotes (and thus str(i) differs
+    // from operator[](i))
+    bool escaped(size_t i) const noexcept {
+        for (uint32_t k: escaped_) {
+            if (k == i) return true;
+        }
+        return false;
+    }
+
+    // a copy of the content of field i, with doubled quotes unescaped
+    std::string str(size_t i) const {
+        string_view f = at(i);
+        if (!escaped(i)) return f.to_string();
+        std::string s;
+        s.reserve(f.size());
+        for (size_t k = 0; k < f.size(); ++k) {
+            s.push_back(f[k]);
+            if (f[k] == quote_ && k + 1 < f.size() && f[k + 1] == quote_) ++k;
+        }
+        return s;
+    }
+
+    // the index of the first field equal to name, or size() if not found
+    size_t index_of(string_view name) const noexcept {
+        size_t i = 0;
+        while (i < fields_.size() && fields_[i] != name) ++i;
+        return i;
+    }
+
+private:
+    void clear() noexcept {
+        fields_.clear();
+        escaped_.clear();
+    }
+};
+
+
+namespace details {
+
+constexpr size_t csv_block = 64;
+
+// bit masks of the positions of quotes, delimiters and newlines
+// in a 64-byte block
+struct csv_masks {
+    uint64_t quote;
+    uint64_t delim;
+    uint64_t newline;
+};
+
+inline void csv_block_masks(const char* p, char delim, char quote, csv_masks& m) noexcept {
+    const byte_block64 b(p);
+    m.quote = b.match(quote);
+    m.delim = b.match(delim);
+    m.newline = b.match('\n');
+}
+
+// bit i of the result is the XOR of bits 0..i of x
+inline uint64_t prefix_xor(uint64_t x) noexcept {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+} // end namespace details
+
+
+// Read the rows of delimited text, where rows are separated by '\n'
+// (or "\r\n"). Blank lines are skipped. The fields refer to the text,
+// which must outlive them (a mapped_file can be passed as text).
+
+class csv_reader {
+private:
+    string_view text_;
+    csv_format fmt_;
+    size_t cur_;        // the offset of the current block
+    size_t next_;       // the offset of the next block
+    uint64_t bits_;     // the field ends remaining in the current block
+    uint64_t nl_;       // the row ends in the current block
+    uint64_t inside_;   // all ones if the next block begins inside quotes
+    size_t field_beg_;
+    size_t nrows_;
+
+public:
+    explicit csv_reader(string_view text, csv_format fmt = csv_format())
+        : text_(text), fmt_(fmt)
+        , cur_(0), next_(0), bits_(0), nl_(0), inside_(0)
+        , field_beg_(0), nrows_(0) {
+        if (fmt.delim == '\n' || (fmt.quote && (fmt.quote == fmt.delim || fmt.quote == '\n')))
+            throw std::invalid_argument("csv_reader: invalid format.");
+    }
+
+    const csv_format& format() const noexcept {
+        return fmt_;
+    }
+
+    // the number of rows read
+    size_t rows_read() const noexcept {
+        return nrows_;
+    }
+
+    // read the next row, returning false at the end of the text
+    bool next(csv_row& row) {
+        row.clear();
+        row.quote_ = fmt_.quote;
+        const size_t len = text_.size();
+
+        // the scanning state is kept in local variables in the loop,
+        // which otherwise would be reloaded after each field is stored
+        uint64_t bits = bits_;
+        size_t cur = cur_;
+        size_t fb = field_beg_;
+        for(;;) {
+            while (bits == 0) {
+                if (next_ >= len) {
+                    // the last row, without a trailing newline
+                    bits_ = 0;
+                    field_beg_ = len;
+                    if (fb < len || !row.empty()) {
+                        add_field_(row, fb, len, true);
+                        if (!is_blank_(row)) {
+                            ++nrows_;
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+                bits = load_block_();
+                cur = cur_;
+            }
+            const unsigned j = details::ctz64(bits);
+            bits &= bits - 1;
+            const size_t pos = cur + j;
+            const bool eol = ((nl_ >> j) & 1) != 0;
+            add_field_(row, fb, pos, eol);
+            fb = pos + 1;
+            if (eol) {
+                if (!is_blank_(row)) {
+                    bits_ = bits;
+                    field_beg_ = fb;
+                    ++nrows_;
+                    return true;
+                }
+                row.clear();
+            }
+        }
+    }
+
+private:
+    // scan the next block, and return the field ends in it
+    uint64_t load_block_() noexcept {
+        using namespace details;
+        cur_ = next_;
+        const size_t n = std::min(csv_block, text_.size() - cur_);
+        const char* p = text_.data() + cur_;
+        char tmp[csv_block];
+        if (n < csv_block) {
+            // the last partial block
+            std::memcpy(tmp, p, n);
+            std::memset(tmp + n, 0, csv_block - n);
+            p = tmp;
+        }
+        csv_masks m;
+        csv_block_masks(p, fmt_.delim, fmt_.quote ? fmt_.quote : fmt_.delim, m);
+        uint64_t valid = n < csv_block ? (uint64_t(1) << n) - 1 : ~uint64_t(0);
+        uint64_t out = ~uint64_t(0);
+        if (fmt_.quote) {
+            const uint64_t in = prefix_xor(m.quote & valid) ^ inside_;
+            inside_ = static_cast<uint64_t>(static_cast<int64_t>(in) >> 63);
+            out = ~in;
+        }
+        next_ = cur_ + n;
+        nl_ = m.newline & out & valid;
+        return (m.delim | m.newline) & out & valid;
+    }
+
+    void add_field_(csv_row& row, size_t b, size_t e, bool last) {
+        const char* s = text_.data();
+        if (last && e > b && s[e - 1] == '\r') --e;
+        const char q = fmt_.quote;
+        if (q && e > b && s[b] == q) {
+            ++b;
+            if (e > b && s[e - 1] == q) --e;
+            if (find_byte(s + b, e - b, q)) {
+                row.escaped_.push_back(static_cast<uint32_t>(row.fields_.size()));
+            }
+        }
+        row.fields_.push_back(string_view(s + b, e - b));
+    }
+
+    bool is_blank_(const csv_row& row) const noexcept {
+        // a single empty field, which is not quoted
+        if (row.size() != 1 || !row[0].empty()) return false;
+        const char* p = row[0].data();
+        return !fmt_.quote || p == text_.data() || p[-1] != fmt_.quote;
+    }
+};
+
+
+// typed column extraction
+
+template<class Vec>
+struct csv_column_ref {
+    size_t index;
+    Vec& out;
+};
+
+// a column to extract, by its index, into a vector
+// (e.g. fast_vector<double>)
+template<class Vec>
+inline csv_column_ref<Vec> csv_column(size_t index, Vec& out) noexcept {
+    return csv_column_ref<Vec>{index, out};
+}
+
+namespace details {
+
+template<typename T>
+inline enable_if_t<::std::is_arithmetic<T>::value, bool>
+csv_parse(const csv_row& row, size_t j, T& x) {
+    return try_parse(row[j], x);
+}
+
+inline bool csv_parse(const csv_row& row, size_t j, string_view& x) {
+    x = row[j];
+    return true;
+}
+
+inline bool csv_parse(const csv_row& row, size_t j, std::string& x) {
+    x = row.str(j);
+    return true;
+}
+
+template<class Vec>
+inline void csv_extract(const csv_row& row, size_t r, const csv_column_ref<Vec>& c) {
+    typename Vec::value_type x = typename Vec::value_type();
+    if (c.index >= row.size() || !csv_parse(row, c.index, x)) {
+        throw std::invalid_argument(
+            "read_csv_columns: invalid value at row " + std::to_string(r) +
+            ", column " + std::to_string(c.index) + ".");
+    }
+    c.out.push_back(std::move(x));
+}
+
+} // end namespace details
+
+// parse the given columns of all remaining rows, appending the values
+// to the vectors, and return the number of rows read. It throws
+// std::invalid_argument if a field is missing or cannot be parsed
+// (with the 0-based index of the row among all rows read).
+//
+//   fast_vector<int> ids;
+//   fast_vector<double> xs;
+//   read_csv_columns(rdr, csv_column(0, ids), csv_column(2, xs));
+//
+template<class... Vecs>
+inline size_t read_csv_columns(csv_reader& rdr, const csv_column_ref<Vecs>&... cols) {
+    csv_row row;
+    size_t n = 0;
+    while (rdr.next(row)) {
+        const size_t r = rdr.rows_read() - 1;
+        int order[] = {0, (details::csv_extract(row, r, cols), 0)...};
+        (void)order;
+        ++n;
+    }
+    return n;
+}
+
+} // end namespace clue
+
+#endif
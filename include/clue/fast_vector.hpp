@@ -8,6 +8,7 @@
 #define CLUE_FAST_VECTOR__
 
 #include <clue/container_common.hpp>
+#include <clue/memory.hpp>
 #include <vector>
 #include <cstring>
 
@@ -380,6 +381,16 @@ public:
         return pb_ != ss_.begin();
     }
 
+    // the static storage (when in use) is counted as elements and slack,
+    // though it is part of the object itself
+    memory_usage_info memory_usage() const noexcept {
+        size_t n = size();
+        size_t c = capacity();
+        return memory_usage_info(
+            n * sizeof(T), 0, (c - n) * sizeof(T),
+            use_dynamic() ? malloc_overhead(c * sizeof(T)) : 0);
+    }
+
     allocator_type get_allocator() const {
         return alloc_;
     }
@@ -591,7 +602,7 @@ public:
                 relocater::move_disjoint(ss_.begin(), pb_, pn_);
 
                 // release memory
-                alloc_.deallocate(pb_, n);
+                alloc_.deallocate(pb_, cur_cap);
 
                 // set pointers on static array
                 reset();
@@ -615,6 +626,7 @@ private:
 
         // move elements to tmp
         size_type n = size();
+        size_type c = capacity();
         if (n > 0) {
             pe_ = pb_;
             relocater::move_disjoint(tmp.begin(), pb_, pb_ + n);
@@ -623,7 +635,7 @@ private:
 
         // release own memory
         if (use_dynamic()) {
-            alloc_.deallocate(pb_, n);
+            alloc_.deallocate(pb_, c);
         }
         reset();
 
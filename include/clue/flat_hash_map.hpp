@@ -0,0 +1,724 @@
+/**
+ * @file flat_hash_map.hpp
+ *
+ * The flat_hash_map class, an open-addressing hash map in the style
+ * of SwissTable, where slots are probed in groups of 16 using SIMD
+ * comparisons on one-byte control codes.
+ */
+
+#ifndef CLUE_FLAT_HASH_MAP__
+#define CLUE_FLAT_HASH_MAP__
+
+#include <clue/container_common.hpp>
+#include <clue/memory.hpp>
+#include <clue/memscan.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace clue {
+
+namespace details {
+
+// Control bytes:
+//
+//  - empty:    0b10000000
+//  - deleted:  0b11111110
+//  - full:     0b0xxxxxxx, where xxxxxxx are 7 bits of the hash value
+//
+// Hence a slot is full iff its control byte is non-negative.
+//
+constexpr int8_t swiss_empty   = -128;
+constexpr int8_t swiss_deleted = -2;
+constexpr size_t swiss_group_width = 16;
+
+// A group of 16 control bytes. Each match function returns
+// a bit mask, of which the i-th bit indicates whether the
+// i-th byte satisfies the condition.
+
+#if defined(__SSE2__)
+
+class swiss_group {
+private:
+    __m128i ctrl_;
+
+public:
+    explicit swiss_group(const int8_t* p) noexcept
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+    uint32_t match(int8_t h2) const noexcept {
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2))));
+    }
+
+    uint32_t match_empty() const noexcept {
+        return match(swiss_empty);
+    }
+
+    uint32_t match_empty_or_deleted() const noexcept {
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+    }
+};
+
+#else
+
+class swiss_group {
+private:
+    const int8_t* p_;
+
+public:
+    explicit swiss_group(const int8_t* p) noexcept
+        : p_(p) {}
+
+    uint32_t match(int8_t h2) const noexcept {
+        uint32_t m = 0;
+        for (size_t i = 0; i < swiss_group_width; ++i) {
+            if (p_[i] == h2) m |= (1u << i);
+        }
+        return m;
+    }
+
+    uint32_t match_empty() const noexcept {
+        return match(swiss_empty);
+    }
+
+    uint32_t match_empty_or_deleted() const noexcept {
+        uint32_t m = 0;
+        for (size_t i = 0; i < swiss_group_width; ++i) {
+            if (p_[i] < 0) m |= (1u << i);
+        }
+        return m;
+    }
+};
+
+#endif
+
+// mix the bits of a hash value (the finalizer of MurmurHash3),
+// as many std::hash implementations are identity for integers.
+inline uint64_t swiss_mix(size_t h) noexcept {
+    uint64_t x = static_cast<uint64_t>(h);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+} // end namespace details
+
+
+template<class Key,
+         class T,
+         class Hash = std::hash<Key>,
+         class KeyEqual = std::equal_to<Key>,
+         class Allocator = std::allocator< std::pair<Key, T> >
+        >
+class flat_hash_map {
+public:
+    // type names
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+
+private:
+    using slot_allocator = typename Allocator::template rebind<value_type>::other;
+    using ctrl_allocator = typename Allocator::template rebind<int8_t>::other;
+    using slot_traits = std::allocator_traits<slot_allocator>;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t gwidth = details::swiss_group_width;
+
+    template<bool Const>
+    class iter_ {
+        friend class flat_hash_map;
+        friend class iter_<!Const>;
+
+    public:
+        typedef typename flat_hash_map::value_type value_type;
+        typedef conditional_t<Const, const value_type&, value_type&> reference;
+        typedef conditional_t<Const, const value_type*, value_type*> pointer;
+        typedef ptrdiff_t difference_type;
+        typedef std::forward_iterator_tag iterator_category;
+
+    private:
+        const int8_t* ctrl_;
+        const int8_t* ctrl_end_;
+        pointer slot_;
+
+        iter_(const int8_t* c, const int8_t* ce, pointer s) noexcept
+            : ctrl_(c), ctrl_end_(ce), slot_(s) {}
+
+        void skip_() noexcept {
+            while (ctrl_ != ctrl_end_ && *ctrl_ < 0) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+    public:
+        iter_() noexcept
+            : ctrl_(nullptr), ctrl_end_(nullptr), slot_(nullptr) {}
+
+        template<bool C, CLUE_REQUIRE(Const && !C)>
+        iter_(const iter_<C>& other) noexcept
+            : ctrl_(other.ctrl_), ctrl_end_(other.ctrl_end_), slot_(other.slot_) {}
+
+        reference operator*() const noexcept { return *slot_; }
+        pointer operator->() const noexcept { return slot_; }
+
+        iter_& operator++() noexcept {
+            ++ctrl_;
+            ++slot_;
+            skip_();
+            return *this;
+        }
+
+        iter_ operator++(int) noexcept {
+            iter_ tmp(*this);
+            operator++();
+            return tmp;
+        }
+
+        bool operator==(const iter_& r) const noexcept { return ctrl_ == r.ctrl_; }
+        bool operator!=(const iter_& r) const noexcept { return ctrl_ != r.ctrl_; }
+    };
+
+public:
+    using iterator = iter_<false>;
+    using const_iterator = iter_<true>;
+
+private:
+    int8_t* ctrl_ = nullptr;
+    value_type* slots_ = nullptr;
+    size_t cap_ = 0;          // number of slots: 0 or a power of 2 (>= 16)
+    size_t size_ = 0;         // number of full slots
+    size_t growth_left_ = 0;  // number of empty slots that can be filled before rehashing
+    Hash hash_;
+    KeyEqual keyeq_;
+    slot_allocator alloc_;
+
+public:
+    flat_hash_map() = default;
+
+    explicit flat_hash_map(size_type n,
+                           const Hash& hf = Hash(),
+                           const KeyEqual& eq = KeyEqual(),
+                           const Allocator& a = Allocator())
+        : hash_(hf), keyeq_(eq), alloc_(a) {
+        reserve(n);
+    }
+
+    template<class InputIter>
+    flat_hash_map(InputIter first, InputIter last) {
+        insert(first, last);
+    }
+
+    flat_hash_map(std::initializer_list<value_type> ilist) {
+        insert(ilist);
+    }
+
+    flat_hash_map(const flat_hash_map& other)
+        : hash_(other.hash_)
+        , keyeq_(other.keyeq_)
+        , alloc_(slot_traits::select_on_container_copy_construction(other.alloc_)) {
+        reserve(other.size());
+        for (const value_type& e: other) {
+            size_t h = hash_(e.first);
+            emplace_at_(find_insert_slot_(h), h, e);
+        }
+    }
+
+    flat_hash_map(flat_hash_map&& other)
+        : ctrl_(other.ctrl_)
+        , slots_(other.slots_)
+        , cap_(other.cap_)
+        , size_(other.size_)
+        , growth_left_(other.growth_left_)
+        , hash_(std::move(other.hash_))
+        , keyeq_(std::move(other.keyeq_))
+        , alloc_(std::move(other.alloc_)) {
+        other.reset_();
+    }
+
+    ~flat_hash_map() {
+        destroy_();
+    }
+
+    flat_hash_map& operator=(const flat_hash_map& other) {
+        if (this != &other) {
+            flat_hash_map tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    flat_hash_map& operator=(flat_hash_map&& other) {
+        if (this != &other) {
+            destroy_();
+            ctrl_ = other.ctrl_;
+            slots_ = other.slots_;
+            cap_ = other.cap_;
+            size_ = other.size_;
+            growth_left_ = other.growth_left_;
+            hash_ = std::move(other.hash_);
+            keyeq_ = std::move(other.keyeq_);
+            alloc_ = std::move(other.alloc_);
+            other.reset_();
+        }
+        return *this;
+    }
+
+    flat_hash_map& operator=(std::initializer_list<value_type> ilist) {
+        clear();
+        insert(ilist);
+        return *this;
+    }
+
+    void swap(flat_hash_map& other) {
+        using std::swap;
+        swap(ctrl_, other.ctrl_);
+        swap(slots_, other.slots_);
+        swap(cap_, other.cap_);
+        swap(size_, other.size_);
+        swap(growth_left_, other.growth_left_);
+        swap(hash_, other.hash_);
+        swap(keyeq_, other.keyeq_);
+        swap(alloc_, other.alloc_);
+    }
+
+    bool operator==(const flat_hash_map& other) const {
+        if (size_ != other.size_) return false;
+        for (const value_type& e: *this) {
+            auto it = other.find(e.first);
+            if (it == other.end() || !(it->second == e.second)) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const flat_hash_map& other) const {
+        return !(operator==(other));
+    }
+
+public:
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept {
+        return size_;
+    }
+
+    size_type max_size() const noexcept {
+        return slot_traits::max_size(alloc_);
+    }
+
+    // the number of slots
+    size_type capacity() const noexcept {
+        return cap_;
+    }
+
+    float load_factor() const noexcept {
+        return cap_ == 0 ? 0.0f : static_cast<float>(size_) / static_cast<float>(cap_);
+    }
+
+    // the control bytes are counted as index
+    memory_usage_info memory_usage() const noexcept {
+        const size_t es = sizeof(*slots_);
+        return memory_usage_info(
+            size_ * es,
+            cap_,
+            (cap_ - size_) * es,
+            malloc_overhead(cap_ * es) + malloc_overhead(cap_));
+    }
+
+    hasher hash_function() const {
+        return hash_;
+    }
+
+    key_equal key_eq() const {
+        return keyeq_;
+    }
+
+    allocator_type get_allocator() const {
+        return allocator_type(alloc_);
+    }
+
+    iterator begin() noexcept {
+        iterator it(ctrl_, ctrl_ + cap_, slots_);
+        it.skip_();
+        return it;
+    }
+
+    iterator end() noexcept {
+        return iterator(ctrl_ + cap_, ctrl_ + cap_, slots_ + cap_);
+    }
+
+    const_iterator begin() const noexcept {
+        const_iterator it(ctrl_, ctrl_ + cap_, slots_);
+        it.skip_();
+        return it;
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(ctrl_ + cap_, ctrl_ + cap_, slots_ + cap_);
+    }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend()   const noexcept { return end(); }
+
+public:
+    T& at(const Key& k) {
+        size_t i = find_index_(k, hash_(k));
+        if (i == npos)
+            throw std::out_of_range("flat_hash_map::at: the key is not found.");
+        return slots_[i].second;
+    }
+
+    const T& at(const Key& k) const {
+        size_t i = find_index_(k, hash_(k));
+        if (i == npos)
+            throw std::out_of_range("flat_hash_map::at: the key is not found.");
+        return slots_[i].second;
+    }
+
+    T& operator[](const Key& k) {
+        return try_emplace(k).first->second;
+    }
+
+    T& operator[](Key&& k) {
+        return try_emplace(std::move(k)).first->second;
+    }
+
+    iterator find(const Key& k) {
+        return iter_at_(find_index_(k, hash_(k)));
+    }
+
+    const_iterator find(const Key& k) const {
+        return iter_at_(find_index_(k, hash_(k)));
+    }
+
+    size_type count(const Key& k) const {
+        return find_index_(k, hash_(k)) == npos ? 0 : 1;
+    }
+
+    // lookup with the hash value of k precomputed (h == hash_function()(k))
+
+    iterator find_hashed(size_t h, const Key& k) {
+        return iter_at_(find_index_(k, h));
+    }
+
+    const_iterator find_hashed(size_t h, const Key& k) const {
+        return iter_at_(find_index_(k, h));
+    }
+
+    // heterogeneous lookup (when both Hash and KeyEqual are transparent)
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    T& at(const K& k) {
+        size_t i = find_index_(k, hash_(k));
+        if (i == npos)
+            throw std::out_of_range("flat_hash_map::at: the key is not found.");
+        return slots_[i].second;
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    const T& at(const K& k) const {
+        size_t i = find_index_(k, hash_(k));
+        if (i == npos)
+            throw std::out_of_range("flat_hash_map::at: the key is not found.");
+        return slots_[i].second;
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    iterator find(const K& k) {
+        return iter_at_(find_index_(k, hash_(k)));
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    const_iterator find(const K& k) const {
+        return iter_at_(find_index_(k, hash_(k)));
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    size_type count(const K& k) const {
+        return find_index_(k, hash_(k)) == npos ? 0 : 1;
+    }
+
+public:
+    void clear() {
+        if (size_ > 0) {
+            for (size_t i = 0; i < cap_; ++i) {
+                if (ctrl_[i] >= 0) slot_traits::destroy(alloc_, slots_ + i);
+            }
+        }
+        if (cap_ > 0) {
+            std::memset(ctrl_, static_cast<unsigned char>(details::swiss_empty), cap_);
+        }
+        size_ = 0;
+        growth_left_ = max_load_(cap_);
+    }
+
+    // ensure that n elements can be held without rehashing
+    void reserve(size_type n) {
+        if (n > size_ + growth_left_) {
+            size_t c = gwidth;
+            while (max_load_(c) < n) c <<= 1;
+            rehash_(c);
+        }
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type v(std::forward<Args>(args)...);
+        size_t h = hash_(v.first);
+        size_t i = find_index_(v.first, h);
+        if (i != npos) return std::make_pair(iter_at_(i), false);
+        i = prepare_insert_(h);
+        return std::make_pair(emplace_at_(i, h, std::move(v)), true);
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) {
+        return try_emplace_hashed(hash_(k), k, std::forward<Args>(args)...);
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args) {
+        return try_emplace_hashed(hash_(k), std::move(k), std::forward<Args>(args)...);
+    }
+
+    // try_emplace with the hash value of k precomputed (h == hash_function()(k)),
+    // which allows a batch of keys to be hashed beforehand (e.g. in parallel).
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace_hashed(size_t h, const key_type& k, Args&&... args) {
+        size_t i = find_index_(k, h);
+        if (i != npos) return std::make_pair(iter_at_(i), false);
+        i = prepare_insert_(h);
+        return std::make_pair(emplace_at_(i, h,
+            std::piecewise_construct,
+            std::forward_as_tuple(k),
+            std::forward_as_tuple(std::forward<Args>(args)...)), true);
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace_hashed(size_t h, key_type&& k, Args&&... args) {
+        size_t i = find_index_(k, h);
+        if (i != npos) return std::make_pair(iter_at_(i), false);
+        i = prepare_insert_(h);
+        return std::make_pair(emplace_at_(i, h,
+            std::piecewise_construct,
+            std::forward_as_tuple(std::move(k)),
+            std::forward_as_tuple(std::forward<Args>(args)...)), true);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& v) {
+        return try_emplace(v.first, v.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& v) {
+        return try_emplace(std::move(v.first), std::move(v.second));
+    }
+
+    template<class InputIter>
+    void insert(InputIter first, InputIter last) {
+        for (; first != last; ++first) insert(*first);
+    }
+
+    void insert(std::initializer_list<value_type> ilist) {
+        reserve(size_ + ilist.size());
+        for (const value_type& v: ilist) insert(v);
+    }
+
+    size_type erase(const Key& k) {
+        size_t i = find_index_(k, hash_(k));
+        if (i == npos) return 0;
+        erase_at_(i);
+        return 1;
+    }
+
+    size_type erase_hashed(size_t h, const Key& k) {
+        size_t i = find_index_(k, h);
+        if (i == npos) return 0;
+        erase_at_(i);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos) {
+        size_t i = static_cast<size_t>(pos.ctrl_ - ctrl_);
+        erase_at_(i);
+        iterator it(ctrl_ + i, ctrl_ + cap_, slots_ + i);
+        it.skip_();
+        return it;
+    }
+
+private:
+    static size_t max_load_(size_t c) noexcept {
+        return c - c / 8;   // maximum load factor: 7/8
+    }
+
+    static int8_t h2_(uint64_t mh) noexcept {
+        return static_cast<int8_t>(mh & 0x7F);
+    }
+
+    iterator iter_at_(size_t i) noexcept {
+        return i == npos ? end() : iterator(ctrl_ + i, ctrl_ + cap_, slots_ + i);
+    }
+
+    const_iterator iter_at_(size_t i) const noexcept {
+        return i == npos ? end() : const_iterator(ctrl_ + i, ctrl_ + cap_, slots_ + i);
+    }
+
+    // probe the groups along a triangular sequence, which visits
+    // every group when the number of groups is a power of 2.
+    template<class K>
+    size_t find_index_(const K& k, size_t h) const {
+        if (cap_ == 0) return npos;
+        uint64_t mh = details::swiss_mix(h);
+        int8_t h2 = h2_(mh);
+        size_t gmask = (cap_ / gwidth) - 1;
+        size_t g = static_cast<size_t>(mh >> 7) & gmask;
+        for (size_t step = 1; ; ++step) {
+            size_t base = g * gwidth;
+            details::swiss_group grp(ctrl_ + base);
+            for (uint32_t m = grp.match(h2); m; m &= (m - 1)) {
+                size_t i = base + details::ctz64(m);
+                if (CLUE_LIKELY(keyeq_(slots_[i].first, k))) return i;
+            }
+            if (grp.match_empty()) return npos;
+            g = (g + step) & gmask;
+        }
+    }
+
+    size_t find_insert_slot_(size_t h) const noexcept {
+        uint64_t mh = details::swiss_mix(h);
+        size_t gmask = (cap_ / gwidth) - 1;
+        size_t g = static_cast<size_t>(mh >> 7) & gmask;
+        for (size_t step = 1; ; ++step) {
+            size_t base = g * gwidth;
+            uint32_t m = details::swiss_group(ctrl_ + base).match_empty_or_deleted();
+            if (m) return base + details::ctz64(m);
+            g = (g + step) & gmask;
+        }
+    }
+
+    size_t prepare_insert_(size_t h) {
+        size_t i = find_insert_slot_or_npos_(h);
+        if (i == npos || (growth_left_ == 0 && ctrl_[i] == details::swiss_empty)) {
+            // when many slots are deleted, rehashing at the same
+            // capacity suffices to reclaim them
+            rehash_(cap_ == 0 ? gwidth :
+                    (size_ * 16 <= cap_ * 7 ? cap_ : cap_ * 2));
+            i = find_insert_slot_(h);
+        }
+        return i;
+    }
+
+    size_t find_insert_slot_or_npos_(size_t h) const noexcept {
+        return cap_ == 0 ? npos : find_insert_slot_(h);
+    }
+
+    template<class... Args>
+    iterator emplace_at_(size_t i, size_t h, Args&&... args) {
+        slot_traits::construct(alloc_, slots_ + i, std::forward<Args>(args)...);
+        if (ctrl_[i] == details::swiss_empty) --growth_left_;
+        ctrl_[i] = h2_(details::swiss_mix(h));
+        ++size_;
+        return iterator(ctrl_ + i, ctrl_ + cap_, slots_ + i);
+    }
+
+    void erase_at_(size_t i) {
+        slot_traits::destroy(alloc_, slots_ + i);
+        ctrl_[i] = details::swiss_deleted;
+        --size_;
+    }
+
+    void rehash_(size_t c) {
+        CLUE_ASSERT(c >= gwidth && (c & (c - 1)) == 0);
+        ctrl_allocator calloc(alloc_);
+        int8_t* old_ctrl = ctrl_;
+        value_type* old_slots = slots_;
+        size_t old_cap = cap_;
+
+        slots_ = slot_traits::allocate(alloc_, c);
+        try {
+            ctrl_ = calloc.allocate(c);
+        } catch (...) {
+            slot_traits::deallocate(alloc_, slots_, c);
+            slots_ = old_slots;
+            throw;
+        }
+        std::memset(ctrl_, static_cast<unsigned char>(details::swiss_empty), c);
+        cap_ = c;
+        growth_left_ = max_load_(c) - size_;
+
+        for (size_t i = 0; i < old_cap; ++i) {
+            if (old_ctrl[i] >= 0) {
+                value_type& e = old_slots[i];
+                size_t j = find_insert_slot_(hash_(e.first));
+                slot_traits::construct(alloc_, slots_ + j, std::move(e));
+                ctrl_[j] = old_ctrl[i];
+                slot_traits::destroy(alloc_, old_slots + i);
+            }
+        }
+        if (old_cap > 0) {
+            slot_traits::deallocate(alloc_, old_slots, old_cap);
+            calloc.deallocate(old_ctrl, old_cap);
+        }
+    }
+
+    void destroy_() {
+        if (cap_ > 0) {
+            clear();
+            slot_traits::deallocate(alloc_, slots_, cap_);
+            ctrl_allocator(alloc_).deallocate(ctrl_, cap_);
+        }
+        reset_();
+    }
+
+    void reset_() noexcept {
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        cap_ = 0;
+        size_ = 0;
+        growth_left_ = 0;
+    }
+
+}; // end class flat_hash_map
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+constexpr size_t flat_hash_map<Key, T, Hash, KeyEqual, Allocator>::npos;
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+constexpr size_t flat_hash_map<Key, T, Hash, KeyEqual, Allocator>::gwidth;
+
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+inline void swap(flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& lhs,
+                 flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& rhs) {
+    lhs.swap(rhs);
+}
+
+} // end namespace clue
+
+#endif
@@ -0,0 +1,674 @@
+/**
+ * @file flat_map.hpp
+ *
+ * The flat_map and flat_set classes, which are sorted associative
+ * containers backed by a contiguous fast_vector.
+ */
+
+#ifndef CLUE_FLAT_MAP__
+#define CLUE_FLAT_MAP__
+
+#include <clue/fast_vector.hpp>
+
+namespace clue {
+
+// tag to indicate that an input range is already sorted and has no duplicates
+
+struct sorted_unique_t {};
+constexpr sorted_unique_t sorted_unique{};
+
+
+namespace details {
+
+// Locate the first element in [first, first + n) for which pred is false,
+// given that pred is true on a prefix of the range.
+//
+// The loop body contains no data-dependent branch, so that the compiler
+// can turn it into conditional moves.
+//
+template<class T, class Pred>
+inline T* flat_partition_point(T* first, size_t n, Pred pred) {
+    if (n == 0) return first;
+    while (n > 1) {
+        size_t half = n >> 1;
+        first = pred(first[half]) ? first + half : first;
+        n -= half;
+    }
+    return first + static_cast<size_t>(pred(*first));
+}
+
+// remove duplicates from a sorted range, where the first one
+// of the equivalent elements is kept
+template<class T, class Less>
+inline T* flat_unique(T* first, T* last, Less less) {
+    return std::unique(first, last, [&less](const T& a, const T& b) {
+        return !less(a, b);
+    });
+}
+
+// sort a range and remove duplicates, where the first of the
+// equivalent elements (in input order) is kept
+template<class T, class Less>
+inline T* flat_sort_unique(T* first, T* last, Less less) {
+    std::stable_sort(first, last, less);
+    return flat_unique(first, last, less);
+}
+
+// append [first, last) to vec, then restore the sorted & unique order
+// (existing elements precede the new ones that are equivalent to them)
+template<class Vec, class InputIter, class Less>
+inline void flat_merge_insert(Vec& vec, InputIter first, InputIter last, Less less) {
+    size_t n0 = vec.size();
+    for (; first != last; ++first) vec.push_back(*first);
+    if (vec.size() == n0) return;
+
+    auto b = vec.begin();
+    auto m = b + n0;
+    std::stable_sort(m, vec.end(), less);
+    std::inplace_merge(b, m, vec.end(), less);
+    vec.erase(flat_unique(b, vec.end(), less), vec.end());
+}
+
+} // end namespace details
+
+
+//===============================================
+//
+//   flat_map
+//
+//===============================================
+
+template<class Key,
+         class T,
+         class Compare = std::less<Key>,
+         class Allocator = std::allocator< std::pair<Key, T> >
+        >
+class flat_map {
+public:
+    // type names
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+private:
+    using vector_type = fast_vector<value_type, 0,
+        is_relocatable<value_type>::value, Allocator>;
+
+public:
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = typename vector_type::iterator;
+    using const_iterator = typename vector_type::const_iterator;
+    using reverse_iterator = typename vector_type::reverse_iterator;
+    using const_reverse_iterator = typename vector_type::const_reverse_iterator;
+
+    class value_compare {
+        friend class flat_map;
+        Compare comp_;
+        value_compare(Compare c) : comp_(c) {}
+    public:
+        bool operator()(const value_type& a, const value_type& b) const {
+            return comp_(a.first, b.first);
+        }
+    };
+
+private:
+    vector_type vec_;
+    Compare comp_;
+
+public:
+    flat_map() = default;
+
+    explicit flat_map(const Compare& comp)
+        : comp_(comp) {}
+
+    // bulk construction: sort, then remove duplicated keys
+    // (the first one of the pairs with equal keys is kept)
+    template<class InputIter>
+    flat_map(InputIter first, InputIter last, const Compare& comp = Compare())
+        : vec_(first, last), comp_(comp) {
+        vec_.erase(details::flat_sort_unique(vec_.begin(), vec_.end(), value_comp()),
+                   vec_.end());
+    }
+
+    // bulk construction from a range that is already sorted and unique
+    template<class InputIter>
+    flat_map(sorted_unique_t, InputIter first, InputIter last,
+             const Compare& comp = Compare())
+        : vec_(first, last), comp_(comp) {}
+
+    flat_map(std::initializer_list<value_type> ilist,
+             const Compare& comp = Compare())
+        : flat_map(ilist.begin(), ilist.end(), comp) {}
+
+    flat_map& operator=(std::initializer_list<value_type> ilist) {
+        return operator=(flat_map(ilist, comp_));
+    }
+
+    bool operator==(const flat_map& other) const {
+        return size() == other.size() &&
+               std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const flat_map& other) const {
+        return !(operator==(other));
+    }
+
+    void swap(flat_map& other) {
+        using std::swap;
+        swap(vec_, other.vec_);
+        swap(comp_, other.comp_);
+    }
+
+public:
+    bool empty() const noexcept {
+        return vec_.empty();
+    }
+
+    size_type size() const noexcept {
+        return vec_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return vec_.max_size();
+    }
+
+    size_type capacity() const noexcept {
+        return vec_.capacity();
+    }
+
+    key_compare key_comp() const {
+        return comp_;
+    }
+
+    value_compare value_comp() const {
+        return value_compare(comp_);
+    }
+
+    iterator begin() noexcept { return vec_.begin(); }
+    iterator end()   noexcept { return vec_.end(); }
+
+    const_iterator begin() const noexcept { return vec_.begin(); }
+    const_iterator end()   const noexcept { return vec_.end(); }
+
+    const_iterator cbegin() const noexcept { return vec_.begin(); }
+    const_iterator cend()   const noexcept { return vec_.end(); }
+
+    reverse_iterator rbegin() noexcept { return vec_.rbegin(); }
+    reverse_iterator rend()   noexcept { return vec_.rend(); }
+
+    const_reverse_iterator rbegin() const noexcept { return vec_.rbegin(); }
+    const_reverse_iterator rend()   const noexcept { return vec_.rend(); }
+
+    const value_type* data() const noexcept {
+        return vec_.data();
+    }
+
+public:
+    // lookup with key_type
+
+    T& at(const Key& k) {
+        return at_(k);
+    }
+
+    const T& at(const Key& k) const {
+        return const_cast<flat_map*>(this)->at_(k);
+    }
+
+    T& operator[](const Key& k) {
+        return try_emplace(k).first->second;
+    }
+
+    T& operator[](Key&& k) {
+        return try_emplace(std::move(k)).first->second;
+    }
+
+    iterator find(const Key& k) {
+        return find_(k);
+    }
+
+    const_iterator find(const Key& k) const {
+        return const_cast<flat_map*>(this)->find_(k);
+    }
+
+    size_type count(const Key& k) const {
+        return find(k) != end() ? 1 : 0;
+    }
+
+    iterator lower_bound(const Key& k) {
+        return lower_bound_(k);
+    }
+
+    const_iterator lower_bound(const Key& k) const {
+        return const_cast<flat_map*>(this)->lower_bound_(k);
+    }
+
+    iterator upper_bound(const Key& k) {
+        return upper_bound_(k);
+    }
+
+    const_iterator upper_bound(const Key& k) const {
+        return const_cast<flat_map*>(this)->upper_bound_(k);
+    }
+
+    // heterogeneous lookup (when Compare::is_transparent is defined)
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    T& at(const K& k) {
+        return at_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    const T& at(const K& k) const {
+        return const_cast<flat_map*>(this)->at_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    iterator find(const K& k) {
+        return find_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    const_iterator find(const K& k) const {
+        return const_cast<flat_map*>(this)->find_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    size_type count(const K& k) const {
+        return find(k) != end() ? 1 : 0;
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    iterator lower_bound(const K& k) {
+        return lower_bound_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    const_iterator lower_bound(const K& k) const {
+        return const_cast<flat_map*>(this)->lower_bound_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    iterator upper_bound(const K& k) {
+        return upper_bound_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    const_iterator upper_bound(const K& k) const {
+        return const_cast<flat_map*>(this)->upper_bound_(k);
+    }
+
+public:
+    void clear() {
+        vec_.clear();
+    }
+
+    void reserve(size_type c) {
+        vec_.reserve(c);
+    }
+
+    void shrink_to_fit() {
+        vec_.shrink_to_fit();
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type v(std::forward<Args>(args)...);
+        iterator it = lower_bound_(v.first);
+        if (it != vec_.end() && !comp_(v.first, it->first)) {
+            return std::make_pair(it, false);
+        }
+        return std::make_pair(vec_.insert(it, std::move(v)), true);
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) {
+        iterator it = lower_bound_(k);
+        if (it != vec_.end() && !comp_(k, it->first)) {
+            return std::make_pair(it, false);
+        }
+        return std::make_pair(vec_.emplace(it, std::piecewise_construct,
+            std::forward_as_tuple(k),
+            std::forward_as_tuple(std::forward<Args>(args)...)), true);
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args) {
+        iterator it = lower_bound_(k);
+        if (it != vec_.end() && !comp_(k, it->first)) {
+            return std::make_pair(it, false);
+        }
+        return std::make_pair(vec_.emplace(it, std::piecewise_construct,
+            std::forward_as_tuple(std::move(k)),
+            std::forward_as_tuple(std::forward<Args>(args)...)), true);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& v) {
+        return try_emplace(v.first, v.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& v) {
+        return try_emplace(std::move(v.first), std::move(v.second));
+    }
+
+    // insert a range of pairs in bulk: they are appended, sorted and
+    // then merged with existing entries (existing entries are kept)
+    template<class InputIter>
+    void insert(InputIter first, InputIter last) {
+        details::flat_merge_insert(vec_, first, last, value_comp());
+    }
+
+    void insert(std::initializer_list<value_type> ilist) {
+        insert(ilist.begin(), ilist.end());
+    }
+
+    iterator erase(const_iterator pos) {
+        return vec_.erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return vec_.erase(first, last);
+    }
+
+    size_type erase(const Key& k) {
+        iterator it = find_(k);
+        if (it == vec_.end()) return 0;
+        vec_.erase(it);
+        return 1;
+    }
+
+private:
+    template<class K>
+    iterator lower_bound_(const K& k) {
+        const Compare& comp = comp_;
+        return details::flat_partition_point(vec_.data(), vec_.size(),
+            [&comp, &k](const value_type& e){ return comp(e.first, k); });
+    }
+
+    template<class K>
+    iterator upper_bound_(const K& k) {
+        const Compare& comp = comp_;
+        return details::flat_partition_point(vec_.data(), vec_.size(),
+            [&comp, &k](const value_type& e){ return !comp(k, e.first); });
+    }
+
+    template<class K>
+    iterator find_(const K& k) {
+        iterator it = lower_bound_(k);
+        return (it != vec_.end() && !comp_(k, it->first)) ? it : vec_.end();
+    }
+
+    template<class K>
+    T& at_(const K& k) {
+        iterator it = find_(k);
+        if (it == vec_.end())
+            throw std::out_of_range("flat_map::at: the key is not found.");
+        return it->second;
+    }
+
+}; // end class flat_map
+
+
+template<class Key, class T, class Compare, class Allocator>
+inline void swap(flat_map<Key, T, Compare, Allocator>& lhs,
+                 flat_map<Key, T, Compare, Allocator>& rhs) {
+    lhs.swap(rhs);
+}
+
+
+//===============================================
+//
+//   flat_set
+//
+//===============================================
+
+template<class Key,
+         class Compare = std::less<Key>,
+         class Allocator = std::allocator<Key>
+        >
+class flat_set {
+public:
+    // type names
+    using key_type = Key;
+    using value_type = Key;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+
+private:
+    using vector_type = fast_vector<Key, 0, is_relocatable<Key>::value, Allocator>;
+
+public:
+    using reference = const Key&;
+    using const_reference = const Key&;
+    using pointer = const Key*;
+    using const_pointer = const Key*;
+    using iterator = typename vector_type::const_iterator;
+    using const_iterator = typename vector_type::const_iterator;
+    using reverse_iterator = typename vector_type::const_reverse_iterator;
+    using const_reverse_iterator = typename vector_type::const_reverse_iterator;
+
+private:
+    vector_type vec_;
+    Compare comp_;
+
+public:
+    flat_set() = default;
+
+    explicit flat_set(const Compare& comp)
+        : comp_(comp) {}
+
+    // bulk construction: sort, then remove duplicates
+    template<class InputIter>
+    flat_set(InputIter first, InputIter last, const Compare& comp = Compare())
+        : vec_(first, last), comp_(comp) {
+        vec_.erase(details::flat_sort_unique(vec_.begin(), vec_.end(), comp_),
+                   vec_.end());
+    }
+
+    // bulk construction from a range that is already sorted and unique
+    template<class InputIter>
+    flat_set(sorted_unique_t, InputIter first, InputIter last,
+             const Compare& comp = Compare())
+        : vec_(first, last), comp_(comp) {}
+
+    flat_set(std::initializer_list<value_type> ilist,
+             const Compare& comp = Compare())
+        : flat_set(ilist.begin(), ilist.end(), comp) {}
+
+    flat_set& operator=(std::initializer_list<value_type> ilist) {
+        return operator=(flat_set(ilist, comp_));
+    }
+
+    bool operator==(const flat_set& other) const {
+        return size() == other.size() &&
+               std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const flat_set& other) const {
+        return !(operator==(other));
+    }
+
+    void swap(flat_set& other) {
+        using std::swap;
+        swap(vec_, other.vec_);
+        swap(comp_, other.comp_);
+    }
+
+public:
+    bool empty() const noexcept {
+        return vec_.empty();
+    }
+
+    size_type size() const noexcept {
+        return vec_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return vec_.max_size();
+    }
+
+    size_type capacity() const noexcept {
+        return vec_.capacity();
+    }
+
+    key_compare key_comp() const {
+        return comp_;
+    }
+
+    value_compare value_comp() const {
+        return comp_;
+    }
+
+    const_iterator begin()  const noexcept { return vec_.begin(); }
+    const_iterator end()    const noexcept { return vec_.end(); }
+    const_iterator cbegin() const noexcept { return vec_.begin(); }
+    const_iterator cend()   const noexcept { return vec_.end(); }
+
+    const_reverse_iterator rbegin() const noexcept { return vec_.rbegin(); }
+    const_reverse_iterator rend()   const noexcept { return vec_.rend(); }
+
+    const Key* data() const noexcept {
+        return vec_.data();
+    }
+
+public:
+    const_iterator find(const Key& k) const {
+        return find_(k);
+    }
+
+    size_type count(const Key& k) const {
+        return find_(k) != end() ? 1 : 0;
+    }
+
+    const_iterator lower_bound(const Key& k) const {
+        return lower_bound_(k);
+    }
+
+    const_iterator upper_bound(const Key& k) const {
+        return upper_bound_(k);
+    }
+
+    // heterogeneous lookup (when Compare::is_transparent is defined)
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    const_iterator find(const K& k) const {
+        return find_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    size_type count(const K& k) const {
+        return find_(k) != end() ? 1 : 0;
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    const_iterator lower_bound(const K& k) const {
+        return lower_bound_(k);
+    }
+
+    template<class K, class C=Compare, class=typename C::is_transparent>
+    const_iterator upper_bound(const K& k) const {
+        return upper_bound_(k);
+    }
+
+public:
+    void clear() {
+        vec_.clear();
+    }
+
+    void reserve(size_type c) {
+        vec_.reserve(c);
+    }
+
+    void shrink_to_fit() {
+        vec_.shrink_to_fit();
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& v) {
+        const_iterator it = lower_bound_(v);
+        if (it != vec_.end() && !comp_(v, *it)) {
+            return std::make_pair(it, false);
+        }
+        return std::make_pair(const_iterator(vec_.insert(it, v)), true);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& v) {
+        const_iterator it = lower_bound_(v);
+        if (it != vec_.end() && !comp_(v, *it)) {
+            return std::make_pair(it, false);
+        }
+        return std::make_pair(const_iterator(vec_.insert(it, std::move(v))), true);
+    }
+
+    // insert a range of keys in bulk: they are appended, sorted and
+    // then merged with existing keys
+    template<class InputIter>
+    void insert(InputIter first, InputIter last) {
+        details::flat_merge_insert(vec_, first, last, comp_);
+    }
+
+    void insert(std::initializer_list<value_type> ilist) {
+        insert(ilist.begin(), ilist.end());
+    }
+
+    iterator erase(const_iterator pos) {
+        return vec_.erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return vec_.erase(first, last);
+    }
+
+    size_type erase(const Key& k) {
+        const_iterator it = find_(k);
+        if (it == vec_.end()) return 0;
+        vec_.erase(it);
+        return 1;
+    }
+
+private:
+    template<class K>
+    const_iterator lower_bound_(const K& k) const {
+        const Compare& comp = comp_;
+        return details::flat_partition_point(vec_.data(), vec_.size(),
+            [&comp, &k](const Key& e){ return comp(e, k); });
+    }
+
+    template<class K>
+    const_iterator upper_bound_(const K& k) const {
+        const Compare& comp = comp_;
+        return details::flat_partition_point(vec_.data(), vec_.size(),
+            [&comp, &k](const Key& e){ return !comp(k, e); });
+    }
+
+    template<class K>
+    const_iterator find_(const K& k) const {
+        const_iterator it = lower_bound_(k);
+        return (it != vec_.end() && !comp_(k, *it)) ? it : vec_.end();
+    }
+
+}; // end class flat_set
+
+
+template<class Key, class Compare, class Allocator>
+inline void swap(flat_set<Key, Compare, Allocator>& lhs,
+                 flat_set<Key, Compare, Allocator>& rhs) {
+    lhs.swap(rhs);
+}
+
+} // end namespace clue
+
+#endif
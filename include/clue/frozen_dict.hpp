@@ -0,0 +1,517 @@
+/**
+ * @file frozen_dict.hpp
+ *
+ * Immutable associative containers based on perfect hashing:
+ *
+ * - frozen_dict: built once at run-time, with a minimal perfect hash.
+ * - static_dict: a literal type for key sets known at compile-time.
+ */
+
+#ifndef CLUE_FROZEN_DICT__
+#define CLUE_FROZEN_DICT__
+
+#include <clue/container_common.hpp>
+#include <clue/ordered_dict.hpp>
+#include <clue/string_view.hpp>
+#include <clue/meta.hpp>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+namespace clue {
+
+namespace details {
+
+inline uint64_t frozen_mix64(uint64_t x) noexcept {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint32_t frozen_mix32(uint32_t x) noexcept {
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+// map a uniformly distributed 32-bit value to [0, n)
+inline uint32_t frozen_reduce(uint32_t x, uint32_t n) noexcept {
+    return static_cast<uint32_t>((static_cast<uint64_t>(x) * n) >> 32);
+}
+
+} // end namespace details
+
+
+//===============================================
+//
+//   frozen_dict
+//
+//===============================================
+
+// A frozen_dict maps a fixed set of keys to values. It is constructed
+// with a minimal perfect hash function in the CHD (compress, hash and
+// displace) style: keys are first distributed into buckets (about 4
+// keys per bucket), then, from the largest bucket to the smallest, a
+// displacement value is searched for each bucket, such that its keys
+// are sent to distinct slots that remain free. There are exactly as many
+// slots as keys, and the entries are stored in slot order in a single
+// contiguous array, plus 4 bytes per bucket for the displacements.
+//
+// A lookup takes one hash evaluation and one key comparison.
+
+template<class Key,
+         class T,
+         class Hash = std::hash<Key>,
+         class KeyEqual = std::equal_to<Key>,
+         class Allocator = std::allocator< std::pair<Key,T> >
+        >
+class frozen_dict {
+public:
+    // type names
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+
+    using reference = const value_type&;
+    using const_reference = const value_type&;
+    using pointer = const value_type*;
+    using const_pointer = const value_type*;
+    using iterator = const value_type*;
+    using const_iterator = const value_type*;
+
+private:
+    using vector_type = std::vector<value_type, Allocator>;
+    using disp_allocator = typename Allocator::template rebind<uint32_t>::other;
+    using disp_vector = std::vector<uint32_t, disp_allocator>;
+
+    static constexpr size_t bucket_load = 4;
+    static constexpr size_t max_attempts = 16;
+
+    vector_type entries_;   // in slot order
+    disp_vector disp_;      // displacement of each bucket
+    uint64_t seed_ = 0;
+    Hash hash_;
+    KeyEqual keyeq_;
+
+public:
+    frozen_dict() = default;
+
+    template<class InputIter>
+    frozen_dict(InputIter first, InputIter last,
+                const Hash& hf = Hash(),
+                const KeyEqual& eq = KeyEqual())
+        : hash_(hf), keyeq_(eq) {
+        build_(vector_type(first, last));
+    }
+
+    frozen_dict(std::initializer_list<value_type> ilist,
+                const Hash& hf = Hash(),
+                const KeyEqual& eq = KeyEqual())
+        : hash_(hf), keyeq_(eq) {
+        build_(vector_type(ilist));
+    }
+
+    template<class H, class E, class A>
+    explicit frozen_dict(const ordered_dict<Key, T, H, E, A>& d)
+        : frozen_dict(d.begin(), d.end()) {}
+
+    void swap(frozen_dict& other) {
+        using std::swap;
+        entries_.swap(other.entries_);
+        disp_.swap(other.disp_);
+        swap(seed_, other.seed_);
+        swap(hash_, other.hash_);
+        swap(keyeq_, other.keyeq_);
+    }
+
+public:
+    bool empty() const noexcept {
+        return entries_.empty();
+    }
+
+    size_type size() const noexcept {
+        return entries_.size();
+    }
+
+    // the number of buckets (each taking 4 bytes for the displacement)
+    size_type bucket_count() const noexcept {
+        return disp_.size();
+    }
+
+    hasher hash_function() const {
+        return hash_;
+    }
+
+    key_equal key_eq() const {
+        return keyeq_;
+    }
+
+    const_iterator begin()  const noexcept { return entries_.data(); }
+    const_iterator end()    const noexcept { return entries_.data() + entries_.size(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend()   const noexcept { return end(); }
+
+    bool operator==(const frozen_dict& other) const {
+        if (size() != other.size()) return false;
+        for (const value_type& e: entries_) {
+            const_iterator it = other.find(e.first);
+            if (it == other.end() || !(it->second == e.second)) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const frozen_dict& other) const {
+        return !(operator==(other));
+    }
+
+public:
+    const T& at(const Key& key) const {
+        return at_(key);
+    }
+
+    const_iterator find(const Key& key) const {
+        return find_(key);
+    }
+
+    size_type count(const Key& key) const {
+        return find_(key) == end() ? 0 : 1;
+    }
+
+    // heterogeneous lookup (when both Hash and KeyEqual are transparent)
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    const T& at(const K& key) const {
+        return at_(key);
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    const_iterator find(const K& key) const {
+        return find_(key);
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    size_type count(const K& key) const {
+        return find_(key) == end() ? 0 : 1;
+    }
+
+private:
+    uint64_t mix_(size_t h) const noexcept {
+        return details::frozen_mix64(static_cast<uint64_t>(h) + seed_);
+    }
+
+    static uint32_t slot_of_(uint64_t mh, uint32_t d, uint32_t n) noexcept {
+        uint32_t x = static_cast<uint32_t>(mh) ^ (d * 0x9E3779B9u);
+        return details::frozen_reduce(details::frozen_mix32(x), n);
+    }
+
+    uint32_t bucket_of_(uint64_t mh) const noexcept {
+        return details::frozen_reduce(static_cast<uint32_t>(mh >> 32),
+                                      static_cast<uint32_t>(disp_.size()));
+    }
+
+    template<class K>
+    const_iterator find_(const K& key) const {
+        if (entries_.empty()) return end();
+        uint64_t mh = mix_(hash_(key));
+        uint32_t s = slot_of_(mh, disp_[bucket_of_(mh)],
+                              static_cast<uint32_t>(entries_.size()));
+        const value_type& e = entries_[s];
+        return keyeq_(e.first, key) ? &e : end();
+    }
+
+    template<class K>
+    const T& at_(const K& key) const {
+        const_iterator it = find_(key);
+        if (it == end())
+            throw std::out_of_range("frozen_dict::at: the key is not found.");
+        return it->second;
+    }
+
+    // Build the perfect hash from a list of entries. For repeated keys,
+    // the first occurrence is kept (as in ordered_dict::insert).
+    void build_(vector_type src) {
+        if (src.empty()) return;
+        if (src.size() >= 0xFFFFFFFFu) {
+            throw std::length_error(
+                "frozen_dict: the number of entries exceeds the 32-bit limit.");
+        }
+
+        std::vector<size_t> hs(src.size());
+        for (size_t i = 0; i < src.size(); ++i) hs[i] = hash_(src[i].first);
+        std::vector<uint32_t> keep = unique_(src, hs);
+        uint32_t n = static_cast<uint32_t>(keep.size());
+        uint32_t nb = static_cast<uint32_t>((n + bucket_load - 1) / bucket_load);
+
+        std::vector<uint32_t> slots(n);
+        for (size_t t = 0; t < max_attempts; ++t) {
+            seed_ = details::frozen_mix64(t + 1);
+            disp_.assign(nb, 0);
+            if (assign_(hs, keep, slots)) {
+                std::vector<uint32_t> inv(n);
+                for (uint32_t i = 0; i < n; ++i) inv[slots[i]] = keep[i];
+                entries_.reserve(n);
+                for (uint32_t s = 0; s < n; ++s) {
+                    entries_.push_back(std::move(src[inv[s]]));
+                }
+                return;
+            }
+        }
+        disp_.clear();
+        throw std::runtime_error(
+            "frozen_dict: failed to construct a perfect hash function.");
+    }
+
+    // get the indexes of the first occurrences of distinct keys
+    std::vector<uint32_t> unique_(const vector_type& src,
+                                  const std::vector<size_t>& hs) const {
+        size_t n = src.size();
+        std::vector<uint32_t> ord(n);
+        for (size_t i = 0; i < n; ++i) ord[i] = static_cast<uint32_t>(i);
+        std::sort(ord.begin(), ord.end(), [&](uint32_t a, uint32_t b) {
+            return hs[a] < hs[b] || (hs[a] == hs[b] && a < b);
+        });
+
+        std::vector<uint8_t> dup(n, 0);
+        for (size_t i = 0; i < n; ) {
+            size_t j = i + 1;
+            while (j < n && hs[ord[j]] == hs[ord[i]]) ++j;
+            for (size_t u = i + 1; u < j; ++u) {
+                for (size_t v = i; v < u; ++v) {
+                    if (dup[ord[v]]) continue;
+                    if (keyeq_(src[ord[v]].first, src[ord[u]].first)) {
+                        dup[ord[u]] = 1;
+                        break;
+                    }
+                }
+                if (!dup[ord[u]]) {
+                    throw std::invalid_argument(
+                        "frozen_dict: distinct keys with the same hash value.");
+                }
+            }
+            i = j;
+        }
+
+        std::vector<uint32_t> keep;
+        keep.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (!dup[i]) keep.push_back(static_cast<uint32_t>(i));
+        }
+        return keep;
+    }
+
+    // search the displacements of all buckets (with the current seed),
+    // and write the slot of each kept entry to slots.
+    bool assign_(const std::vector<size_t>& hs,
+                 const std::vector<uint32_t>& keep,
+                 std::vector<uint32_t>& slots) {
+        uint32_t n = static_cast<uint32_t>(keep.size());
+        uint32_t nb = static_cast<uint32_t>(disp_.size());
+
+        // group the entries by bucket (counting sort)
+        std::vector<uint64_t> mhs(n);
+        std::vector<uint32_t> bstart(nb + 1, 0);
+        std::vector<uint32_t> bk(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            mhs[i] = mix_(hs[keep[i]]);
+            bk[i] = bucket_of_(mhs[i]);
+            ++bstart[bk[i] + 1];
+        }
+        for (uint32_t b = 0; b < nb; ++b) bstart[b + 1] += bstart[b];
+        std::vector<uint32_t> members(n);
+        {
+            std::vector<uint32_t> fill(bstart.begin(), bstart.end() - 1);
+            for (uint32_t i = 0; i < n; ++i) members[fill[bk[i]]++] = i;
+        }
+
+        // process buckets from the largest to the smallest
+        std::vector<uint32_t> border(nb);
+        for (uint32_t b = 0; b < nb; ++b) border[b] = b;
+        std::stable_sort(border.begin(), border.end(), [&](uint32_t a, uint32_t b) {
+            return bstart[a + 1] - bstart[a] > bstart[b + 1] - bstart[b];
+        });
+
+        std::vector<uint8_t> taken(n, 0);
+        const uint64_t max_disp = 64 * static_cast<uint64_t>(n) + 1024;
+        for (uint32_t b: border) {
+            uint32_t k0 = bstart[b];
+            uint32_t k1 = bstart[b + 1];
+            if (k0 == k1) break;  // the remaining buckets are empty
+
+            bool placed = false;
+            for (uint64_t d = 0; d < max_disp && !placed; ++d) {
+                uint32_t dd = static_cast<uint32_t>(d);
+                uint32_t k = k0;
+                for (; k < k1; ++k) {
+                    uint32_t s = slot_of_(mhs[members[k]], dd, n);
+                    if (taken[s]) break;
+                    taken[s] = 1;
+                    slots[members[k]] = s;
+                }
+                if (k == k1) {
+                    disp_[b] = dd;
+                    placed = true;
+                } else {
+                    // roll back the slots taken by this attempt
+                    for (uint32_t u = k0; u < k; ++u) taken[slots[members[u]]] = 0;
+                }
+            }
+            if (!placed) return false;
+        }
+        return true;
+    }
+
+}; // end class frozen_dict
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+constexpr size_t frozen_dict<Key, T, Hash, KeyEqual, Allocator>::bucket_load;
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+constexpr size_t frozen_dict<Key, T, Hash, KeyEqual, Allocator>::max_attempts;
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+inline void swap(frozen_dict<Key, T, Hash, KeyEqual, Allocator>& lhs,
+                 frozen_dict<Key, T, Hash, KeyEqual, Allocator>& rhs) {
+    lhs.swap(rhs);
+}
+
+
+//===============================================
+//
+//   static_dict
+//
+//===============================================
+
+// A static_dict is a literal type that maps a fixed set of string keys
+// to values, so it can be constructed, and looked up, at compile-time:
+//
+//   constexpr auto colors = make_static_dict<int>({
+//       {"red", 0xFF0000}, {"green", 0x00FF00}, {"blue", 0x0000FF}});
+//   static_assert(colors.at("green") == 0x00FF00, "");
+//
+// C++11 constexpr functions cannot run the displacement search of
+// frozen_dict (which needs loops and mutable state), so the 64-bit hash
+// values of all keys are computed at compile-time instead, and a lookup
+// scans them, comparing characters only upon a hash match. This suits
+// the small key sets (up to a few hundred keys) that are written in code;
+// for larger sets, use frozen_dict.
+
+namespace details {
+
+constexpr size_t cx_strlen(const char* s, size_t n = 0) {
+    return s[n] == '\0' ? n : cx_strlen(s, n + 1);
+}
+
+// FNV-1a over the characters
+constexpr uint64_t cx_fnv1a(const char* s, size_t n,
+                            uint64_t h = 14695981039346656037ULL) {
+    return n == 0 ? h :
+        cx_fnv1a(s + 1, n - 1, (h ^ static_cast<unsigned char>(*s)) * 1099511628211ULL);
+}
+
+constexpr bool cx_equal(const char* a, const char* b, size_t n) {
+    return n == 0 || (*a == *b && cx_equal(a + 1, b + 1, n - 1));
+}
+
+} // end namespace details
+
+template<class T>
+struct static_dict_entry {
+    string_view key;
+    T value;
+
+    constexpr static_dict_entry(const char* k, const T& v)
+        : key(k, details::cx_strlen(k)), value(v) {}
+};
+
+template<class T, size_t N>
+class static_dict {
+    static_assert(N > 0, "static_dict: the key set should not be empty.");
+
+public:
+    using key_type = string_view;
+    using mapped_type = T;
+    using value_type = static_dict_entry<T>;
+    using size_type = size_t;
+    using const_iterator = const value_type*;
+    using iterator = const_iterator;
+
+private:
+    value_type entries_[N];
+    uint64_t hashes_[N];
+
+    template<size_t... I>
+    constexpr static_dict(const value_type (&es)[N], meta::index_seq<I...>)
+        : entries_{es[I]...}
+        , hashes_{details::cx_fnv1a(es[I].key.data(), es[I].key.size())...} {}
+
+public:
+    constexpr explicit static_dict(const value_type (&es)[N])
+        : static_dict(es, meta::make_index_seq<N>{}) {}
+
+    constexpr size_type size() const noexcept { return N; }
+    constexpr bool empty() const noexcept { return false; }
+
+    constexpr const_iterator begin() const noexcept { return entries_; }
+    constexpr const_iterator end()   const noexcept { return entries_ + N; }
+
+    constexpr const value_type& operator[](size_type i) const {
+        return entries_[i];
+    }
+
+    // the position of the entry with the given key (or size() if not found)
+    constexpr size_type index_of(string_view key) const {
+        return find_(key, details::cx_fnv1a(key.data(), key.size()), 0);
+    }
+
+    constexpr size_type index_of(const char* key) const {
+        return index_of(string_view(key, details::cx_strlen(key)));
+    }
+
+    template<class K>
+    constexpr size_type count(const K& key) const {
+        return index_of(key) < N ? 1 : 0;
+    }
+
+    template<class K>
+    constexpr const T& at(const K& key) const {
+        return at_pos_(index_of(key));
+    }
+
+private:
+    constexpr size_type find_(string_view key, uint64_t h, size_t i) const {
+        return i == N ? N :
+            (hashes_[i] == h &&
+             entries_[i].key.size() == key.size() &&
+             details::cx_equal(entries_[i].key.data(), key.data(), key.size())) ? i :
+            find_(key, h, i + 1);
+    }
+
+    constexpr const T& at_pos_(size_t i) const {
+        return i < N ? entries_[i].value :
+            (throw std::out_of_range("static_dict::at: the key is not found."),
+             entries_[0].value);
+    }
+};
+
+template<class T, size_t N>
+constexpr static_dict<T, N> make_static_dict(const static_dict_entry<T> (&es)[N]) {
+    return static_dict<T, N>(es);
+}
+
+} // end namespace clue
+
+#endif
@@ -0,0 +1,189 @@
+/**
+ * @file hash.hpp
+ *
+ * Fast non-cryptographic hashing of byte sequences (in the style of
+ * wyhash), and utilities to combine hash values for composite keys.
+ */
+
+#ifndef CLUE_HASH__
+#define CLUE_HASH__
+
+#include <clue/common.hpp>
+#include <clue/meta.hpp>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <utility>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace clue {
+
+namespace details {
+
+// The hash is built on a 64 x 64 -> 128 bit multiplication, whose two
+// halves are folded together (mum). A single multiplication mixes all
+// input bits well, and it is much cheaper per byte than byte-at-a-time
+// schemes; long inputs are consumed 48 bytes at a time, in three
+// independent lanes.
+
+constexpr uint64_t wy_p0 = 0x2d358dccaa6c78a5ULL;
+constexpr uint64_t wy_p1 = 0x8bb84b93962eacc9ULL;
+constexpr uint64_t wy_p2 = 0x4b33a62ed433d4a3ULL;
+constexpr uint64_t wy_p3 = 0x4d5a2da51de1aa47ULL;
+
+inline void wy_mum(uint64_t& a, uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 u128_t;
+    u128_t r = static_cast<u128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    a = lo;
+    b = hi;
+#endif
+}
+
+inline uint64_t wy_mix(uint64_t a, uint64_t b) noexcept {
+    wy_mum(a, b);
+    return a ^ b;
+}
+
+inline uint64_t wy_r8(const unsigned char* p) noexcept {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t wy_r4(const unsigned char* p) noexcept {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+// 1 - 3 bytes
+inline uint64_t wy_r3(const unsigned char* p, size_t k) noexcept {
+    return (static_cast<uint64_t>(p[0]) << 16) |
+           (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+} // end namespace details
+
+
+// hash a sequence of n bytes
+
+inline uint64_t hash_bytes(const void* data, size_t n, uint64_t seed = 0) noexcept {
+    using namespace details;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= wy_mix(seed ^ wy_p0, wy_p1);
+    uint64_t a, b;
+    if (CLUE_LIKELY(n <= 16)) {
+        if (CLUE_LIKELY(n >= 4)) {
+            // two (possibly overlapping) pairs of 4-byte words
+            size_t d = (n >> 3) << 2;
+            a = (wy_r4(p) << 32) | wy_r4(p + d);
+            b = (wy_r4(p + n - 4) << 32) | wy_r4(p + n - 4 - d);
+        } else if (CLUE_LIKELY(n > 0)) {
+            a = wy_r3(p, n);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = n;
+        if (CLUE_UNLIKELY(i > 48)) {
+            uint64_t s1 = seed, s2 = seed;
+            do {
+                seed = wy_mix(wy_r8(p) ^ wy_p1, wy_r8(p + 8) ^ seed);
+                s1 = wy_mix(wy_r8(p + 16) ^ wy_p2, wy_r8(p + 24) ^ s1);
+                s2 = wy_mix(wy_r8(p + 32) ^ wy_p3, wy_r8(p + 40) ^ s2);
+                p += 48;
+                i -= 48;
+            } while (CLUE_LIKELY(i > 48));
+            seed ^= s1 ^ s2;
+        }
+        while (CLUE_UNLIKELY(i > 16)) {
+            seed = wy_mix(wy_r8(p) ^ wy_p1, wy_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        // the last 16 bytes (which may overlap with those consumed)
+        a = wy_r8(p + i - 16);
+        b = wy_r8(p + i - 8);
+    }
+    a ^= wy_p1;
+    b ^= seed;
+    wy_mum(a, b);
+    return wy_mix(a ^ wy_p0 ^ n, b ^ wy_p1);
+}
+
+// hash a contiguous sequence of n trivially copyable values, by their
+// object representations (so types with padding bytes, or with distinct
+// representations of equal values, e.g. -0.0 and 0.0, are not suitable)
+
+template<class T>
+inline uint64_t hash_span(const T* data, size_t n, uint64_t seed = 0) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "hash_span: T must be trivially copyable.");
+    return hash_bytes(data, n * sizeof(T), seed);
+}
+
+// mix two 64-bit values into one (not symmetric)
+
+inline uint64_t hash_mix(uint64_t a, uint64_t b) noexcept {
+    return details::wy_mix(a ^ details::wy_p0, b ^ details::wy_p1);
+}
+
+
+// combining hash values, for composite keys
+
+template<class T, class Hash=std::hash<T>>
+inline void hash_combine(size_t& seed, const T& v) {
+    seed = static_cast<size_t>(hash_mix(seed, Hash()(v)));
+}
+
+template<class... Ts>
+inline size_t hash_values(const Ts&... vs) {
+    size_t seed = 0;
+    // a braced list is evaluated in order
+    int order[] = {0, (hash_combine(seed, vs), 0)...};
+    (void)order;
+    return seed;
+}
+
+// a hasher for std::pair and std::tuple, combining the std::hash
+// of the components
+
+struct tuple_hash {
+    template<class A, class B>
+    size_t operator()(const std::pair<A, B>& p) const {
+        return hash_values(p.first, p.second);
+    }
+
+    template<class... Ts>
+    size_t operator()(const std::tuple<Ts...>& t) const {
+        return apply_(t, meta::make_index_seq<sizeof...(Ts)>{});
+    }
+
+private:
+    template<class Tup, size_t... I>
+    static size_t apply_(const Tup& t, meta::index_seq<I...>) {
+        return hash_values(std::get<I>(t)...);
+    }
+};
+
+} // end namespace clue
+
+#endif
@@ -9,24 +9,92 @@
 #define CLUE_KEYED_VECTOR__
 
 #include <clue/container_common.hpp>
+#include <clue/memory.hpp>
 #include <vector>
 #include <unordered_map>
 
 namespace clue {
 
+namespace details {
+
+template<class F>
+struct has_transparent_tag {
+    template<class U> static std::true_type test(typename U::is_transparent*);
+    template<class U> static std::false_type test(...);
+    static constexpr bool value = decltype(test<F>(nullptr))::value;
+};
+
+struct kvec_transparent_equal_to {
+    typedef void is_transparent;
+
+    template<class A, class B>
+    bool operator()(const A& a, const B& b) const {
+        return a == b;
+    }
+};
+
+// whether the index map supports insertion with precomputed hash values
+template<class Map, class Key>
+struct kvec_has_hashed_insert {
+    template<class M> static std::true_type test(
+        decltype(std::declval<M&>().try_emplace_hashed(
+            size_t(0), std::declval<const Key&>(), size_t(0)))*);
+    template<class M> static std::false_type test(...);
+    static constexpr bool value = decltype(test<Map>(nullptr))::value;
+};
+
+// The key equality of the index: it is transparent when the hasher is,
+// such that the index can be searched with other (compatible) key types.
+template<class Key, class Hash>
+using kvec_key_equal_t = conditional_t<
+    has_transparent_tag<Hash>::value,
+    kvec_transparent_equal_to,
+    std::equal_to<Key>>;
+
+// The memory usage of the index map: as reported by the map itself if
+// it provides memory_usage() (e.g. flat_hash_map), or otherwise as
+// estimated for a node-based map (e.g. std::unordered_map), with one
+// node per entry holding a link, the entry and a cached hash value.
+template<class Map>
+auto kvec_index_usage(const Map& m, int) -> decltype(m.memory_usage()) {
+    return m.memory_usage();
+}
+
+template<class Map>
+memory_usage_info kvec_index_usage(const Map& m, long) {
+    const size_t node = sizeof(void*) + sizeof(typename Map::value_type) + sizeof(size_t);
+    const size_t nb = m.bucket_count() * sizeof(void*);
+    return memory_usage_info(
+        m.size() * node, nb, 0,
+        m.size() * malloc_overhead(node) + malloc_overhead(nb));
+}
+
+}
+
+// The IndexMap template parameter selects the hash map that associates
+// keys with positions. It can be std::unordered_map (default), or
+// clue::flat_hash_map (in <clue/flat_hash_map.hpp>), which is
+// considerably faster for lookup-heavy workloads.
+//
+// With a transparent Hash (e.g. clue::string_hash), by and find also
+// accept other key types (e.g. string views for string keys) without
+// constructing a key_type. This requires an IndexMap that supports
+// heterogeneous lookup, such as clue::flat_hash_map.
+
 template<class T,
          class Key,
          class Hash=std::hash<Key>,
-         class Allocator=std::allocator<T>
+         class Allocator=std::allocator<T>,
+         template<class...> class IndexMap=std::unordered_map
         >
 class keyed_vector {
 private:
     using vector_type = std::vector<T, Allocator>;
-    using map_type = std::unordered_map<
+    using map_type = IndexMap<
         Key,
         size_t,
         Hash,
-        std::equal_to<Key>,
+        details::kvec_key_equal_t<Key, Hash>,
         typename Allocator::template rebind<std::pair<const Key, size_t>>::other>;
 
 public:
@@ -108,6 +176,17 @@ public:
         return vec_.capacity();
     }
 
+    // the whole index map is counted as index (except its allocator overhead)
+    memory_usage_info memory_usage() const {
+        const size_t es = sizeof(T);
+        memory_usage_info m = details::kvec_index_usage(imap_, 0);
+        return memory_usage_info(
+            vec_.size() * es,
+            m.elements + m.index + m.slack,
+            (vec_.capacity() - vec_.size()) * es,
+            malloc_overhead(vec_.capacity() * es) + m.overhead);
+    }
+
     iterator begin() { return vec_.begin(); }
     iterator end()   { return vec_.end(); }
 
@@ -164,6 +243,31 @@ public:
         return it == imap_.end() ? vec_.end() : vec_.begin() + it->second;
     }
 
+    template<class K, class H=Hash, class=typename H::is_transparent>
+    const T& by(const K& k) const { return vec_[imap_.at(k)]; }
+
+    template<class K, class H=Hash, class=typename H::is_transparent>
+    T& by(const K& k) { return vec_[imap_.at(k)]; }
+
+    template<class K, class H=Hash, class=typename H::is_transparent>
+    const_iterator find(const K& k) const {
+        auto it = imap_.find(k);
+        return it == imap_.end() ? vec_.end() : vec_.begin() + it->second;
+    }
+
+    template<class K, class H=Hash, class=typename H::is_transparent>
+    iterator find(const K& k) {
+        auto it = imap_.find(k);
+        return it == imap_.end() ? vec_.end() : vec_.begin() + it->second;
+    }
+
+    // invoke f(k, i) for each key k, with i the position of its element
+    // (in the order of the index, not that of the elements)
+    template<class F>
+    void foreach_key(F&& f) const {
+        for (const auto& e: imap_) f(e.first, e.second);
+    }
+
 public:
     void clear() {
         vec_.clear();
@@ -176,81 +280,168 @@ public:
     }
 
     void push_back(const key_type& k, const value_type& v) {
-        check_dupkey(k);
-        vec_.push_back(v);
-        imap_.emplace(k, vec_.size() - 1);
+        auto it = add_key(k);
+        try {
+            vec_.push_back(v);
+        } catch (...) {
+            imap_.erase(it);
+            throw;
+        }
     }
 
     void push_back(const key_type& k, value_type&& v) {
-        check_dupkey(k);
-        vec_.push_back(std::move(v));
-        imap_.emplace(k, vec_.size() - 1);
+        auto it = add_key(k);
+        try {
+            vec_.push_back(std::move(v));
+        } catch (...) {
+            imap_.erase(it);
+            throw;
+        }
     }
 
     void push_back(key_type&& k, const value_type& v) {
-        check_dupkey(k);
-        vec_.push_back(v);
-        imap_.emplace(std::move(k), vec_.size() - 1);
+        auto it = add_key(std::move(k));
+        try {
+            vec_.push_back(v);
+        } catch (...) {
+            imap_.erase(it);
+            throw;
+        }
     }
 
     void push_back(key_type&& k, value_type&& v) {
-        check_dupkey(k);
-        vec_.push_back(std::move(v));
-        imap_.emplace(std::move(k), vec_.size() - 1);
+        auto it = add_key(std::move(k));
+        try {
+            vec_.push_back(std::move(v));
+        } catch (...) {
+            imap_.erase(it);
+            throw;
+        }
     }
 
     template<class... Args>
     void emplace_back(const key_type& k, Args&&... args) {
-        check_dupkey(k);
-        vec_.emplace_back(std::forward<Args>(args)...);
-        imap_.emplace(k, vec_.size() - 1);
+        auto it = add_key(k);
+        try {
+            vec_.emplace_back(std::forward<Args>(args)...);
+        } catch (...) {
+            imap_.erase(it);
+            throw;
+        }
     }
 
     template<class... Args>
     void emplace_back(key_type&& k, Args&&... args) {
-        check_dupkey(k);
-        vec_.emplace_back(std::forward<Args>(args)...);
-        imap_.emplace(std::move(k), vec_.size() - 1);
+        auto it = add_key(std::move(k));
+        try {
+            vec_.emplace_back(std::forward<Args>(args)...);
+        } catch (...) {
+            imap_.erase(it);
+            throw;
+        }
     }
 
+    // Over random-access ranges, extend works in bulk: the storage is
+    // reserved upfront, and all keys are checked before any element is
+    // appended, so a duplicated key leaves the keyed vector unchanged.
+
     template<class InputIter>
     void extend(InputIter first, InputIter last) {
         using tag_t = typename std::iterator_traits<InputIter>::iterator_category;
-        try_reserve_for_range(first, last, tag_t{});
-        for(; first != last; ++first) {
-            push_back(first->first, first->second);
-        }
+        extend_range(first, last, tag_t{});
     }
 
     void extend(std::initializer_list<std::pair<Key, T>> ilist) {
-        reserve(size() + ilist.size());
-        for (const auto& e: ilist) {
-            push_back(e.first, e.second);
+        extend_bulk(ilist.begin(), ilist.size(), nullptr);
+    }
+
+    // Bulk extension with the keys hashed in parallel on a thread pool
+    // (declared in <clue/thread_pool.hpp>). The hash values are used only
+    // when the index map accepts precomputed hash values (flat_hash_map).
+    template<class RandomIter>
+    void extend(RandomIter first, RandomIter last, thread_pool& pool) {
+        size_t n = static_cast<size_t>(last - first);
+        if (!details::kvec_has_hashed_insert<map_type, Key>::value) {
+            extend_bulk(first, n, nullptr);
+            return;
         }
+        using hash_allocator = typename Allocator::template rebind<size_t>::other;
+        std::vector<size_t, hash_allocator> hs(n);
+        Hash hf = imap_.hash_function();
+        details::parallel_chunks(pool, n, 4096, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) hs[i] = hf(first[i].first);
+        });
+        extend_bulk(first, n, hs.data());
     }
 
 private:
-    void check_dupkey(const key_type& k) const {
-        if (imap_.find(k) != imap_.end()) {
+    template<class K>
+    typename map_type::iterator add_key(K&& k) {
+        auto r = imap_.emplace(std::forward<K>(k), vec_.size());
+        if (!r.second) {
             throw std::invalid_argument(
                 "keyed_vector: the inserted key already existed.");
         }
+        return r.first;
+    }
+
+    bool add_key_hashed(const key_type& k, size_t pos, size_t h, std::true_type) {
+        return imap_.try_emplace_hashed(h, k, pos).second;
+    }
+
+    bool add_key_hashed(const key_type& k, size_t pos, size_t, std::false_type) {
+        return imap_.emplace(k, pos).second;
     }
 
     template<class InputIter, typename tag_t>
-    void try_reserve_for_range(InputIter, InputIter, tag_t) {}
+    void extend_range(InputIter first, InputIter last, tag_t) {
+        for(; first != last; ++first) {
+            push_back(first->first, first->second);
+        }
+    }
 
     template<class InputIter>
-    void try_reserve_for_range(InputIter first, InputIter last,
-                               std::random_access_iterator_tag) {
-        reserve(size() + static_cast<size_t>(last - first));
+    void extend_range(InputIter first, InputIter last,
+                      std::random_access_iterator_tag) {
+        extend_bulk(first, static_cast<size_t>(last - first), nullptr);
+    }
+
+    // add n entries from a random-access range, with the hash values
+    // of the keys given by hs (or nullptr), as a whole or not at all.
+    template<class RandomIter>
+    void extend_bulk(RandomIter first, size_t n, const size_t* hs) {
+        using tag_t = std::integral_constant<bool,
+            details::kvec_has_hashed_insert<map_type, Key>::value>;
+        size_t n0 = vec_.size();
+        reserve(n0 + n);
+        size_t i = 0;
+        try {
+            for (; i < n; ++i) {
+                const key_type& k = first[i].first;
+                bool added = hs ?
+                    add_key_hashed(k, n0 + i, hs[i], tag_t{}) :
+                    imap_.emplace(k, n0 + i).second;
+                if (!added) {
+                    throw std::invalid_argument(
+                        "keyed_vector: the inserted key already existed.");
+                }
+            }
+            for (size_t j = 0; j < n; ++j) {
+                vec_.push_back(first[j].second);
+            }
+        } catch (...) {
+            for (size_t j = 0; j < i; ++j) imap_.erase(first[j].first);
+            vec_.erase(vec_.begin() + n0, vec_.end());
+            throw;
+        }
     }
 
 }; // end class keyed_vector
 
-template<class T, class Key, class Hash, class Allocator>
-inline void swap(keyed_vector<T, Key, Hash, Allocator>& lhs,
-                 keyed_vector<T, Key, Hash, Allocator>& rhs) {
+template<class T, class Key, class Hash, class Allocator,
+         template<class...> class IndexMap>
+inline void swap(keyed_vector<T, Key, Hash, Allocator, IndexMap>& lhs,
+                 keyed_vector<T, Key, Hash, Allocator, IndexMap>& rhs) {
     lhs.swap(rhs);
 }
 
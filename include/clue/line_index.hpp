@@ -0,0 +1,345 @@
+/**
+ * @file line_index.hpp
+ *
+ * A persistent index of the lines of a text file, for random access to
+ * lines by their numbers.
+ *
+ * The index records the offset of every K-th line (K is called the
+ * stride), so it takes 8 / K bytes per line, and line n is found by one
+ * lookup (of line n / K * K) followed by a forward scan of fewer than K
+ * lines. It is saved to a side file, and updated incrementally when the
+ * text file is appended to: only the appended part is scanned.
+ */
+
+#ifndef CLUE_LINE_INDEX__
+#define CLUE_LINE_INDEX__
+
+#include <clue/textio.hpp>
+#include <clue/memscan.hpp>
+#include <clue/hash.hpp>
+#include <clue/parallel_lines.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace clue {
+
+namespace details {
+
+struct line_index_header {
+    char magic[8];          // "CLUELIDX"
+    uint32_t version;
+    uint32_t byte_order;    // 0x01020304 as written on the saving machine
+    uint64_t stride;
+    uint64_t num_lines;
+    uint64_t indexed_size;
+    uint64_t tail_hash;
+    uint64_t count;         // the number of offsets that follow
+};
+
+constexpr uint32_t line_index_version = 1;
+constexpr uint32_t line_index_byte_order = 0x01020304u;
+
+// the indexed text is identified by a hash of its last bytes, so that a
+// file that has been rewritten (rather than appended to) is detected
+constexpr size_t line_index_tail = 4096;
+
+inline uint64_t line_index_tail_hash(string_view text, uint64_t size) noexcept {
+    const size_t n = static_cast<size_t>(std::min<uint64_t>(size, line_index_tail));
+    return hash_bytes(text.data() + (size - n), n);
+}
+
+} // end namespace details
+
+
+class line_index {
+public:
+    static constexpr size_t default_stride = 1024;
+
+private:
+    size_t stride_;
+    uint64_t nlines_;           // the number of complete lines indexed
+    uint64_t size_;             // the size of the text indexed, in bytes
+    uint64_t tail_hash_;
+    std::vector<uint64_t> offsets_;     // the offsets of lines 0, K, 2K, ...
+
+public:
+    explicit line_index(size_t stride = default_stride)
+        : stride_(stride), nlines_(0), size_(0)
+        , tail_hash_(details::line_index_tail_hash(string_view(), 0))
+        , offsets_(1, 0) {
+        if (stride == 0)
+            throw std::invalid_argument("line_index: the stride must be positive.");
+    }
+
+    size_t stride() const noexcept {
+        return stride_;
+    }
+
+    // the number of complete lines (i.e. ending with '\n') indexed
+    uint64_t num_lines() const noexcept {
+        return nlines_;
+    }
+
+    // the size of the text indexed, which ends right after the last
+    // complete line
+    uint64_t indexed_size() const noexcept {
+        return size_;
+    }
+
+    // the number of offsets recorded
+    size_t num_entries() const noexcept {
+        return offsets_.size();
+    }
+
+    // the offset of line i * stride()
+    uint64_t entry(size_t i) const {
+        return offsets_.at(i);
+    }
+
+    // the offset from which line n can be found by skipping n % stride()
+    // lines, i.e. the offset of line n / stride() * stride(). n can be up
+    // to num_lines() (the line being appended, if any).
+    uint64_t seek_offset(uint64_t n) const {
+        if (n > nlines_)
+            throw std::out_of_range("line_index: the line number is out of range.");
+        return offsets_[static_cast<size_t>(n / stride_)];
+    }
+
+    // whether text begins with the text indexed (as far as can be
+    // checked without scanning it)
+    bool extended_by(string_view text) const noexcept {
+        return text.size() >= size_ &&
+            details::line_index_tail_hash(text, size_) == tail_hash_;
+    }
+
+    // index the lines of text beyond indexed_size(), where text must begin
+    // with the text indexed (e.g. it is the same file, appended to). A
+    // trailing line without '\n' is left to the next update.
+    void extend(string_view text) {
+        check_extended_by_(text);
+        finish_(text, record_(text, size_, text.size(), nlines_, offsets_));
+    }
+
+    // the same as extend(text), with the text scanned in parallel on a
+    // thread pool (see parallel_lines)
+    void extend(thread_pool& pool, string_view text) {
+        check_extended_by_(text);
+        const size_t b = static_cast<size_t>(size_);
+        std::vector<string_view> chunks = line_chunks(
+            text.substr(b), details::parallel_lines_nchunks(pool, text.size() - b));
+        const size_t m = chunks.size();
+
+        // count the lines of each chunk, and then record the offsets in
+        // each chunk knowing the number of the first line there
+        std::vector<uint64_t> counts(m + 1, 0);
+        details::parallel_run(pool, m, [&](size_t i) {
+            counts[i + 1] = count_byte(chunks[i].data(), chunks[i].size(), '\n');
+        });
+        for (size_t i = 0; i < m; ++i) counts[i + 1] += counts[i];
+
+        std::vector<std::vector<uint64_t>> recs(m);
+        details::parallel_run(pool, m, [&](size_t i) {
+            const uint64_t cb = static_cast<uint64_t>(chunks[i].data() - text.data());
+            record_(text, cb, cb + chunks[i].size(), nlines_ + counts[i], recs[i]);
+        });
+        for (const std::vector<uint64_t>& r: recs)
+            offsets_.insert(offsets_.end(), r.begin(), r.end());
+        finish_(text, counts[m]);
+    }
+
+public:
+    void save(std::ostream& out) const {
+        details::line_index_header hdr;
+        std::memset(&hdr, 0, sizeof(hdr));
+        std::memcpy(hdr.magic, "CLUELIDX", 8);
+        hdr.version = details::line_index_version;
+        hdr.byte_order = details::line_index_byte_order;
+        hdr.stride = stride_;
+        hdr.num_lines = nlines_;
+        hdr.indexed_size = size_;
+        hdr.tail_hash = tail_hash_;
+        hdr.count = offsets_.size();
+        out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+        out.write(reinterpret_cast<const char*>(offsets_.data()),
+                  static_cast<std::streamsize>(offsets_.size() * sizeof(uint64_t)));
+        if (!out) throw std::runtime_error("line_index::save: failed to write.");
+    }
+
+    void save(const std::string& filename) const {
+        std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) throw
+            std::runtime_error(std::string("Failed to open file ") + filename);
+        save(out);
+        out.close();
+        if (!out) throw
+            std::runtime_error(std::string("Failed to write file ") + filename);
+    }
+
+    // load an index saved by save; it throws std::invalid_argument
+    // if the data is not a valid index
+    static line_index load(std::istream& in) {
+        details::line_index_header hdr;
+        if (!in.read(reinterpret_cast<char*>(&hdr), sizeof(hdr)))
+            invalid_("the data is too short.");
+        if (std::memcmp(hdr.magic, "CLUELIDX", 8) != 0)
+            invalid_("bad magic number.");
+        if (hdr.version != details::line_index_version)
+            invalid_("unsupported version.");
+        if (hdr.byte_order != details::line_index_byte_order)
+            invalid_("mismatched byte order.");
+        if (hdr.stride == 0 || hdr.count != hdr.num_lines / hdr.stride + 1)
+            invalid_("corrupted header.");
+
+        line_index idx(static_cast<size_t>(hdr.stride));
+        idx.nlines_ = hdr.num_lines;
+        idx.size_ = hdr.indexed_size;
+        idx.tail_hash_ = hdr.tail_hash;
+        idx.offsets_.resize(static_cast<size_t>(hdr.count));
+        if (!in.read(reinterpret_cast<char*>(idx.offsets_.data()),
+                     static_cast<std::streamsize>(hdr.count * sizeof(uint64_t))))
+            invalid_("the data is too short.");
+        return idx;
+    }
+
+    static line_index load(const std::string& filename) {
+        std::ifstream in(filename, std::ios::in | std::ios::binary);
+        if (!in) throw
+            std::runtime_error(std::string("Failed to open file ") + filename);
+        return load(in);
+    }
+
+private:
+    void check_extended_by_(string_view text) const {
+        if (!extended_by(text)) throw std::invalid_argument(
+            "line_index::extend: the text does not begin with the text indexed.");
+    }
+
+    // scan text[b, e), where line first begins at b, and record the
+    // offsets of the lines whose numbers are multiples of the stride;
+    // return the number of complete lines in text[b, e)
+    template<class Vec>
+    uint64_t record_(string_view text, uint64_t b, uint64_t e, uint64_t first, Vec& out) const {
+        const uint64_t k = stride_;
+        uint64_t line = first;
+        foreach_byte(text.data() + b, static_cast<size_t>(e - b), '\n', [&](size_t i) {
+            if (++line % k == 0) out.push_back(b + i + 1);
+        });
+        return line - first;
+    }
+
+    // account for n more complete lines at the end of text
+    void finish_(string_view text, uint64_t n) {
+        if (n == 0) return;
+        uint64_t e = text.size();
+        while (text[static_cast<size_t>(e - 1)] != '\n') --e;
+        nlines_ += n;
+        size_ = e;
+        tail_hash_ = details::line_index_tail_hash(text, size_);
+    }
+
+    [[noreturn]] static void invalid_(const char* msg) {
+        throw std::invalid_argument(std::string("line_index::load: ") + msg);
+    }
+};
+
+
+#ifdef CLUE_HAS_MMAP
+
+// Update the index of a text file saved in index_filename (or build it if
+// the index file does not exist, or the text file has been rewritten
+// rather than appended to), save it, and return it. A pool can be given
+// to scan the text in parallel.
+
+inline line_index update_line_index(const std::string& filename,
+                                    const std::string& index_filename,
+                                    size_t stride = line_index::default_stride,
+                                    thread_pool* pool = nullptr) {
+    mapped_file text(filename, mapped_file::sequential);
+    line_index idx(stride);
+    std::ifstream in(index_filename, std::ios::in | std::ios::binary);
+    if (in) {
+        line_index old = line_index::load(in);
+        if (old.stride() == stride && old.extended_by(text)) idx = std::move(old);
+    }
+    in.close();
+    if (pool) {
+        idx.extend(*pool, text);
+    } else {
+        idx.extend(text);
+    }
+    idx.save(index_filename);
+    return idx;
+}
+
+
+// Random access to the lines of a text file with a line index. The file
+// is mapped, and lines appended after the index was built (but before
+// the reader is constructed) are indexed in memory. Like line_stream,
+// each line includes its delimiter '\n' (except possibly the last one).
+
+class indexed_line_reader {
+private:
+    mapped_file file_;
+    line_index idx_;
+
+public:
+    indexed_line_reader(const std::string& filename, line_index idx)
+        : file_(filename, mapped_file::random)
+        , idx_(std::move(idx)) {
+        idx_.extend(file_);
+    }
+
+    const line_index& index() const noexcept {
+        return idx_;
+    }
+
+    string_view text() const noexcept {
+        return file_.view();
+    }
+
+    // the number of lines, including a trailing line without '\n'
+    uint64_t num_lines() const noexcept {
+        return idx_.num_lines() + (idx_.indexed_size() < file_.size() ? 1 : 0);
+    }
+
+    // line n (0-based)
+    string_view line(uint64_t n) const {
+        return lines(n, n + 1);
+    }
+
+    // lines [first, last), as a contiguous part of the text
+    string_view lines(uint64_t first, uint64_t last) const {
+        if (first > last || last > num_lines())
+            throw std::out_of_range("indexed_line_reader: the line range is out of range.");
+        // the trailing line without '\n' (if any) is not in the index, so
+        // the seek goes to the last indexed line at most, and skips the rest
+        const uint64_t s = std::min(first, idx_.num_lines());
+        const size_t b = skip_(idx_.seek_offset(s),
+                               static_cast<size_t>(s % idx_.stride() + (first - s)));
+        const size_t e = skip_(b, static_cast<size_t>(last - first));
+        return file_.view().substr(b, e - b);
+    }
+
+private:
+    // the offset after skipping n lines from offset b
+    size_t skip_(size_t b, size_t n) const {
+        const char* s = file_.data();
+        const size_t len = file_.size();
+        for (; n > 0 && b < len; --n) {
+            const char* p = find_byte(s + b, len - b, '\n');
+            b = p ? static_cast<size_t>(p - s) + 1 : len;
+        }
+        return b;
+    }
+};
+
+#endif  // CLUE_HAS_MMAP
+
+} // end namespace clue
+
+#endif
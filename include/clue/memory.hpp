@@ -3,6 +3,8 @@
 
 #include <clue/common.hpp>
 #include <new>  // for std::bad_alloc
+#include <atomic>
+#include <memory>
 
 #if (defined(_WIN32) || defined(_WIN64)) && defined(_MSC_VER)
 #include <malloc.h>
@@ -48,6 +50,164 @@ inline void aligned_free(void *p)
 
 #endif
 
+
+// Memory usage of a container, in bytes. It covers the memory the
+// container manages itself, but not the memory owned by its elements
+// (e.g. the heap buffers of std::string elements).
+
+struct memory_usage_info {
+    size_t elements;   // live elements
+    size_t index;      // hash indexes and other auxiliary structures
+    size_t slack;      // reserved but unused capacity (including erased entries)
+    size_t overhead;   // estimated allocator bookkeeping and rounding
+
+    constexpr memory_usage_info() noexcept
+        : elements(0), index(0), slack(0), overhead(0) {}
+
+    constexpr memory_usage_info(size_t e, size_t i, size_t s, size_t o) noexcept
+        : elements(e), index(i), slack(s), overhead(o) {}
+
+    constexpr size_t total() const noexcept {
+        return elements + index + slack + overhead;
+    }
+
+    memory_usage_info& operator+=(const memory_usage_info& r) noexcept {
+        elements += r.elements;
+        index += r.index;
+        slack += r.slack;
+        overhead += r.overhead;
+        return *this;
+    }
+};
+
+// An estimate of the bookkeeping overhead of a heap block of n bytes,
+// following the common malloc layout: a size_t header, and the block
+// rounded up to a multiple of 2 * sizeof(size_t).
+inline size_t malloc_overhead(size_t n) noexcept {
+    if (n == 0) return 0;
+    const size_t a = 2 * sizeof(size_t);
+    return (n + sizeof(size_t) + a - 1) / a * a - n;
+}
+
+
+// Allocation statistics (live bytes, peak bytes, and the number of
+// allocations) shared by all counting_allocators with the same Tag.
+
+template<class Tag>
+class allocation_stats {
+private:
+    static std::atomic<size_t> live_;
+    static std::atomic<size_t> peak_;
+    static std::atomic<size_t> count_;
+
+public:
+    static size_t live_bytes() noexcept {
+        return live_.load(std::memory_order_relaxed);
+    }
+
+    static size_t peak_bytes() noexcept {
+        return peak_.load(std::memory_order_relaxed);
+    }
+
+    static size_t num_allocations() noexcept {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    // reset the peak to the current live bytes
+    static void reset_peak() noexcept {
+        peak_.store(live_bytes(), std::memory_order_relaxed);
+    }
+
+    static void on_allocate(size_t n) noexcept {
+        size_t v = live_.fetch_add(n, std::memory_order_relaxed) + n;
+        size_t p = peak_.load(std::memory_order_relaxed);
+        while (v > p && !peak_.compare_exchange_weak(p, v, std::memory_order_relaxed));
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void on_deallocate(size_t n) noexcept {
+        live_.fetch_sub(n, std::memory_order_relaxed);
+    }
+};
+
+template<class Tag> std::atomic<size_t> allocation_stats<Tag>::live_(0);
+template<class Tag> std::atomic<size_t> allocation_stats<Tag>::peak_(0);
+template<class Tag> std::atomic<size_t> allocation_stats<Tag>::count_(0);
+
+
+// An allocator adaptor that records the bytes it allocates in
+// allocation_stats<Tag>. Rebinding keeps the tag, so all allocations
+// made by a container (e.g. its elements and its index) are attributed
+// to the same tag.
+
+template<class T, class Tag, class Allocator=std::allocator<T>>
+class counting_allocator {
+    template<class U, class Tag2, class A2> friend class counting_allocator;
+
+public:
+    using value_type = T;
+    using pointer = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer = typename std::allocator_traits<Allocator>::const_pointer;
+    using size_type = typename std::allocator_traits<Allocator>::size_type;
+    using difference_type = typename std::allocator_traits<Allocator>::difference_type;
+    using stats = allocation_stats<Tag>;
+
+    using propagate_on_container_copy_assignment =
+        typename std::allocator_traits<Allocator>::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment =
+        typename std::allocator_traits<Allocator>::propagate_on_container_move_assignment;
+    using propagate_on_container_swap =
+        typename std::allocator_traits<Allocator>::propagate_on_container_swap;
+
+    template<class U>
+    struct rebind {
+        using other = counting_allocator<U, Tag,
+            typename Allocator::template rebind<U>::other>;
+    };
+
+private:
+    Allocator base_;
+
+public:
+    counting_allocator() = default;
+
+    explicit counting_allocator(const Allocator& a)
+        : base_(a) {}
+
+    template<class U, class A2>
+    counting_allocator(const counting_allocator<U, Tag, A2>& other)
+        : base_(other.base_) {}
+
+    const Allocator& base() const noexcept {
+        return base_;
+    }
+
+    pointer allocate(size_type n) {
+        pointer p = std::allocator_traits<Allocator>::allocate(base_, n);
+        stats::on_allocate(n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(pointer p, size_type n) {
+        stats::on_deallocate(n * sizeof(T));
+        std::allocator_traits<Allocator>::deallocate(base_, p, n);
+    }
+
+    size_type max_size() const noexcept {
+        return std::allocator_traits<Allocator>::max_size(base_);
+    }
+
+    template<class U, class A2>
+    bool operator==(const counting_allocator<U, Tag, A2>& other) const {
+        return base_ == other.base_;
+    }
+
+    template<class U, class A2>
+    bool operator!=(const counting_allocator<U, Tag, A2>& other) const {
+        return !(base_ == other.base_);
+    }
+};
+
 }
 
 #endif
@@ -0,0 +1,221 @@
+/**
+ * @file memscan.hpp
+ *
+ * Vectorized search of a byte value in a memory block, and the bit-mask
+ * helpers shared by the 64-byte block scanners (csv.hpp, parse_numbers.hpp).
+ *
+ * On x86, blocks are compared 32 bytes at a time with AVX2 when the
+ * CPU supports it (detected at run time), and 16 bytes at a time with
+ * SSE2 otherwise. Elsewhere, the search falls back to std::memchr.
+ */
+
+#ifndef CLUE_MEMSCAN__
+#define CLUE_MEMSCAN__
+
+#include <clue/common.hpp>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CLUE_HAS_AVX2_DISPATCH 1
+#endif
+
+namespace clue {
+
+namespace details {
+
+// the number of trailing zero bits of x (which must not be zero)
+inline unsigned ctz64(uint64_t x) noexcept {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned n = 0;
+    while (!(x & 1u)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+// a block of 64 bytes, loaded once, and compared with a byte value as a
+// whole, where bit i of the resulting mask indicates whether p[i] == c
+
+#if defined(__SSE2__)
+
+class byte_block64 {
+private:
+    __m128i v_[4];
+
+public:
+    explicit byte_block64(const char* p) noexcept {
+        for (unsigned k = 0; k < 4; ++k)
+            v_[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k * 16));
+    }
+
+    uint64_t match(char c) const noexcept {
+        const __m128i vc = _mm_set1_epi8(c);
+        uint64_t m = 0;
+        for (unsigned k = 0; k < 4; ++k) {
+            m |= static_cast<uint64_t>(static_cast<uint32_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(v_[k], vc)))) << (k * 16);
+        }
+        return m;
+    }
+};
+
+#else
+
+class byte_block64 {
+private:
+    const char* p_;
+
+public:
+    explicit byte_block64(const char* p) noexcept
+        : p_(p) {}
+
+    uint64_t match(char c) const noexcept {
+        uint64_t m = 0;
+        for (unsigned k = 0; k < 64; ++k) {
+            if (p_[k] == c) m |= uint64_t(1) << k;
+        }
+        return m;
+    }
+};
+
+#endif
+
+// Each scan function calls f(i) for the position i of each occurrence
+// of c in p[0:n), in ascending order, until f returns false. It returns
+// the position at which it stops, or n if f never returns false.
+
+template<class F>
+inline size_t scan_byte_scalar(const char* p, size_t i, size_t n, char c, F& f) {
+    for (; i < n; ++i) {
+        if (p[i] == c && !f(i)) return i;
+    }
+    return n;
+}
+
+template<class F>
+inline size_t scan_byte_memchr(const char* p, size_t n, char c, F& f) {
+    size_t i = 0;
+    while (i < n) {
+        const void* q = std::memchr(p + i, c, n - i);
+        if (!q) break;
+        i = static_cast<size_t>(static_cast<const char*>(q) - p);
+        if (!f(i)) return i;
+        ++i;
+    }
+    return n;
+}
+
+#if defined(__SSE2__)
+
+template<class F>
+inline size_t scan_byte_sse2(const char* p, size_t n, char c, F& f) {
+    const __m128i v = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        uint32_t m = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, v)));
+        while (m) {
+            size_t j = i + ctz64(m);
+            if (!f(j)) return j;
+            m &= m - 1;
+        }
+    }
+    return scan_byte_scalar(p, i, n, c, f);
+}
+
+#endif
+
+#ifdef CLUE_HAS_AVX2_DISPATCH
+
+template<class F>
+__attribute__((target("avx2")))
+inline size_t scan_byte_avx2(const char* p, size_t n, char c, F& f) {
+    const __m256i v = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        uint32_t m = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, v)));
+        while (m) {
+            size_t j = i + ctz64(m);
+            if (!f(j)) return j;
+            m &= m - 1;
+        }
+    }
+    return scan_byte_scalar(p, i, n, c, f);
+}
+
+inline bool cpu_has_avx2() noexcept {
+    static const bool r = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+    return r;
+}
+
+#endif
+
+struct find_first_ {
+    bool operator()(size_t) const noexcept { return false; }
+};
+
+} // end namespace details
+
+
+// call f(i) for the position i of each occurrence of c in p[0:n),
+// in ascending order (f returns void)
+
+template<class F>
+inline void foreach_byte(const char* p, size_t n, char c, F&& f) {
+    auto g = [&f](size_t i) { f(i); return true; };
+#if defined(CLUE_HAS_AVX2_DISPATCH)
+    if (details::cpu_has_avx2()) {
+        details::scan_byte_avx2(p, n, c, g);
+    } else {
+        details::scan_byte_sse2(p, n, c, g);
+    }
+#elif defined(__SSE2__)
+    details::scan_byte_sse2(p, n, c, g);
+#else
+    details::scan_byte_memchr(p, n, c, g);
+#endif
+}
+
+// the first occurrence of c in p[0:n), or nullptr if not found
+// (the same as std::memchr)
+
+inline const char* find_byte(const char* p, size_t n, char c) noexcept {
+    details::find_first_ f;
+    size_t i;
+#if defined(CLUE_HAS_AVX2_DISPATCH)
+    // for short ranges, the dispatch costs more than the search
+    if (n < 64) {
+        i = details::scan_byte_sse2(p, n, c, f);
+    } else if (details::cpu_has_avx2()) {
+        i = details::scan_byte_avx2(p, n, c, f);
+    } else {
+        i = details::scan_byte_sse2(p, n, c, f);
+    }
+#elif defined(__SSE2__)
+    i = details::scan_byte_sse2(p, n, c, f);
+#else
+    i = details::scan_byte_memchr(p, n, c, f);
+#endif
+    return i < n ? p + i : nullptr;
+}
+
+// the number of occurrences of c in p[0:n)
+
+inline size_t count_byte(const char* p, size_t n, char c) {
+    size_t cnt = 0;
+    foreach_byte(p, n, c, [&cnt](size_t) { ++cnt; });
+    return cnt;
+}
+
+} // end namespace clue
+
+#endif
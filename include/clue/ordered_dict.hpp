@@ -9,11 +9,213 @@
 #define CLUE_ORDERED_DICT__
 
 #include <clue/container_common.hpp>
+#include <clue/memory.hpp>
 #include <vector>
-#include <unordered_map>
+#include <cstdint>
 
 namespace clue {
 
+namespace details {
+
+// A compact open-addressing hash index (in the spirit of CPython's
+// compact dict). It maps hash values to 32-bit positions in an external
+// entry array. Each slot takes 8 bytes: the position and 32 bits of the
+// (mixed) hash value. Keys are not stored in the index; a predicate is
+// used to compare the key at a candidate position. Erased entries leave
+// tombstones (dummy slots) behind, which keep the probe sequences intact
+// and are dropped upon rehashing.
+
+struct compact_index_slot {
+    uint32_t pos;
+    uint32_t hash;
+};
+
+template<class Allocator>
+class compact_index {
+public:
+    static constexpr uint32_t npos = 0xFFFFFFFFu;    // an empty slot
+    static constexpr uint32_t dummy = 0xFFFFFFFEu;   // a tombstone
+    static constexpr size_t min_capacity = 8;
+
+private:
+    using slot_allocator = typename Allocator::template rebind<compact_index_slot>::other;
+    using slot_vector = std::vector<compact_index_slot, slot_allocator>;
+
+    slot_vector slots_;   // size is 0 or a power of 2
+    size_t nused_ = 0;    // number of occupied slots (including tombstones)
+    size_t ndummy_ = 0;   // number of tombstones
+
+public:
+    compact_index() = default;
+    compact_index(const compact_index&) = default;
+    compact_index& operator=(const compact_index&) = default;
+
+    compact_index(compact_index&& other)
+        : slots_(std::move(other.slots_))
+        , nused_(other.nused_)
+        , ndummy_(other.ndummy_) {
+        other.slots_.clear();
+        other.nused_ = 0;
+        other.ndummy_ = 0;
+    }
+
+    compact_index& operator=(compact_index&& other) {
+        if (this != &other) {
+            slots_ = std::move(other.slots_);
+            nused_ = other.nused_;
+            ndummy_ = other.ndummy_;
+            other.slots_.clear();
+            other.nused_ = 0;
+            other.ndummy_ = 0;
+        }
+        return *this;
+    }
+
+    void swap(compact_index& other) {
+        slots_.swap(other.slots_);
+        std::swap(nused_, other.nused_);
+        std::swap(ndummy_, other.ndummy_);
+    }
+
+    // mix the bits of a hash value, so that both the lower bits
+    // (used as the initial slot) and the upper bits (used in
+    // perturbation) are well distributed.
+    static uint32_t mix(size_t h) noexcept {
+        uint64_t x = static_cast<uint64_t>(h);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return static_cast<uint32_t>(x);
+    }
+
+    size_t size() const noexcept {
+        return nused_ - ndummy_;
+    }
+
+    size_t capacity() const noexcept {
+        return slots_.size();
+    }
+
+    const compact_index_slot* slots() const noexcept {
+        return slots_.data();
+    }
+
+    void clear() {
+        slots_.clear();
+        nused_ = 0;
+        ndummy_ = 0;
+    }
+
+    // ensure that n entries can be held without rehashing
+    void reserve(size_t n) {
+        if (!can_hold(n + ndummy_)) rehash(capacity_for((std::max)(n, size())));
+    }
+
+    // Get the position of the entry for which pred(pos) is true,
+    // or npos if there's no such entry.
+    template<class Pred>
+    uint32_t find(uint32_t h, Pred&& pred) const {
+        if (slots_.empty()) return npos;
+        size_t mask = slots_.size() - 1;
+        size_t i = h & mask;
+        uint32_t perturb = h;
+        for(;;) {
+            const compact_index_slot& s = slots_[i];
+            if (s.pos == npos) return npos;
+            if (s.hash == h && s.pos != dummy && pred(s.pos)) return s.pos;
+            perturb >>= 5;
+            i = (i * 5 + perturb + 1) & mask;
+        }
+    }
+
+    // Add a new entry (that is not in the index yet)
+    void insert(uint32_t h, size_t pos) {
+        if (CLUE_UNLIKELY(pos >= dummy)) {
+            throw std::length_error(
+                "compact_index: the number of entries exceeds the 32-bit limit.");
+        }
+        if (!can_hold(nused_ + 1)) {
+            rehash(capacity_for(size() + 1));
+        }
+        place(h, static_cast<uint32_t>(pos));
+        ++nused_;
+    }
+
+    // Turn the slot of an entry (which must be in the index) into a tombstone
+    void erase(uint32_t h, size_t pos) {
+        size_t mask = slots_.size() - 1;
+        size_t i = h & mask;
+        uint32_t perturb = h;
+        while (slots_[i].pos != pos) {
+            perturb >>= 5;
+            i = (i * 5 + perturb + 1) & mask;
+        }
+        slots_[i].pos = dummy;
+        ++ndummy_;
+    }
+
+    // Rebuild the index without tombstones, with each entry
+    // moved from position p to position newpos[p].
+    void relocate(const uint32_t* newpos) {
+        size_t n = size();
+        slot_vector old(capacity_for(n), compact_index_slot{npos, 0}, slots_.get_allocator());
+        old.swap(slots_);
+        for (const compact_index_slot& s: old) {
+            if (s.pos < dummy) place(s.hash, newpos[s.pos]);
+        }
+        nused_ = n;
+        ndummy_ = 0;
+    }
+
+private:
+    // the load factor is kept below 3/4
+    bool can_hold(size_t n) const noexcept {
+        return n * 4 <= slots_.size() * 3;
+    }
+
+    static size_t capacity_for(size_t n) noexcept {
+        size_t c = min_capacity;
+        while (c * 3 < n * 4) c <<= 1;
+        return c;
+    }
+
+    void place(uint32_t h, uint32_t pos) {
+        size_t mask = slots_.size() - 1;
+        size_t i = h & mask;
+        uint32_t perturb = h;
+        while (slots_[i].pos != npos) {
+            perturb >>= 5;
+            i = (i * 5 + perturb + 1) & mask;
+        }
+        slots_[i].pos = pos;
+        slots_[i].hash = h;
+    }
+
+    void rehash(size_t c) {
+        slot_vector old(c, compact_index_slot{npos, 0}, slots_.get_allocator());
+        old.swap(slots_);
+        for (const compact_index_slot& s: old) {
+            if (s.pos < dummy) place(s.hash, s.pos);
+        }
+        nused_ -= ndummy_;
+        ndummy_ = 0;
+    }
+};
+
+template<class Allocator>
+constexpr uint32_t compact_index<Allocator>::npos;
+
+template<class Allocator>
+constexpr uint32_t compact_index<Allocator>::dummy;
+
+template<class Allocator>
+constexpr size_t compact_index<Allocator>::min_capacity;
+
+} // end namespace details
+
+
 template<class Key,
          class T,
          class Hash = std::hash<Key>,
@@ -23,10 +225,9 @@ template<class Key,
 class ordered_dict {
 private:
     using vector_type = std::vector< std::pair<Key, T>, Allocator >;
-
-    using map_allocator = typename Allocator::template rebind<
-        std::pair<const Key, size_t> >::other;
-    using map_type = std::unordered_map<Key, size_t, Hash, KeyEqual, map_allocator>;
+    using index_type = details::compact_index<Allocator>;
+    using flag_allocator = typename Allocator::template rebind<uint8_t>::other;
+    using flag_vector = std::vector<uint8_t, flag_allocator>;
 
 public:
     // type names
@@ -43,12 +244,92 @@ public:
     using const_reference = const value_type&;
     using pointer = typename std::allocator_traits<Allocator>::pointer;
     using const_pointer = typename std::allocator_traits<Allocator>::const_pointer;
-    using iterator = typename vector_type::iterator;
-    using const_iterator = typename vector_type::const_iterator;
+
+private:
+    // iterators walk through the entry vector, skipping erased entries
+    template<bool Const>
+    class iter_ {
+        friend class ordered_dict;
+        friend class iter_<!Const>;
+
+    public:
+        typedef typename ordered_dict::value_type value_type;
+        typedef conditional_t<Const, const value_type&, value_type&> reference;
+        typedef conditional_t<Const, const value_type*, value_type*> pointer;
+        typedef ptrdiff_t difference_type;
+        typedef std::bidirectional_iterator_tag iterator_category;
+
+    private:
+        pointer p_;
+        pointer e_;
+        const uint8_t* d_;  // the dead flag of *p_
+
+        iter_(pointer p, pointer e, const uint8_t* d) noexcept
+            : p_(p), e_(e), d_(d) {}
+
+        void skip_() noexcept {
+            while (p_ != e_ && *d_) {
+                ++p_;
+                ++d_;
+            }
+        }
+
+    public:
+        iter_() noexcept
+            : p_(nullptr), e_(nullptr), d_(nullptr) {}
+
+        template<bool C, CLUE_REQUIRE(Const && !C)>
+        iter_(const iter_<C>& other) noexcept
+            : p_(other.p_), e_(other.e_), d_(other.d_) {}
+
+        reference operator*() const noexcept { return *p_; }
+        pointer operator->() const noexcept { return p_; }
+
+        iter_& operator++() noexcept {
+            ++p_;
+            ++d_;
+            skip_();
+            return *this;
+        }
+
+        iter_ operator++(int) noexcept {
+            iter_ tmp(*this);
+            operator++();
+            return tmp;
+        }
+
+        iter_& operator--() noexcept {
+            --p_;
+            --d_;
+            while (*d_) {
+                --p_;
+                --d_;
+            }
+            return *this;
+        }
+
+        iter_ operator--(int) noexcept {
+            iter_ tmp(*this);
+            operator--();
+            return tmp;
+        }
+
+        bool operator==(const iter_& r) const noexcept { return p_ == r.p_; }
+        bool operator!=(const iter_& r) const noexcept { return p_ != r.p_; }
+    };
+
+public:
+    using iterator = iter_<false>;
+    using const_iterator = iter_<true>;
 
 private:
     vector_type vec_;
-    map_type map_;
+    flag_vector dead_;   // one flag per entry of vec_, so that every iterator
+                         // can skip the entries erased after its creation
+    size_t ndead_ = 0;   // number of erased entries remaining in vec_
+    index_type index_;
+    Hash hash_;
+    KeyEqual keyeq_;
 
 public:
     ordered_dict() = default;
@@ -64,16 +345,32 @@ public:
 
     ordered_dict(const ordered_dict& other)
         : vec_(other.vec_)
-        , map_(other.map_) {}
+        , dead_(other.dead_)
+        , ndead_(other.ndead_)
+        , index_(other.index_)
+        , hash_(other.hash_)
+        , keyeq_(other.keyeq_) {}
 
     ordered_dict(ordered_dict&& other)
         : vec_(std::move(other.vec_))
-        , map_(std::move(other.map_)) {}
+        , dead_(std::move(other.dead_))
+        , ndead_(other.ndead_)
+        , index_(std::move(other.index_))
+        , hash_(std::move(other.hash_))
+        , keyeq_(std::move(other.keyeq_)) {
+        other.vec_.clear();
+        other.dead_.clear();
+        other.ndead_ = 0;
+    }
 
     ordered_dict& operator=(const ordered_dict& other) {
         if (this != &other) {
             vec_ = other.vec_;
-            map_ = other.map_;
+            dead_ = other.dead_;
+            ndead_ = other.ndead_;
+            index_ = other.index_;
+            hash_ = other.hash_;
+            keyeq_ = other.keyeq_;
         }
         return *this;
     }
@@ -81,7 +378,14 @@ public:
     ordered_dict& operator=(ordered_dict&& other) {
         if (this != &other) {
             vec_ = std::move(other.vec_);
-            map_ = std::move(other.map_);
+            dead_ = std::move(other.dead_);
+            ndead_ = other.ndead_;
+            index_ = std::move(other.index_);
+            hash_ = std::move(other.hash_);
+            keyeq_ = std::move(other.keyeq_);
+            other.vec_.clear();
+            other.dead_.clear();
+            other.ndead_ = 0;
         }
         return *this;
     }
@@ -91,7 +395,8 @@ public:
     }
 
     bool operator==(const ordered_dict& other) const {
-        return vec_ == other.vec_;
+        return size() == other.size() &&
+               std::equal(begin(), end(), other.begin());
     }
 
     bool operator!=(const ordered_dict& other) const {
@@ -100,40 +405,81 @@ public:
 
 public:
     bool empty() const noexcept {
-        return vec_.empty();
+        return size() == 0;
     }
 
     size_type size() const noexcept {
-        return vec_.size();
+        return vec_.size() - ndead_;
     }
 
     size_type max_size() const noexcept {
         return vec_.max_size();
     }
 
-    iterator begin() { return vec_.begin(); }
-    iterator end()   { return vec_.end(); }
+    // erased entries awaiting compaction are counted as slack
+    memory_usage_info memory_usage() const noexcept {
+        const size_t es = sizeof(value_type);
+        size_t ib = index_.capacity() * sizeof(details::compact_index_slot);
+        size_t db = dead_.capacity() * sizeof(uint8_t);
+        return memory_usage_info(
+            size() * es,
+            ib + db,
+            (vec_.capacity() - size()) * es,
+            malloc_overhead(vec_.capacity() * es) +
+            malloc_overhead(ib) + malloc_overhead(db));
+    }
 
-    const_iterator begin() const { return vec_.begin(); }
-    const_iterator end()   const { return vec_.end(); }
+    iterator begin() {
+        iterator it = _iter_at(0);
+        it.skip_();
+        return it;
+    }
 
-    const_iterator cbegin() const { return vec_.cbegin(); }
-    const_iterator cend()   const { return vec_.cend(); }
+    iterator end() {
+        return _iter_at(vec_.size());
+    }
+
+    const_iterator begin() const {
+        const_iterator it = _iter_at(0);
+        it.skip_();
+        return it;
+    }
+
+    const_iterator end() const {
+        return _iter_at(vec_.size());
+    }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend()   const { return end(); }
 
     T& at(const Key& key) {
-        return vec_[map_.at(key)].second;
+        return vec_[_at_pos(key)].second;
     }
 
     const T& at(const Key& key) const {
-        return vec_[map_.at(key)].second;
+        return vec_[_at_pos(key)].second;
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    T& at(const K& key) {
+        return vec_[_at_pos(key)].second;
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    const T& at(const K& key) const {
+        return vec_[_at_pos(key)].second;
     }
 
+    // the pos-th entry in order, in O(1) time when no
+    // entries have been erased since the last compaction.
     value_type& at_pos(size_type pos) {
-        return vec_.at(pos);
+        return vec_[_entry_pos(pos)];
     }
 
     const value_type& at_pos(size_type pos) const {
-        return vec_.at(pos);
+        return vec_[_entry_pos(pos)];
     }
 
     T& operator[](const Key& key) {
@@ -145,79 +491,125 @@ public:
     }
 
     iterator find(const Key& key) {
-        auto it = map_.find(key);
-        return it == map_.end() ?
-            vec_.end() : vec_.begin() + it->second;
+        uint32_t i = _find(_hash(key), key);
+        return i == index_type::npos ? end() : _iter_at(i);
     }
 
     const_iterator find(const Key& key) const {
-        auto it = map_.find(key);
-        return it == map_.end() ?
-            vec_.end() : vec_.begin() + it->second;
+        uint32_t i = _find(_hash(key), key);
+        return i == index_type::npos ? end() : _iter_at(i);
     }
 
     size_type count(const Key& key) const {
-        return map_.count(key);
+        return _find(_hash(key), key) == index_type::npos ? 0 : 1;
+    }
+
+    // heterogeneous lookup (when both Hash and KeyEqual are transparent)
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    iterator find(const K& key) {
+        uint32_t i = _find(_hash(key), key);
+        return i == index_type::npos ? end() : _iter_at(i);
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    const_iterator find(const K& key) const {
+        uint32_t i = _find(_hash(key), key);
+        return i == index_type::npos ? end() : _iter_at(i);
+    }
+
+    template<class K, class H=Hash, class E=KeyEqual,
+             class=typename H::is_transparent, class=typename E::is_transparent>
+    size_type count(const K& key) const {
+        return _find(_hash(key), key) == index_type::npos ? 0 : 1;
     }
 
 public:
     void clear() {
-        map_.clear();
+        index_.clear();
         vec_.clear();
+        dead_.clear();
+        ndead_ = 0;
     }
 
     void reserve(size_t c) {
-        map_.reserve(c);
-        vec_.reserve(c);
+        index_.reserve(c);
+        vec_.reserve(c + ndead_);
+        dead_.reserve(c + ndead_);
     }
 
     void swap(ordered_dict& other) {
+        using std::swap;
         vec_.swap(other.vec_);
-        map_.swap(other.map_);
+        dead_.swap(other.dead_);
+        swap(ndead_, other.ndead_);
+        index_.swap(other.index_);
+        swap(hash_, other.hash_);
+        swap(keyeq_, other.keyeq_);
     }
 
     template<class... Args>
     std::pair<iterator, bool> emplace(Args&&... args) {
         value_type v(std::forward<Args>(args)...);
-        auto it = map_.find(v.first);
-        if (it == map_.end()) {
+        uint32_t h = _hash(v.first);
+        uint32_t i = _find(h, v.first);
+        if (i == index_type::npos) {
             vec_.emplace_back(std::move(v));
-            return _post_insert();
+            return _post_insert(h);
         } else {
-            return std::make_pair(vec_.begin() + it->second, false);
+            return std::make_pair(_iter_at(i), false);
         }
     }
 
     template<class... Args>
     std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) {
-        auto it = map_.find(k);
-        if (it == map_.end()) {
+        uint32_t h = _hash(k);
+        uint32_t i = _find(h, k);
+        if (i == index_type::npos) {
             vec_.emplace_back(std::piecewise_construct,
                               std::forward_as_tuple(k),
                               std::forward_as_tuple(std::forward<Args>(args)...));
-            return _post_insert();
+            return _post_insert(h);
         } else {
-            return std::make_pair(vec_.begin() + it->second, false);
+            return std::make_pair(_iter_at(i), false);
+        }
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args) {
+        uint32_t h = _hash(k);
+        uint32_t i = _find(h, k);
+        if (i == index_type::npos) {
+            vec_.emplace_back(std::piecewise_construct,
+                              std::forward_as_tuple(std::move(k)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+            return _post_insert(h);
+        } else {
+            return std::make_pair(_iter_at(i), false);
         }
     }
 
     std::pair<iterator, bool> insert(const value_type& v) {
-        auto it = map_.find(v.first);
-        if (it == map_.end()) {
+        uint32_t h = _hash(v.first);
+        uint32_t i = _find(h, v.first);
+        if (i == index_type::npos) {
             vec_.emplace_back(v);
-            return _post_insert();
+            return _post_insert(h);
         } else {
-            return std::make_pair(vec_.begin() + it->second, false);
+            return std::make_pair(_iter_at(i), false);
         }
     }
 
     std::pair<iterator, bool> insert(value_type&& v) {
-        auto it = map_.find(v.first);
-        if (it == map_.end()) {
+        uint32_t h = _hash(v.first);
+        uint32_t i = _find(h, v.first);
+        if (i == index_type::npos) {
             vec_.emplace_back(std::move(v));
-            return _post_insert();
+            return _post_insert(h);
         } else {
-            return std::make_pair(vec_.begin() + it->second, false);
+            return std::make_pair(_iter_at(i), false);
         }
     }
 
@@ -228,9 +620,32 @@ public:
 
     template<class InputIter>
     void insert(InputIter first, InputIter last) {
+        using tag_t = typename std::iterator_traits<InputIter>::iterator_category;
+        _reserve_for_range(first, last, tag_t{});
         for(; first != last; ++first) insert(*first);
     }
 
+    // Insert a range of key-value pairs, with the keys hashed in parallel
+    // on a thread pool (declared in <clue/thread_pool.hpp>). The storage is
+    // reserved upfront, then the entries are added in order (as by insert).
+    template<class RandomIter>
+    void insert(RandomIter first, RandomIter last, thread_pool& pool) {
+        size_t n = static_cast<size_t>(last - first);
+        using hash_allocator = typename Allocator::template rebind<uint32_t>::other;
+        std::vector<uint32_t, hash_allocator> hs(n);
+        details::parallel_chunks(pool, n, 4096, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) hs[i] = _hash(first[i].first);
+        });
+        reserve(size() + n);
+        for (size_t i = 0; i < n; ++i) {
+            const value_type& v = first[i];
+            if (_find(hs[i], v.first) == index_type::npos) {
+                vec_.emplace_back(v);
+                _post_insert(hs[i]);
+            }
+        }
+    }
+
     void insert(std::initializer_list<value_type> ilist) {
         for (const value_type& v: ilist) insert(v);
     }
@@ -248,11 +663,128 @@ public:
         for (const value_type& v: ilist) update(v);
     }
 
+    // Erasure leaves a tombstone in the index and marks the entry dead
+    // in O(1) time. The dead entries are squeezed out (by compact) once
+    // they make up half of the entry vector. Compaction invalidates all
+    // iterators, except the one returned by erase(pos).
+
+    size_type erase(const Key& key) {
+        uint32_t h = _hash(key);
+        uint32_t i = _find(h, key);
+        if (i == index_type::npos) return 0;
+        _erase_at(h, i);
+        if (_needs_compaction()) _compact(0);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos) {
+        size_t i = static_cast<size_t>(pos.p_ - vec_.data());
+        _erase_at(_hash(vec_[i].first), i);
+        size_t j = i + 1;
+        while (j < vec_.size() && dead_[j]) ++j;
+        if (_needs_compaction()) j = _compact(j);
+        return _iter_at(j);
+    }
+
+    // Remove all dead entries from the entry vector and
+    // all tombstones from the index.
+    void compact() {
+        if (ndead_ > 0) _compact(0);
+    }
+
 private:
-    std::pair<iterator, bool> _post_insert() {
-        value_type& r = vec_.back();
-        map_.emplace(r.first, vec_.size() - 1);
-        return std::make_pair(--vec_.end(), true);
+    iterator _iter_at(size_t i) noexcept {
+        value_type* b = vec_.data();
+        return iterator(b + i, b + vec_.size(), dead_.data() + i);
+    }
+
+    const_iterator _iter_at(size_t i) const noexcept {
+        const value_type* b = vec_.data();
+        return const_iterator(b + i, b + vec_.size(), dead_.data() + i);
+    }
+
+    template<class InputIter, typename tag_t>
+    void _reserve_for_range(InputIter, InputIter, tag_t) {}
+
+    template<class InputIter>
+    void _reserve_for_range(InputIter first, InputIter last,
+                            std::random_access_iterator_tag) {
+        reserve(size() + static_cast<size_t>(last - first));
+    }
+
+    template<class K>
+    uint32_t _hash(const K& key) const {
+        return index_type::mix(hash_(key));
+    }
+
+    template<class K>
+    uint32_t _find(uint32_t h, const K& key) const {
+        return index_.find(h, [this, &key](uint32_t i) {
+            return keyeq_(vec_[i].first, key);
+        });
+    }
+
+    template<class K>
+    size_t _at_pos(const K& key) const {
+        uint32_t i = _find(_hash(key), key);
+        if (i == index_type::npos)
+            throw std::out_of_range("ordered_dict::at: the key is not found.");
+        return i;
+    }
+
+    size_t _entry_pos(size_t pos) const {
+        if (ndead_ == 0) {
+            if (pos < vec_.size()) return pos;
+        } else {
+            for (size_t i = 0; i < vec_.size(); ++i) {
+                if (!dead_[i] && pos-- == 0) return i;
+            }
+        }
+        throw std::out_of_range("ordered_dict::at_pos: the position is out of range.");
+    }
+
+    std::pair<iterator, bool> _post_insert(uint32_t h) {
+        try {
+            dead_.push_back(0);
+            index_.insert(h, vec_.size() - 1);
+        } catch (...) {
+            if (dead_.size() == vec_.size()) dead_.pop_back();
+            vec_.pop_back();
+            throw;
+        }
+        return std::make_pair(_iter_at(vec_.size() - 1), true);
+    }
+
+    void _erase_at(uint32_t h, size_t i) {
+        index_.erase(h, i);
+        dead_[i] = 1;
+        ++ndead_;
+    }
+
+    bool _needs_compaction() const noexcept {
+        return ndead_ >= 8 && ndead_ * 2 >= vec_.size();
+    }
+
+    // compact, and return the new position of the entry at position j
+    size_t _compact(size_t j) {
+        using pos_allocator = typename Allocator::template rebind<uint32_t>::other;
+        std::vector<uint32_t, pos_allocator> newpos(vec_.size());
+        size_t n = vec_.size();
+        size_t k = 0;
+        size_t rj = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (i == j) rj = k;
+            if (!dead_[i]) {
+                if (k != i) vec_[k] = std::move(vec_[i]);
+                newpos[i] = static_cast<uint32_t>(k++);
+            }
+        }
+        if (j >= n) rj = k;
+        vec_.erase(vec_.begin() + k, vec_.end());
+        index_.relocate(newpos.data());
+        dead_.assign(k, 0);
+        ndead_ = 0;
+        return rj;
     }
 
 }; // end class ordered_dict
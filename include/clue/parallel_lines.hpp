@@ -0,0 +1,111 @@
+/**
+ * @file parallel_lines.hpp
+ *
+ * Parallel processing of the lines of a text (e.g. a mapped file) on a
+ * thread pool. The text is cut into chunks of roughly equal sizes at line
+ * boundaries, and each chunk is processed by a task, with a reduction
+ * state of its own. The states are merged in the order of the chunks
+ * at the end, so the result does not depend on the scheduling.
+ */
+
+#ifndef CLUE_PARALLEL_LINES__
+#define CLUE_PARALLEL_LINES__
+
+#include <clue/textio.hpp>
+#include <clue/memscan.hpp>
+#include <clue/thread_pool.hpp>
+#include <clue/container_common.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace clue {
+
+// cut a text into at most n chunks of roughly equal sizes, each of which
+// ends right after a '\n' (except possibly the last one), so no line is
+// split across chunks
+
+inline std::vector<string_view> line_chunks(string_view text, size_t n) {
+    std::vector<string_view> chunks;
+    const size_t len = text.size();
+    if (n == 0) n = 1;
+    chunks.reserve(n);
+    size_t b = 0;
+    for (size_t k = 1; k <= n && b < len; ++k) {
+        size_t e = k == n ? len : std::max(b, len / n * k + len % n * k / n);
+        if (e < len && (e == 0 || text[e - 1] != '\n')) {
+            const char* p = find_byte(text.data() + e, len - e, '\n');
+            e = p ? static_cast<size_t>(p - text.data()) + 1 : len;
+        }
+        if (e > b) {
+            chunks.push_back(text.substr(b, e - b));
+            b = e;
+        }
+    }
+    return chunks;
+}
+
+namespace details {
+
+// chunks smaller than this are not worth a task of their own
+constexpr size_t parallel_lines_min_chunk = 64 * 1024;
+
+inline size_t parallel_lines_nchunks(const thread_pool& pool, size_t len) {
+    // a few chunks per thread, for balancing the load
+    size_t n = std::max(pool.size(), size_t(1)) * 4;
+    return std::max(size_t(1), std::min(n, len / parallel_lines_min_chunk));
+}
+
+// a reduction state, kept in a struct so that the states of the chunks
+// are separate objects (e.g. not the packed bits of a std::vector<bool>),
+// which are updated concurrently
+template<class State>
+struct parallel_state {
+    State value;
+};
+
+} // end namespace details
+
+
+// call f(state, line) for each line of text on the pool, where state is a
+// copy of init for each chunk; then merge(result, std::move(state)) is
+// called for each chunk in order, with result starting from init, and
+// the result is returned. (So init should be an identity of merge, e.g.
+// zero for a sum.)
+//
+// The pool must not be closed, and this must not be called from a task
+// running on the same pool. A mapped_file can be passed as text.
+
+template<class State, class F, class Merge>
+State parallel_lines(thread_pool& pool, string_view text,
+                     const State& init, F&& f, Merge&& merge) {
+    std::vector<string_view> chunks = line_chunks(
+        text, details::parallel_lines_nchunks(pool, text.size()));
+    std::vector<details::parallel_state<State>> states(
+        chunks.size(), details::parallel_state<State>{init});
+
+    details::parallel_run(pool, chunks.size(), [&](size_t i) {
+        State& s = states[i].value;
+        for (string_view line: line_stream(chunks[i])) f(s, line);
+    });
+
+    State r(init);
+    for (details::parallel_state<State>& s: states) merge(r, std::move(s.value));
+    return r;
+}
+
+// call f(line) for each line of text on the pool
+// (f is called concurrently, so it must be thread-safe)
+
+template<class F>
+void parallel_lines(thread_pool& pool, string_view text, F&& f) {
+    std::vector<string_view> chunks = line_chunks(
+        text, details::parallel_lines_nchunks(pool, text.size()));
+
+    details::parallel_run(pool, chunks.size(), [&](size_t i) {
+        for (string_view line: line_stream(chunks[i])) f(line);
+    });
+}
+
+} // end namespace clue
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @file parse_numbers.hpp
+ *
+ * Bulk parsing of delimited numbers (e.g. a numeric column, or a matrix
+ * in text form) into a vector.
+ *
+ * The text is scanned 64 bytes at a time: the positions of delimiters in
+ * a block are found as a bit mask (with SSE2 where available, as in
+ * csv.hpp), so the tokens are found without examining the bytes one by
+ * one, and each token is converted with from_chars, which takes eight
+ * digits at a time. A large text can be cut at delimiters into chunks,
+ * which are parsed on a thread pool.
+ */
+
+#ifndef CLUE_PARSE_NUMBERS__
+#define CLUE_PARSE_NUMBERS__
+
+#include <clue/string_view.hpp>
+#include <clue/charconv.hpp>
+#include <clue/fast_vector.hpp>
+#include <clue/memscan.hpp>
+#include <clue/parallel_lines.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace clue {
+
+// the result of parse_numbers: the number of values parsed (and appended),
+// and the offset at which parsing stops, which is the size of the text
+// upon success, or the beginning of the first token that is not a valid
+// number (then ec is std::errc::invalid_argument, or result_out_of_range
+// if the value is out of the range of the type)
+
+struct parse_numbers_result {
+    size_t count;
+    size_t pos;
+    std::errc ec;
+
+    bool ok() const noexcept {
+        return ec == std::errc();
+    }
+};
+
+
+namespace details {
+
+// a set of delimiters, matched with SIMD comparisons when it has at most
+// eight distinct characters, and with a byte_set otherwise
+
+class number_delims {
+private:
+    byte_set tab_;
+    char chars_[8];
+    unsigned n_;    // the number of distinct characters, or 0 if more than 8
+
+public:
+    explicit number_delims(string_view ds)
+        : tab_(ds.data(), ds.size()), n_(0) {
+        if (ds.empty()) throw
+            std::invalid_argument("parse_numbers: the delimiters must not be empty.");
+        for (char c: ds) {
+            if (std::find(chars_, chars_ + n_, c) != chars_ + n_) continue;
+            if (n_ == 8) {
+                n_ = 0;
+                break;
+            }
+            chars_[n_++] = c;
+        }
+    }
+
+    bool contains(char c) const noexcept {
+        return tab_.contains(static_cast<unsigned char>(c));
+    }
+
+    // the bit mask of the delimiters in a 64-byte block
+    uint64_t block_mask(const char* p) const noexcept {
+#if defined(__SSE2__)
+        if (n_ > 0) {
+            const byte_block64 b(p);
+            uint64_t m = b.match(chars_[0]);
+            for (unsigned k = 1; k < n_; ++k) m |= b.match(chars_[k]);
+            return m;
+        }
+#endif
+        uint64_t m = 0;
+        for (unsigned i = 0; i < 64; ++i) {
+            if (contains(p[i])) m |= uint64_t(1) << i;
+        }
+        return m;
+    }
+};
+
+// parse a whole token, which may begin with '+'
+template<typename T>
+inline std::errc parse_number_token(const char* b, const char* e, T& x) noexcept {
+    if (b != e && *b == '+') {
+        ++b;
+        if (b == e || *b == '-') return std::errc::invalid_argument;
+    }
+    from_chars_result r = from_chars(b, e, x);
+    if (r.ec == std::errc() && r.ptr != e) return std::errc::invalid_argument;
+    return r.ec;
+}
+
+// the values are appended to out, which is reserved for the number of
+// values extrapolated from those in the first part of the text
+constexpr size_t parse_numbers_sample = 64 * 1024;
+
+template<typename T, class Vec>
+inline parse_numbers_result parse_numbers_(string_view text, const number_delims& ds, Vec& out) {
+    const char* s = text.data();
+    const size_t len = text.size();
+    size_t n = 0;
+    size_t start = 0;
+    bool in_token = false;
+    uint64_t carry = 1;     // whether the last byte of the previous block is a delimiter
+    size_t next_reserve = std::min(len, parse_numbers_sample);
+
+    // each token begins and ends at the transitions between delimiters and
+    // non-delimiters, which are found in the mask of each block at once
+    for (size_t b = 0; b < len; b += 64) {
+        uint64_t d;
+        if (len - b >= 64) {
+            d = ds.block_mask(s + b);
+        } else {
+            // the last partial block, where the bytes beyond the end are
+            // taken as delimiters
+            char tmp[64];
+            std::memset(tmp, 0, 64);
+            std::memcpy(tmp, s + b, len - b);
+            d = ds.block_mask(tmp) | (~uint64_t(0) << (len - b));
+        }
+        uint64_t t = d ^ ((d << 1) | carry);
+        carry = d >> 63;
+        while (t) {
+            const size_t pos = b + ctz64(t);
+            t &= t - 1;
+            if (!in_token) {
+                start = pos;
+                in_token = true;
+                continue;
+            }
+            in_token = false;
+            T x = T();
+            std::errc ec = parse_number_token(s + start, s + pos, x);
+            if (ec != std::errc()) return parse_numbers_result{n, start, ec};
+            out.push_back(x);
+            ++n;
+        }
+        if (b + 64 >= next_reserve && next_reserve < len) {
+            out.reserve(out.size() + n * (len - b - 64) / (b + 64) + 16);
+            next_reserve = len;
+        }
+    }
+    if (in_token) {
+        // the last token, which ends with the text
+        T x = T();
+        std::errc ec = parse_number_token(s + start, s + len, x);
+        if (ec != std::errc()) return parse_numbers_result{n, start, ec};
+        out.push_back(x);
+        ++n;
+    }
+    return parse_numbers_result{n, len, std::errc()};
+}
+
+// cut a text into at most n chunks of roughly equal sizes, each of which
+// ends right after a delimiter (except possibly the last one)
+inline std::vector<string_view> number_chunks(string_view text, const number_delims& ds, size_t n) {
+    std::vector<string_view> chunks;
+    const size_t len = text.size();
+    if (n == 0) n = 1;
+    chunks.reserve(n);
+    size_t b = 0;
+    for (size_t k = 1; k <= n && b < len; ++k) {
+        size_t e = k == n ? len : std::max(b, len / n * k + len % n * k / n);
+        while (e < len && (e == 0 || !ds.contains(text[e - 1]))) ++e;
+        if (e > b) {
+            chunks.push_back(text.substr(b, e - b));
+            b = e;
+        }
+    }
+    return chunks;
+}
+
+} // end namespace details
+
+
+// Parse the numbers in text, separated by one or more of the delimiters
+// (e.g. ",\n", or " \t\r\n"), and append them to out. Each token must be
+// a number in its entirety, in the decimal notation, as from_chars takes
+// it, with an optional '+'. It stops at the first token that is not, with
+// the values before it appended.
+//
+//   fast_vector<double> xs;
+//   parse_numbers_result r = parse_numbers(text, ",\n", xs);
+//   if (!r.ok()) ... // r.pos is the offset of the bad token
+//
+template<typename T, size_t SCap, bool Reloc, class Allocator>
+inline parse_numbers_result parse_numbers(string_view text, string_view delims,
+                                          fast_vector<T, SCap, Reloc, Allocator>& out) {
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+        "parse_numbers: T must be an integral or floating-point type.");
+    details::number_delims ds(delims);
+    return details::parse_numbers_<T>(text, ds, out);
+}
+
+// the same as parse_numbers(text, delims, out), with the text cut into
+// chunks (at delimiters), which are parsed in parallel on a thread pool;
+// the result is the same as that of the sequential version
+template<typename T, size_t SCap, bool Reloc, class Allocator>
+inline parse_numbers_result parse_numbers(thread_pool& pool,
+                                          string_view text, string_view delims,
+                                          fast_vector<T, SCap, Reloc, Allocator>& out) {
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+        "parse_numbers: T must be an integral or floating-point type.");
+    details::number_delims ds(delims);
+    std::vector<string_view> chunks = details::number_chunks(
+        text, ds, details::parallel_lines_nchunks(pool, text.size()));
+    const size_t m = chunks.size();
+    if (m <= 1) return details::parse_numbers_<T>(text, ds, out);
+
+    std::vector<fast_vector<T>> vals(m);
+    std::vector<parse_numbers_result> rs(m);
+    details::parallel_run(pool, m, [&](size_t i) {
+        rs[i] = details::parse_numbers_<T>(chunks[i], ds, vals[i]);
+    });
+
+    // merge in order, up to the first error
+    size_t total = 0;
+    for (size_t i = 0; i < m; ++i) {
+        total += vals[i].size();
+        if (!rs[i].ok()) break;
+    }
+    out.reserve(out.size() + total);
+    parse_numbers_result r{0, text.size(), std::errc()};
+    for (size_t i = 0; i < m; ++i) {
+        out.insert(out.end(), vals[i].begin(), vals[i].end());
+        r.count += rs[i].count;
+        if (!rs[i].ok()) {
+            r.pos = static_cast<size_t>(chunks[i].data() - text.data()) + rs[i].pos;
+            r.ec = rs[i].ec;
+            break;
+        }
+    }
+    return r;
+}
+
+} // end namespace clue
+
+#endif
@@ -2,8 +2,10 @@
 #define CLUE_SFORMAT__
 
 #include <clue/misc.hpp>
+#include <clue/charconv.hpp>
 #include <string>
 #include <ostream>
+#include <locale>
 #include <cstdio>
 
 namespace clue {
@@ -12,14 +14,57 @@ namespace clue {
 
 namespace details {
 
+// the integral types that streams write as numbers (not bool or characters)
+template<typename T>
+struct is_stream_number : public std::integral_constant<bool,
+    std::is_integral<T>::value &&
+    !std::is_same<T, bool>::value &&
+    !std::is_same<T, char>::value &&
+    !std::is_same<T, signed char>::value &&
+    !std::is_same<T, unsigned char>::value &&
+    !std::is_same<T, wchar_t>::value &&
+    !std::is_same<T, char16_t>::value &&
+    !std::is_same<T, char32_t>::value> {};
+
+// insert x to a stream, where integers in the default format are
+// converted with to_chars, when the locale of the stream does not group
+// the digits (as the classic "C" locale)
+
+inline bool ungrouped_locale(const std::ostream& os) {
+    const std::locale loc = os.getloc();
+    return loc == std::locale::classic() ||
+        std::use_facet<std::numpunct<char>>(loc).grouping().empty();
+}
+
 template<class A>
-inline void insert_to_stream(std::ostream& os, A&& x) {
+inline enable_if_t<!is_stream_number<decay_t<A>>::value>
+put_value(std::ostream& os, A&& x) {
     os << x;
 }
 
+template<class A>
+inline enable_if_t<is_stream_number<decay_t<A>>::value>
+put_value(std::ostream& os, A&& x) {
+    const std::ios_base::fmtflags f = os.flags() &
+        (std::ios_base::basefield | std::ios_base::showpos |
+         std::ios_base::showbase | std::ios_base::uppercase);
+    if (f == std::ios_base::dec && os.width() == 0 && ungrouped_locale(os)) {
+        char buf[24];
+        const to_chars_result r = to_chars(buf, buf + 24, x);
+        os.write(buf, r.ptr - buf);
+    } else {
+        os << x;
+    }
+}
+
+template<class A>
+inline void insert_to_stream(std::ostream& os, A&& x) {
+    put_value(os, std::forward<A>(x));
+}
+
 template<class A, class... Rest>
 inline void insert_to_stream(std::ostream& os, A&& x, Rest&&... rest) {
-    os << x;
+    put_value(os, std::forward<A>(x));
     insert_to_stream(os, std::forward<Rest>(rest)...);
 }
 
@@ -58,14 +103,41 @@ inline std::ostream& operator << (std::ostream& out, const Delimits<Seq>& a) {
     auto it = a.seq.begin();
     auto it_end = a.seq.end();
     if (it != it_end) {
-        out << *it;
+        details::put_value(out, *it);
         ++it;
-        for(;it != it_end; ++it)
-            out << a.delimiter << *it;
+        for(;it != it_end; ++it) {
+            out << a.delimiter;
+            details::put_value(out, *it);
+        }
     }
     return out;
 }
 
+// Shortest round-trip formatting
+
+template<typename T>
+struct shortest_t {
+    T value;
+};
+
+// wrap a floating point number, to be written with the fewest digits that
+// read back as the same value (e.g. 0.1 as "0.1", rather than "0.1" or
+// "0.10000000000000001" depending on the precision of the stream)
+template<typename T>
+inline enable_if_t<std::is_floating_point<T>::value && !std::is_same<T, long double>::value,
+                   shortest_t<T>>
+shortest(T x) noexcept {
+    return shortest_t<T>{x};
+}
+
+template<typename T>
+inline std::ostream& operator << (std::ostream& out, const shortest_t<T>& a) {
+    char buf[32];
+    const to_chars_result r = to_chars(buf, buf + 32, a.value);
+    out.write(buf, r.ptr - buf);
+    return out;
+}
+
 // C formatting
 
 template<typename T>
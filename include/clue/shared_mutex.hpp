@@ -19,6 +19,9 @@
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <thread>
 
 namespace clue {
 
@@ -385,6 +388,79 @@ public:
 
 }; // end class shared_lock
 
+namespace details {
+
+// A light-weight reader-writer spin lock, for critical sections that
+// take no longer than a hash table probe. The state holds the number
+// of readers, with the highest bit marking a (pending) writer. A writer
+// first claims the bit, which keeps new readers out, and then waits for
+// the current readers to drain.
+//
+// It meets the requirements of both Lockable and SharedLockable, and
+// thus works with std::unique_lock and clue::shared_lock.
+
+class rw_spinlock {
+private:
+    static constexpr uint32_t writer_() noexcept { return 1u << 31; }
+    std::atomic<uint32_t> state_;
+
+public:
+    rw_spinlock() noexcept : state_(0) {}
+
+    rw_spinlock(const rw_spinlock&) = delete;
+    rw_spinlock& operator=(const rw_spinlock&) = delete;
+
+    bool try_lock_shared() noexcept {
+        uint32_t s = state_.load(std::memory_order_relaxed);
+        return !(s & writer_()) &&
+            state_.compare_exchange_strong(s, s + 1,
+                std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void lock_shared() noexcept {
+        for (unsigned k = 0; !try_lock_shared(); ++k) backoff_(k);
+    }
+
+    void unlock_shared() noexcept {
+        state_.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool try_lock() noexcept {
+        uint32_t s = 0;
+        return state_.compare_exchange_strong(s, writer_(),
+            std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void lock() noexcept {
+        unsigned k = 0;
+        for (;;) {
+            uint32_t s = state_.load(std::memory_order_relaxed);
+            if (!(s & writer_()) &&
+                state_.compare_exchange_weak(s, s | writer_(),
+                    std::memory_order_acquire, std::memory_order_relaxed)) break;
+            backoff_(k++);
+        }
+        while (state_.load(std::memory_order_acquire) != writer_()) backoff_(k++);
+    }
+
+    void unlock() noexcept {
+        state_.store(0, std::memory_order_release);
+    }
+
+private:
+    static void backoff_(unsigned k) noexcept {
+        if (k < 16) {
+#if defined(__SSE2__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+};
+
+} // end namespace details
+
 } // end namespace clue
 
 #endif
@@ -0,0 +1,393 @@
+/**
+ * @file snapshot.hpp
+ *
+ * A binary snapshot format for string-keyed tables with trivially
+ * copyable values (e.g. ordered_dict<std::string, POD>), which can be
+ * used in place (e.g. memory-mapped) without parsing or re-inserting
+ * the entries.
+ *
+ * Layout (native byte order, sections aligned to 16 bytes):
+ *
+ *  - header:   snapshot_header
+ *  - entries:  snapshot_entry[count], the key offset, length and hash
+ *  - values:   T[count]
+ *  - index:    uint32_t[index_cap], open addressing with linear probing,
+ *              each slot holding (position + 1), or 0 if empty
+ *  - strings:  the key characters, concatenated
+ *
+ * The hash function (FNV-1a, followed by the MurmurHash3 finalizer) is
+ * part of the format, so that a snapshot is independent of the hasher
+ * of the container it is saved from.
+ */
+
+#ifndef CLUE_SNAPSHOT__
+#define CLUE_SNAPSHOT__
+
+#include <clue/container_common.hpp>
+#include <clue/string_view.hpp>
+#include <clue/array_view.hpp>
+#include <clue/ordered_dict.hpp>
+#include <clue/keyed_vector.hpp>
+#include <clue/textio.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace clue {
+
+namespace details {
+
+struct snapshot_header {
+    char magic[8];          // "CLUESNAP"
+    uint32_t version;
+    uint32_t byte_order;    // 0x01020304 as written on the saving machine
+    uint32_t value_size;
+    uint32_t value_align;
+    uint64_t count;
+    uint64_t index_cap;
+    uint64_t entries_off;
+    uint64_t values_off;
+    uint64_t index_off;
+    uint64_t strings_off;
+    uint64_t strings_size;
+    uint64_t total_size;
+};
+
+struct snapshot_entry {
+    uint64_t key_off;       // relative to the string section
+    uint32_t key_len;
+    uint32_t hash;          // the higher 32 bits of the key's hash
+};
+
+constexpr uint32_t snapshot_version = 1;
+constexpr uint32_t snapshot_byte_order = 0x01020304u;
+
+inline uint64_t snapshot_hash(const char* s, size_t n) noexcept {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t snapshot_align(uint64_t off) noexcept {
+    return (off + 15) & ~uint64_t(15);
+}
+
+// the number of index slots (load factor at most 1/2)
+inline uint64_t snapshot_index_cap(uint64_t n) noexcept {
+    uint64_t c = 8;
+    while (c < n * 2) c <<= 1;
+    return c;
+}
+
+template<class T>
+void save_snapshot_items(std::ostream& out,
+                         const std::vector<std::pair<string_view, const T*>>& items) {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "save_snapshot: the value type must be trivially copyable.");
+    static_assert(alignof(T) <= 16,
+        "save_snapshot: the value type must be aligned to at most 16 bytes.");
+
+    const size_t n = items.size();
+    if (n >= UINT32_MAX) throw std::invalid_argument(
+        "save_snapshot: too many entries.");
+
+    // entries and index
+    std::vector<snapshot_entry> entries(n);
+    const uint64_t cap = snapshot_index_cap(n);
+    std::vector<uint32_t> index(cap, 0);
+    uint64_t soff = 0;
+    for (size_t i = 0; i < n; ++i) {
+        string_view k = items[i].first;
+        if (k.size() > UINT32_MAX) throw std::invalid_argument(
+            "save_snapshot: the key is too long.");
+        uint64_t h = snapshot_hash(k.data(), k.size());
+        snapshot_entry& e = entries[i];
+        e.key_off = soff;
+        e.key_len = static_cast<uint32_t>(k.size());
+        e.hash = static_cast<uint32_t>(h >> 32);
+        soff += k.size();
+
+        uint64_t j = h & (cap - 1);
+        while (index[j] != 0) j = (j + 1) & (cap - 1);
+        index[j] = static_cast<uint32_t>(i + 1);
+    }
+
+    // layout
+    snapshot_header hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, "CLUESNAP", 8);
+    hdr.version = snapshot_version;
+    hdr.byte_order = snapshot_byte_order;
+    hdr.value_size = static_cast<uint32_t>(sizeof(T));
+    hdr.value_align = static_cast<uint32_t>(alignof(T));
+    hdr.count = n;
+    hdr.index_cap = cap;
+    hdr.entries_off = snapshot_align(sizeof(snapshot_header));
+    hdr.values_off = snapshot_align(hdr.entries_off + n * sizeof(snapshot_entry));
+    hdr.index_off = snapshot_align(hdr.values_off + n * sizeof(T));
+    hdr.strings_off = snapshot_align(hdr.index_off + cap * sizeof(uint32_t));
+    hdr.strings_size = soff;
+    hdr.total_size = hdr.strings_off + soff;
+
+    // write, in a single sequential pass
+    uint64_t pos = 0;
+    auto write = [&](const void* p, size_t len) {
+        out.write(static_cast<const char*>(p), static_cast<std::streamsize>(len));
+        pos += len;
+    };
+    auto pad_to = [&](uint64_t off) {
+        static const char zeros[16] = {0};
+        write(zeros, static_cast<size_t>(off - pos));
+    };
+
+    write(&hdr, sizeof(hdr));
+    pad_to(hdr.entries_off);
+    write(entries.data(), n * sizeof(snapshot_entry));
+    pad_to(hdr.values_off);
+    for (size_t i = 0; i < n; ++i) write(items[i].second, sizeof(T));
+    pad_to(hdr.index_off);
+    write(index.data(), cap * sizeof(uint32_t));
+    pad_to(hdr.strings_off);
+    for (size_t i = 0; i < n; ++i) write(items[i].first.data(), items[i].first.size());
+
+    if (!out) throw std::runtime_error("save_snapshot: failed to write.");
+}
+
+} // end namespace details
+
+
+// save a table to a snapshot
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+void save_snapshot(std::ostream& out, const ordered_dict<Key, T, Hash, KeyEqual, Allocator>& d) {
+    std::vector<std::pair<string_view, const T*>> items;
+    items.reserve(d.size());
+    for (const auto& e: d) {
+        items.emplace_back(string_view(e.first.data(), e.first.size()), &e.second);
+    }
+    details::save_snapshot_items(out, items);
+}
+
+template<class T, class Key, class Hash, class Allocator, template<class...> class IndexMap>
+void save_snapshot(std::ostream& out, const keyed_vector<T, Key, Hash, Allocator, IndexMap>& v) {
+    std::vector<std::pair<string_view, const T*>> items(v.size());
+    v.foreach_key([&](const Key& k, size_t i) {
+        items[i] = std::make_pair(string_view(k.data(), k.size()), &v[i]);
+    });
+    details::save_snapshot_items(out, items);
+}
+
+template<class Container>
+void save_snapshot(const std::string& filename, const Container& c) {
+    std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) throw
+        std::runtime_error(std::string("Failed to open file ") + filename);
+    save_snapshot(out, c);
+    out.close();
+    if (!out) throw
+        std::runtime_error(std::string("Failed to write file ") + filename);
+}
+
+
+// A read-only view of a snapshot in memory, which does not own the memory.
+//
+// Opening a view takes O(1) time: the header is validated, and all
+// accesses go directly to the underlying memory. The lookups check each
+// index slot and entry they read against the bounds of the sections, so
+// a corrupted file makes a key not found rather than read out of bounds;
+// key(i) and value(i) trust the entries.
+
+template<class T>
+class snapshot_view {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "snapshot_view: the value type must be trivially copyable.");
+
+public:
+    using key_type = string_view;
+    using mapped_type = T;
+    using size_type = std::size_t;
+
+private:
+    const details::snapshot_entry* entries_;
+    const T* values_;
+    const uint32_t* index_;
+    const char* strings_;
+    size_t strings_size_;
+    size_t count_;
+    size_t mask_;
+
+public:
+    snapshot_view() noexcept
+        : entries_(nullptr), values_(nullptr), index_(nullptr)
+        , strings_(nullptr), strings_size_(0), count_(0), mask_(0) {}
+
+    snapshot_view(const void* data, size_t size) {
+        using details::snapshot_header;
+        const char* base = static_cast<const char*>(data);
+        const size_t a = alignof(T) > 8 ? alignof(T) : 8;
+
+        if (reinterpret_cast<uintptr_t>(base) % a != 0)
+            invalid_("the data is not properly aligned.");
+        if (size < sizeof(snapshot_header))
+            invalid_("the data is too short.");
+
+        snapshot_header hdr;
+        std::memcpy(&hdr, base, sizeof(hdr));
+        if (std::memcmp(hdr.magic, "CLUESNAP", 8) != 0)
+            invalid_("bad magic number.");
+        if (hdr.version != details::snapshot_version)
+            invalid_("unsupported version.");
+        if (hdr.byte_order != details::snapshot_byte_order)
+            invalid_("mismatched byte order.");
+        if (hdr.value_size != sizeof(T) || hdr.value_align != alignof(T))
+            invalid_("mismatched value type.");
+
+        // n and c are bounded by the total size before the section sizes
+        // are computed, so the products cannot wrap around
+        const uint64_t n = hdr.count;
+        const uint64_t c = hdr.index_cap;
+        const uint64_t t = hdr.total_size;
+        if (t > size ||
+            n > t / sizeof(details::snapshot_entry) || n > t / sizeof(T) ||
+            c > t / sizeof(uint32_t) || c == 0 || (c & (c - 1)) != 0 || c / 2 < n ||
+            !within_(hdr, hdr.entries_off, n * sizeof(details::snapshot_entry)) ||
+            !within_(hdr, hdr.values_off, n * sizeof(T)) ||
+            !within_(hdr, hdr.index_off, c * sizeof(uint32_t)) ||
+            !within_(hdr, hdr.strings_off, hdr.strings_size))
+            invalid_("corrupted header.");
+
+        entries_ = reinterpret_cast<const details::snapshot_entry*>(base + hdr.entries_off);
+        values_ = reinterpret_cast<const T*>(base + hdr.values_off);
+        index_ = reinterpret_cast<const uint32_t*>(base + hdr.index_off);
+        strings_ = base + hdr.strings_off;
+        strings_size_ = static_cast<size_t>(hdr.strings_size);
+        count_ = static_cast<size_t>(n);
+        mask_ = static_cast<size_t>(c - 1);
+    }
+
+public:
+    size_type size() const noexcept {
+        return count_;
+    }
+
+    bool empty() const noexcept {
+        return count_ == 0;
+    }
+
+    // the i-th key and value, in the order they were saved
+
+    string_view key(size_type i) const noexcept {
+        const details::snapshot_entry& e = entries_[i];
+        return string_view(strings_ + e.key_off, e.key_len);
+    }
+
+    const T& value(size_type i) const noexcept {
+        return values_[i];
+    }
+
+    array_view<const T> values() const noexcept {
+        return array_view<const T>(values_, count_);
+    }
+
+    // lookup
+
+    // the position of key k, or size() if not found
+    size_type index_of(string_view k) const noexcept {
+        if (count_ == 0) return count_;
+        uint64_t h = details::snapshot_hash(k.data(), k.size());
+        uint32_t h32 = static_cast<uint32_t>(h >> 32);
+        size_t j = h & mask_;
+        for (size_t probes = 0; probes <= mask_ && index_[j] != 0; ++probes) {
+            size_t i = index_[j] - 1;
+            if (i >= count_) break;
+            const details::snapshot_entry& e = entries_[i];
+            if (e.hash == h32 && e.key_len == k.size() &&
+                e.key_off <= strings_size_ && e.key_len <= strings_size_ - e.key_off &&
+                std::memcmp(strings_ + e.key_off, k.data(), k.size()) == 0) return i;
+            j = (j + 1) & mask_;
+        }
+        return count_;
+    }
+
+    const T* find(string_view k) const noexcept {
+        size_type i = index_of(k);
+        return i < count_ ? values_ + i : nullptr;
+    }
+
+    size_type count(string_view k) const noexcept {
+        return index_of(k) < count_ ? 1 : 0;
+    }
+
+    const T& at(string_view k) const {
+        size_type i = index_of(k);
+        if (i == count_)
+            throw std::out_of_range("snapshot_view::at: the key is not found.");
+        return values_[i];
+    }
+
+private:
+    static bool within_(const details::snapshot_header& hdr, uint64_t off, uint64_t len) noexcept {
+        return off <= hdr.total_size && len <= hdr.total_size - off;
+    }
+
+    [[noreturn]] static void invalid_(const char* msg) {
+        throw std::invalid_argument(std::string("snapshot_view: ") + msg);
+    }
+};
+
+
+#ifdef CLUE_HAS_MMAP
+
+// A snapshot file mapped into memory (read-only), which owns the mapping.
+// Pages are loaded by the OS on demand, so opening takes O(1) time
+// regardless of the file size.
+
+template<class T>
+class mapped_snapshot : public snapshot_view<T> {
+private:
+    mapped_file file_;
+
+public:
+    explicit mapped_snapshot(const std::string& filename)
+        : file_(filename, mapped_file::random) {
+        if (file_.empty()) throw
+            std::runtime_error(std::string("Failed to map file ") + filename);
+        snapshot_view<T>::operator=(snapshot_view<T>(file_.data(), file_.size()));
+    }
+
+    mapped_snapshot(mapped_snapshot&& other) noexcept
+        : snapshot_view<T>(other)
+        , file_(std::move(other.file_)) {
+        other.snapshot_view<T>::operator=(snapshot_view<T>());
+    }
+
+    mapped_snapshot& operator=(mapped_snapshot&& other) noexcept {
+        if (this != &other) {
+            snapshot_view<T>::operator=(other);
+            file_ = std::move(other.file_);
+            other.snapshot_view<T>::operator=(snapshot_view<T>());
+        }
+        return *this;
+    }
+
+    // the size of the mapped file in bytes
+    size_t file_size() const noexcept {
+        return file_.size();
+    }
+};
+
+#endif
+
+} // end namespace clue
+
+#endif
@@ -57,8 +57,9 @@ public:
         }
     }
 
-    template<class Dict>
-    void render(std::ostream& out, const Dict& dict) const {
+    // out can be a std::ostream or a text_writer
+    template<class Out, class Dict>
+    void render(Out& out, const Dict& dict) const {
         for (const Part& part: _parts) {
             if (part.type == PartType::Term) {
                 out << dict.at(part.s);
@@ -10,8 +10,10 @@
 #define CLUE_STRING_VIEW__
 
 #include <clue/container_common.hpp>
+#include <clue/hash.hpp>
 #include <string>
 #include <ostream>
+#include <cstdint>
 
 
 namespace clue {
@@ -27,6 +29,70 @@ typedef basic_string_view<char16_t> u16string_view;
 typedef basic_string_view<char32_t> u32string_view;
 
 
+namespace details {
+
+// A set of bytes, as a 256-bit table, with which the membership of a
+// character is tested in constant time, regardless of the size of the set.
+
+class byte_set {
+private:
+    uint64_t bits_[4];
+
+public:
+    byte_set() noexcept : bits_{0, 0, 0, 0} {}
+
+    template<typename charT>
+    byte_set(const charT* s, ::std::size_t n) noexcept : bits_{0, 0, 0, 0} {
+        for (::std::size_t i = 0; i < n; ++i) add(static_cast<unsigned char>(s[i]));
+    }
+
+    void add(unsigned char c) noexcept {
+        bits_[c >> 6] |= uint64_t(1) << (c & 63);
+    }
+
+    bool contains(unsigned char c) const noexcept {
+        return ((bits_[c >> 6] >> (c & 63)) & 1) != 0;
+    }
+};
+
+// the predicate of whether a character is in the set s[0:n). For bytes
+// compared as such (i.e. with the standard character traits), it uses a
+// byte_set; otherwise, it scans the set for each character.
+
+template<typename charT, typename Traits,
+         bool Table=(sizeof(charT) == 1 &&
+                     ::std::is_same<Traits, ::std::char_traits<charT>>::value)>
+class char_set_pred;
+
+template<typename charT, typename Traits>
+class char_set_pred<charT, Traits, true> {
+private:
+    byte_set tab_;
+public:
+    char_set_pred(const charT* s, ::std::size_t n) noexcept : tab_(s, n) {}
+    bool operator()(charT c) const noexcept {
+        return tab_.contains(static_cast<unsigned char>(c));
+    }
+};
+
+template<typename charT, typename Traits>
+class char_set_pred<charT, Traits, false> {
+private:
+    const charT *s_;
+    const charT *se_;
+public:
+    constexpr char_set_pred(const charT* s, ::std::size_t n) noexcept :
+        s_(s), se_(s + n) {}
+    bool operator()(charT c) const noexcept {
+        const charT *p = s_;
+        while (p != se_ && !Traits::eq(c, *p)) ++p;
+        return p != se_;
+    }
+};
+
+} // end namespace details
+
+
 // class basic_string_view
 
 template<class charT, class Traits>
@@ -330,46 +396,22 @@ private:
         }
     };
 
-    class in_pred {
-    private:
-        const charT *s_;
-    public:
-        constexpr in_pred(const charT* s) noexcept : s_(s) { }
-        bool operator()(charT c) const noexcept {
-            const charT *p = s_;
-            while (*p && !Traits::eq(c, *p)) ++p;
-            return static_cast<bool>(*p);
-        }
-    };
-
-    class in_rgn_pred {
-    private:
-        const charT *s_;
-        const charT *se_;
-    public:
-        constexpr in_rgn_pred(const char *s, size_type n) noexcept :
-            s_(s), se_(s + n) {}
-        bool operator()(charT c) const noexcept {
-            const charT *p = s_;
-            while (p != se_ && !Traits::eq(c, *p)) ++p;
-            return p != se_;
-        }
-    };
+    typedef details::char_set_pred<charT, Traits> in_pred;
 
     static constexpr eq_pred eq_(charT c) noexcept {
         return eq_pred(c);
     }
 
-    static constexpr in_pred in_(const charT *s) noexcept {
-        return in_pred(s);
+    static in_pred in_(const charT *s) noexcept {
+        return in_pred(s, Traits::length(s));
     }
 
-    static constexpr in_rgn_pred in_(const char *s, size_type n) noexcept {
-        return in_rgn_pred(s, n);
+    static in_pred in_(const charT *s, size_type n) noexcept {
+        return in_pred(s, n);
     }
 
-    static constexpr in_rgn_pred in_(basic_string_view s) noexcept {
-        return in_rgn_pred(s.data(), s.size());
+    static in_pred in_(basic_string_view s) noexcept {
+        return in_pred(s.data(), s.size());
     }
 
     constexpr size_type get_pos_(const_iterator it) const noexcept {
@@ -454,6 +496,94 @@ inline bool operator>=(basic_string_view<charT, Traits> lhs, basic_string_view<c
     return lhs.compare(rhs) >= 0;
 }
 
+// Comparison with objects convertible to views (e.g. std::basic_string and C-strings)
+//
+// Only one side of each overload participates in template argument deduction,
+// the other side is converted implicitly (as required by the C++17 standard).
+
+namespace details {
+
+template<class T>
+struct sv_identity {
+    typedef T type;
+};
+
+template<class charT, class Traits>
+using sv_convertible_t = typename sv_identity<basic_string_view<charT, Traits>>::type;
+
+}
+
+#define CLUE_DEFINE_STRING_VIEW_MIXED_COMPARISON(op) \
+    template<class charT, class Traits> \
+    inline bool operator op (basic_string_view<charT, Traits> lhs, \
+                             details::sv_convertible_t<charT, Traits> rhs) noexcept { \
+        return lhs.compare(rhs) op 0; \
+    } \
+    template<class charT, class Traits> \
+    inline bool operator op (details::sv_convertible_t<charT, Traits> lhs, \
+                             basic_string_view<charT, Traits> rhs) noexcept { \
+        return lhs.compare(rhs) op 0; \
+    }
+
+CLUE_DEFINE_STRING_VIEW_MIXED_COMPARISON(==)
+CLUE_DEFINE_STRING_VIEW_MIXED_COMPARISON(!=)
+CLUE_DEFINE_STRING_VIEW_MIXED_COMPARISON(<)
+CLUE_DEFINE_STRING_VIEW_MIXED_COMPARISON(>)
+CLUE_DEFINE_STRING_VIEW_MIXED_COMPARISON(<=)
+CLUE_DEFINE_STRING_VIEW_MIXED_COMPARISON(>=)
+
+#undef CLUE_DEFINE_STRING_VIEW_MIXED_COMPARISON
+
+
+// Transparent functors
+//
+// These accept std::basic_string, basic_string_view and C-strings alike
+// (all converted to views without copying), and hence allow sorted or
+// hashed containers keyed by std::string to be looked up by string views
+// (e.g. flat_map with string_less, or ordered_dict with string_hash and
+// string_equal_to).
+
+template<class charT, class Traits = ::std::char_traits<charT> >
+struct basic_string_less {
+    typedef void is_transparent;
+
+    bool operator()(basic_string_view<charT, Traits> lhs,
+                    basic_string_view<charT, Traits> rhs) const noexcept {
+        return lhs.compare(rhs) < 0;
+    }
+};
+
+template<class charT, class Traits = ::std::char_traits<charT> >
+struct basic_string_equal_to {
+    typedef void is_transparent;
+
+    bool operator()(basic_string_view<charT, Traits> lhs,
+                    basic_string_view<charT, Traits> rhs) const noexcept {
+        return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
+    }
+};
+
+// hash_bytes over the underlying bytes, which yields the same value
+// for a std::basic_string and a view of the same characters.
+template<class charT, class Traits = ::std::char_traits<charT> >
+struct basic_string_hash {
+    typedef void is_transparent;
+
+    ::std::size_t operator()(basic_string_view<charT, Traits> sv) const noexcept {
+        return static_cast<::std::size_t>(
+            hash_bytes(sv.data(), sv.size() * sizeof(charT)));
+    }
+};
+
+typedef basic_string_less<char>    string_less;
+typedef basic_string_less<wchar_t> wstring_less;
+
+typedef basic_string_equal_to<char>    string_equal_to;
+typedef basic_string_equal_to<wchar_t> wstring_equal_to;
+
+typedef basic_string_hash<char>    string_hash;
+typedef basic_string_hash<wchar_t> wstring_hash;
+
 
 // stream output
 
@@ -493,17 +623,16 @@ inline ::std::basic_ostream<charT, Traits>& operator<< (
 
 namespace std {
 
+// the same as clue::basic_string_hash, which hashes the characters in
+// place (note that the values differ from those of std::hash<std::string>)
 template<class charT, class Traits>
-struct hash<clue::basic_string_view<charT, Traits> >
-    : public unary_function<clue::basic_string_view<charT, Traits>, size_t> {
+struct hash<clue::basic_string_view<charT, Traits> > {
+    typedef clue::basic_string_view<charT, Traits> argument_type;
+    typedef size_t result_type;
 
-    size_t operator()(const clue::basic_string_view<charT, Traits>& sv) const {
-        // TODO: implement more efficient hash (that is also consistent with that of std::string
-        return hash_(sv.to_string());
+    size_t operator()(const clue::basic_string_view<charT, Traits>& sv) const noexcept {
+        return clue::basic_string_hash<charT, Traits>()(sv);
     }
-
-private:
-    hash<basic_string<charT, Traits>> hash_;
 };
 
 }
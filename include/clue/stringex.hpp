@@ -10,6 +10,10 @@
 #include <clue/type_traits.hpp>
 #include <clue/string_view.hpp>
 #include <clue/predicates.hpp>
+#include <clue/charconv.hpp>
+#include <clue/fast_vector.hpp>
+#include <array>
+#include <stdexcept>
 #include <vector>
 #include <sstream>
 #include <cctype>
@@ -323,164 +327,127 @@ trim(const ::std::basic_string<charT, Traits, Allocator>& str) {
 
 namespace details {
 
-// a pointer p is considered as a valid end, if
-// p != sv.begin(), and
-// [p, sv.end()) are all spaces
-//
-template<typename Traits>
-inline bool is_valid_parse_end(basic_string_view<char, Traits> sv, const char *p) noexcept {
-    if (p == sv.begin()) return false;
-    const char *sv_end = sv.end();
-    while (p != sv_end && chars::is_space(*p)) ++p;
-    return p == sv_end;
-}
-
-inline bool is_valid_parse_end(const char *sz, const char *p) noexcept {
-    if (p == sz) return false;
-    while (*p && chars::is_space(*p)) ++p;
-    return !(*p);
+inline const char* skip_spaces(const char* p, const char* last) noexcept {
+    while (p != last && chars::is_space(*p)) ++p;
+    return p;
 }
 
-template<bool Longer>
-struct integer_parse_helper;
-
-template<>
-struct integer_parse_helper<false> {
-    using type = long;
-    static type run(const char *p, char** ppend) {
-        return ::std::strtol(p, ppend, 0);
-    }
-};
-
-template<>
-struct integer_parse_helper<true> {
-    using type = long;
-    static type run(const char *p, char** ppend) {
-        return ::std::strtoll(p, ppend, 0);
-    }
-};
-
+// integers: an optional sign, and a base-specific prefix as in strtol
+// with base 0 ("0x" for hexadecimal, "0" for octal)
 template<typename T>
-struct floating_point_parse_helper;
-
-template<>
-struct floating_point_parse_helper<float> {
-    using type = float;
-    static type run(const char *p, char **pend) {
-        return ::std::strtof(p, pend);
+inline enable_if_t<::std::is_integral<T>::value, bool>
+parse_value(const char* first, const char* last, T& x) {
+    const char* p = skip_spaces(first, last);
+    bool neg = false;
+    if (p != last && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        ++p;
     }
-};
-
-template<>
-struct floating_point_parse_helper<double> {
-    using type = double;
-    static type run(const char *p, char **pend) {
-        return ::std::strtod(p, pend);
-    }
-};
-
-template<>
-struct floating_point_parse_helper<long double> {
-    using type = long double;
-    static type run(const char *p, char **pend) {
-        return ::std::strtold(p, pend);
+    int base = 10;
+    if (p != last && *p == '0' && last - p > 1) {
+        if ((p[1] == 'x' || p[1] == 'X') && last - p > 2 && cc_digit_value(p[2]) < 16) {
+            base = 16;
+            p += 2;
+        } else {
+            base = 8;
+        }
     }
-};
-
-struct bool_parse_helper {
-    using type = bool;
-    static type run(const char *p, char **pend) {
-        // locate the begin
-        const char *p0 = p;
-        while (*p0 && chars::is_space(*p0)) p0++;
-
-        // empty
-        if (!(*p0)) {
-            *pend = const_cast<char*>(p);
+    uint64_t v;
+    bool overflow;
+    const char* e = cc_parse_uint(p, last, base, v, overflow);
+    if (e == p || overflow || skip_spaces(e, last) != last) return false;
+
+    using U = typename ::std::make_unsigned<T>::type;
+    if (neg) {
+        if (!::std::is_signed<T>::value) {
+            if (v != 0) return false;
+        } else if (v > static_cast<uint64_t>(::std::numeric_limits<T>::max()) + 1) {
             return false;
         }
+        x = static_cast<T>(static_cast<U>(0) - static_cast<U>(v));
+    } else {
+        if (v > static_cast<uint64_t>(::std::numeric_limits<T>::max())) return false;
+        x = static_cast<T>(v);
+    }
+    return true;
+}
 
-        // locate the word end
-        const char *p1 = p0 + 1;
-        while (*p1 && !chars::is_space(*p1)) p1++;
-
-        // single non-space character
-        if (p1 == p0 + 1) {
-            char c = *p0;
-            switch (c) {
-                case '0':
-                case 'F':
-                case 'f':
-                    *pend = const_cast<char*>(p1);
-                    return false;
-                case '1':
-                case 'T':
-                case 't':
-                    *pend = const_cast<char*>(p1);
-                    return true;
-            }
-            *pend = const_cast<char*>(p);
-            return false;
-        }
+// floating point numbers: an optional sign, and the decimal notation,
+// inf or nan (as from_chars), or the hexadecimal notation (as strtod)
+template<typename T>
+inline enable_if_t<::std::is_floating_point<T>::value, bool>
+parse_value(const char* first, const char* last, T& x) {
+    const char* p = skip_spaces(first, last);
+    const char* e;
+    T v;
+    const bool plus = p != last && *p == '+';
+    const char* s = plus ? p + 1 : p;
+    const char* t = (s != last && *s == '-') ? s + 1 : s;
+    if (plus && s != last && *s == '-') return false;
+    if (::std::is_same<T, long double>::value ||
+        (last - t > 1 && t[0] == '0' && (t[1] == 'x' || t[1] == 'X'))) {
+        e = cc_strto_bounded(p, last, v);
+        if (e == p) return false;
+    } else {
+        conditional_t<::std::is_same<T, float>::value, float, double> y;
+        from_chars_result r = from_chars(s, last, y);
+        if (r.ec != ::std::errc()) return false;
+        e = r.ptr;
+        v = static_cast<T>(y);
+    }
+    if (skip_spaces(e, last) != last) return false;
+    x = v;
+    return true;
+}
+
+// booleans: 0, 1, t, f, true, false (case-insensitive)
+inline bool parse_value(const char* first, const char* last, bool& x) {
+    const char* p0 = skip_spaces(first, last);
+    const char* p1 = last;
+    while (p1 != p0 && chars::is_space(p1[-1])) --p1;
+    const size_t len = static_cast<size_t>(p1 - p0);
 
-        // multi-characters
-        size_t len = static_cast<size_t>(p1 - p0);
-        if (len == 4) {
-            if (_icmp<4>(p0, "true")) {
-                *pend = const_cast<char*>(p1);
+    if (len == 1) {
+        switch (*p0) {
+            case '0':
+            case 'F':
+            case 'f':
+                x = false;
+                return true;
+            case '1':
+            case 'T':
+            case 't':
+                x = true;
                 return true;
-            }
-        } else if (len == 5) {
-            if (_icmp<5>(p0, "false")) {
-                *pend = const_cast<char*>(p1);
-                return false;
-            }
         }
-
-        *pend = const_cast<char*>(p);
-        return false;
+    } else if (len == 4 && _icmp<4>(p0, "true")) {
+        x = true;
+        return true;
+    } else if (len == 5 && _icmp<5>(p0, "false")) {
+        x = false;
+        return true;
     }
-};
-
-template<typename T>
-using default_parse_helper_of =
-        conditional_t<::std::is_same<T, bool>::value,
-            bool_parse_helper,
-        conditional_t<::std::is_integral<T>::value,
-            integer_parse_helper<(sizeof(T) > sizeof(long))>,
-            floating_point_parse_helper<T>
-        >>;
+    return false;
+}
 
 } // end namespace details
 
 // try_parse function for arithmetic types
+//
+// The string is parsed within its bounds, without regard to the locale
+// (except for long double and hexadecimal floating-point numbers, where
+// strtod_l is not available).
 
 template<typename T, typename Traits>
 inline enable_if_t<::std::is_arithmetic<T>::value, bool>
 try_parse(basic_string_view<char, Traits> sv, T& x) {
-    using helper = details::default_parse_helper_of<T>;
-    char *pend;
-    typename helper::type _x = helper::run(sv.begin(), &pend);
-    if (details::is_valid_parse_end(sv, pend)) {
-        x = static_cast<T>(_x);
-        return true;
-    } else {
-        return false;
-    }
+    return details::parse_value(sv.data(), sv.data() + sv.size(), x);
 }
 
 template<typename T>
 inline enable_if_t<::std::is_arithmetic<T>::value, bool>
 try_parse(const char *sz, T& x) {
-    using helper = details::default_parse_helper_of<T>;
-    char *pend;
-    typename helper::type _x = helper::run(sz, &pend);
-    if (details::is_valid_parse_end(sz, pend)) {
-        x = static_cast<T>(_x);
-        return true;
-    } else {
-        return false;
-    }
+    return details::parse_value(sz, sz + ::std::strlen(sz), x);
 }
 
 template<typename T, typename Traits, typename Allocator>
@@ -498,15 +465,11 @@ try_parse(const std::basic_string<char, Traits, Allocator>& str, T& x) {
 
 namespace details {
 
+// the delimiters given as a C-string, as a set (see char_set_pred)
 template<typename charT, typename Traits=::std::char_traits<charT>>
-struct is_in_cstr_ {
-    const charT *cstr_;
-    bool operator()(charT c) const noexcept {
-        const charT *p = cstr_;
-        while (*p && !Traits::eq(c, *p)) p++;
-        return static_cast<bool>(*p);
-    }
-};
+inline char_set_pred<charT, Traits> is_in_cstr_(const charT *cstr) noexcept {
+    return char_set_pred<charT, Traits>(cstr, Traits::length(cstr));
+}
 
 template<typename charT, typename Traits=::std::char_traits<charT>>
 struct is_eq_char_ {
@@ -568,7 +531,7 @@ inline void foreach_token_of(const charT *str, charT delim, F&& f) {
 template<typename charT, typename F>
 inline void foreach_token_of(const charT *str, const charT *delims, F&& f) {
     details::foreach_token_of_(str,
-        details::is_in_cstr_<charT>{delims}, ::std::forward<F>(f));
+        details::is_in_cstr_<charT>(delims), ::std::forward<F>(f));
 }
 
 template<typename charT, typename Traits, typename F>
@@ -580,7 +543,7 @@ inline void foreach_token_of(basic_string_view<charT, Traits> sv, charT delim, F
 template<typename charT, typename Traits, typename F>
 inline void foreach_token_of(basic_string_view<charT, Traits> sv, const charT *delims, F&& f) {
     details::foreach_token_of_(sv,
-        details::is_in_cstr_<charT, Traits>{delims}, ::std::forward<F>(f));
+        details::is_in_cstr_<charT, Traits>(delims), ::std::forward<F>(f));
 }
 
 template<typename charT, typename Traits, typename Allocator, typename F>
@@ -594,6 +557,103 @@ inline void foreach_token_of(::std::basic_string<charT, Traits, Allocator>& str,
 }
 
 
+//===============================================
+//
+//   Splitting into token views
+//
+//===============================================
+
+// The split functions extract the same tokens as foreach_token_of (i.e.
+// empty tokens are skipped), as views into sv, with delims being either a
+// character or a C-string of delimiters. They do not allocate once the
+// output has the capacity needed, so an output reused across lines (e.g.
+// in a loop over the lines of a file) allocates only a few times.
+
+namespace details {
+
+template<typename charT, typename Traits>
+inline is_eq_char_<charT, Traits> split_delims_(charT delim) noexcept {
+    return is_eq_char_<charT, Traits>{delim};
+}
+
+template<typename charT, typename Traits>
+inline char_set_pred<charT, Traits> split_delims_(const charT *delims) noexcept {
+    return is_in_cstr_<charT, Traits>(delims);
+}
+
+} // end namespace details
+
+// split sv into tokens, replacing the contents of out,
+// and return the number of tokens
+template<typename charT, typename Traits, typename D,
+         size_t SCap, bool Reloc, class Allocator>
+inline size_t split_into(basic_string_view<charT, Traits> sv, D delims,
+    fast_vector<basic_string_view<charT, Traits>, SCap, Reloc, Allocator>& out) {
+    out.clear();
+    details::foreach_token_of_(sv,
+        details::split_delims_<charT, Traits>(delims),
+        [&](const charT *p, size_t n) {
+            out.emplace_back(p, n);
+            return true;
+        });
+    return out.size();
+}
+
+// split sv into at most N tokens, stopping at the N-th token, and return
+// the number of tokens found (the remaining elements of out are empty)
+template<typename charT, typename Traits, typename D, size_t N>
+inline size_t split_into(basic_string_view<charT, Traits> sv, D delims,
+    ::std::array<basic_string_view<charT, Traits>, N>& out) {
+    static_assert(N > 0, "split_into: the array must have at least one element.");
+    size_t k = 0;
+    details::foreach_token_of_(sv,
+        details::split_delims_<charT, Traits>(delims),
+        [&](const charT *p, size_t n) {
+            out[k++] = basic_string_view<charT, Traits>(p, n);
+            return k < N;
+        });
+    for (size_t i = k; i < N; ++i) out[i] = basic_string_view<charT, Traits>();
+    return k;
+}
+
+// extract the tokens at the given indices, in ascending order, into out,
+// such that out[j] is token indices[j]. The indices can be any random
+// access sequence (e.g. std::vector<size_t> or std::array<size_t, M>).
+// Tokens after the last index are not scanned. It returns the number of
+// tokens found (the others are left empty), and throws
+// std::invalid_argument if the indices are not strictly ascending.
+template<typename charT, typename Traits, typename D, class Indices,
+         size_t SCap, bool Reloc, class Allocator>
+inline size_t split_select(basic_string_view<charT, Traits> sv, D delims,
+    const Indices& indices,
+    fast_vector<basic_string_view<charT, Traits>, SCap, Reloc, Allocator>& out) {
+    using std::begin;
+    using std::end;
+    auto ib = begin(indices);
+    auto ie = end(indices);
+    for (auto it = ib; it != ie; ++it) {
+        if (it != ib && !(*(it - 1) < *it)) throw std::invalid_argument(
+            "split_select: the indices must be strictly ascending.");
+    }
+    out.clear();
+    out.resize(static_cast<size_t>(ie - ib));
+    if (ib == ie) return 0;
+
+    size_t i = 0;   // the index of the current token
+    size_t j = 0;   // the next element of out
+    details::foreach_token_of_(sv,
+        details::split_delims_<charT, Traits>(delims),
+        [&](const charT *p, size_t n) {
+            if (i++ == static_cast<size_t>(ib[j])) {
+                out[j++] = basic_string_view<charT, Traits>(p, n);
+                return ib + j != ie;
+            }
+            return true;
+        });
+    return j;
+}
+
+
 }
 
 #endif
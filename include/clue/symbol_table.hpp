@@ -0,0 +1,371 @@
+/**
+ * @file symbol_table.hpp
+ *
+ * String interning: the symbol_table class stores each distinct string
+ * once, contiguously in an arena, and identifies it with a 32-bit symbol
+ * id. Interned strings are referred to by ids or by string views, which
+ * remain valid for the lifetime of the table (until it is cleared).
+ */
+
+#ifndef CLUE_SYMBOL_TABLE__
+#define CLUE_SYMBOL_TABLE__
+
+#include <clue/string_view.hpp>
+#include <clue/flat_hash_map.hpp>
+#include <clue/shared_mutex.hpp>
+#include <clue/memory.hpp>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+namespace clue {
+
+template<class charT, class Traits=std::char_traits<charT>>
+class basic_symbol_table {
+public:
+    using char_type = charT;
+    using traits_type = Traits;
+    using view_type = basic_string_view<charT, Traits>;
+    using symbol_type = uint32_t;
+    using size_type = std::size_t;
+    using const_iterator = typename std::vector<view_type>::const_iterator;
+
+    static constexpr symbol_type npos = ~symbol_type(0);
+    static constexpr size_t default_block_size = 64 * 1024;
+
+private:
+    using map_type = flat_hash_map<view_type, symbol_type,
+        basic_string_hash<charT, Traits>,
+        basic_string_equal_to<charT, Traits>>;
+
+    struct block_ {
+        std::unique_ptr<charT[]> data;
+        size_t size;
+    };
+
+    std::vector<block_> blocks_;
+    charT* cur_ = nullptr;      // the free space of the current block
+    size_t left_ = 0;
+    size_t nchars_ = 0;         // the characters stored (with terminators)
+    size_t block_size_;
+    std::vector<view_type> strs_;
+    map_type map_;
+
+public:
+    // block_size: the number of characters in each arena block
+    explicit basic_symbol_table(size_t block_size = default_block_size)
+        : block_size_(block_size > 0 ? block_size : 1) {}
+
+    basic_symbol_table(const basic_symbol_table&) = delete;
+    basic_symbol_table& operator=(const basic_symbol_table&) = delete;
+
+    // moving keeps the arena, so views remain valid
+    basic_symbol_table(basic_symbol_table&& other)
+        : blocks_(std::move(other.blocks_))
+        , cur_(other.cur_)
+        , left_(other.left_)
+        , nchars_(other.nchars_)
+        , block_size_(other.block_size_)
+        , strs_(std::move(other.strs_))
+        , map_(std::move(other.map_)) {
+        other.clear();
+    }
+
+    basic_symbol_table& operator=(basic_symbol_table&& other) {
+        if (this != &other) {
+            blocks_ = std::move(other.blocks_);
+            cur_ = other.cur_;
+            left_ = other.left_;
+            nchars_ = other.nchars_;
+            block_size_ = other.block_size_;
+            strs_ = std::move(other.strs_);
+            map_ = std::move(other.map_);
+            other.clear();
+        }
+        return *this;
+    }
+
+public:
+    size_type size() const noexcept {
+        return strs_.size();
+    }
+
+    bool empty() const noexcept {
+        return strs_.empty();
+    }
+
+    const_iterator begin() const noexcept { return strs_.begin(); }
+    const_iterator end()   const noexcept { return strs_.end(); }
+
+    memory_usage_info memory_usage() const noexcept {
+        memory_usage_info u = map_.memory_usage();
+        size_t ab = 0, ao = 0;
+        for (const block_& b: blocks_) {
+            ab += b.size * sizeof(charT);
+            ao += malloc_overhead(b.size * sizeof(charT));
+        }
+        const size_t vb = strs_.capacity() * sizeof(view_type);
+        return memory_usage_info(
+            nchars_ * sizeof(charT),
+            u.elements + u.index + u.slack + vb,
+            ab - nchars_ * sizeof(charT),
+            u.overhead + ao + malloc_overhead(vb) +
+            malloc_overhead(blocks_.capacity() * sizeof(block_)));
+    }
+
+public:
+    // the string of symbol id (which must be valid)
+    view_type str(symbol_type id) const noexcept {
+        return strs_[id];
+    }
+
+    view_type operator[](symbol_type id) const noexcept {
+        return strs_[id];
+    }
+
+    view_type at(symbol_type id) const {
+        if (id >= strs_.size())
+            throw std::out_of_range("symbol_table::at: invalid symbol id.");
+        return strs_[id];
+    }
+
+    // the interned strings are null-terminated
+    const charT* c_str(symbol_type id) const noexcept {
+        return strs_[id].data();
+    }
+
+    // the symbol id of s, or npos if s has not been interned
+    symbol_type find(view_type s) const {
+        return find_hashed(hash_(s), s);
+    }
+
+    symbol_type find_hashed(size_t h, view_type s) const {
+        auto it = map_.find_hashed(h, s);
+        return it == map_.end() ? npos : it->second;
+    }
+
+    bool contains(view_type s) const {
+        return find(s) != npos;
+    }
+
+    size_t hash(view_type s) const noexcept {
+        return hash_(s);
+    }
+
+public:
+    // the symbol id of s, which is interned if it is new
+    symbol_type intern(view_type s) {
+        return intern_hashed(hash_(s), s);
+    }
+
+    symbol_type intern_hashed(size_t h, view_type s) {
+        auto it = map_.find_hashed(h, s);
+        if (it != map_.end()) return it->second;
+
+        if (strs_.size() >= npos)
+            throw std::length_error("symbol_table: too many symbols.");
+        symbol_type id = static_cast<symbol_type>(strs_.size());
+        // the steps that may throw come before the string is stored, so
+        // that a failure leaves the arena (and memory_usage()) unchanged,
+        // and the insertion into the reserved map cannot throw
+        strs_.push_back(view_type());
+        try {
+            map_.reserve(strs_.size());
+            strs_.back() = store_(s);
+        } catch (...) {
+            strs_.pop_back();
+            throw;
+        }
+        map_.try_emplace_hashed(h, strs_.back(), id);
+        return id;
+    }
+
+    // the interned copy of s
+    view_type intern_view(view_type s) {
+        return strs_[intern(s)];
+    }
+
+    // reserve room for n symbols (the arena grows as needed)
+    void reserve(size_type n) {
+        strs_.reserve(n);
+        map_.reserve(n);
+    }
+
+    // remove all symbols, and release the arena
+    // (which invalidates all views)
+    void clear() {
+        map_.clear();
+        strs_.clear();
+        blocks_.clear();
+        cur_ = nullptr;
+        left_ = 0;
+        nchars_ = 0;
+    }
+
+private:
+    static size_t hash_(view_type s) noexcept {
+        return basic_string_hash<charT, Traits>()(s);
+    }
+
+    // copy s (null-terminated) into the arena
+    view_type store_(view_type s) {
+        const size_t n = s.size() + 1;
+        charT* p;
+        if (n <= left_) {
+            p = cur_;
+            cur_ += n;
+            left_ -= n;
+        } else if (n > block_size_ / 4) {
+            // a long string takes a block of its own,
+            // leaving the current block in use
+            p = new_block_(n);
+        } else {
+            p = new_block_(block_size_);
+            cur_ = p + n;
+            left_ = block_size_ - n;
+        }
+        Traits::copy(p, s.data(), s.size());
+        p[s.size()] = charT();
+        nchars_ += n;
+        return view_type(p, s.size());
+    }
+
+    charT* new_block_(size_t c) {
+        block_ b{std::unique_ptr<charT[]>(new charT[c]), c};
+        blocks_.push_back(std::move(b));
+        return blocks_.back().data.get();
+    }
+};
+
+template<class charT, class Traits>
+constexpr typename basic_symbol_table<charT, Traits>::symbol_type
+basic_symbol_table<charT, Traits>::npos;
+
+template<class charT, class Traits>
+constexpr size_t basic_symbol_table<charT, Traits>::default_block_size;
+
+
+// A thread-safe symbol table. Lookups of existing strings (the common
+// case) take a reader-writer lock in shared mode, so they proceed in
+// parallel; only the interning of new strings takes it exclusively.
+// The views returned remain valid without holding any lock.
+
+template<class charT, class Traits=std::char_traits<charT>>
+class basic_concurrent_symbol_table {
+public:
+    using table_type = basic_symbol_table<charT, Traits>;
+    using char_type = charT;
+    using traits_type = Traits;
+    using view_type = typename table_type::view_type;
+    using symbol_type = typename table_type::symbol_type;
+    using size_type = std::size_t;
+
+    static constexpr symbol_type npos = table_type::npos;
+
+private:
+    using mutex_type = details::rw_spinlock;
+    using read_lock = shared_lock<mutex_type>;
+    using write_lock = std::unique_lock<mutex_type>;
+
+    mutable mutex_type mut_;
+    table_type table_;
+
+public:
+    explicit basic_concurrent_symbol_table(
+        size_t block_size = table_type::default_block_size)
+        : table_(block_size) {}
+
+    basic_concurrent_symbol_table(const basic_concurrent_symbol_table&) = delete;
+    basic_concurrent_symbol_table& operator=(const basic_concurrent_symbol_table&) = delete;
+
+public:
+    size_type size() const {
+        read_lock lk(mut_);
+        return table_.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    memory_usage_info memory_usage() const {
+        read_lock lk(mut_);
+        return table_.memory_usage();
+    }
+
+    view_type str(symbol_type id) const {
+        read_lock lk(mut_);
+        return table_.str(id);
+    }
+
+    view_type at(symbol_type id) const {
+        read_lock lk(mut_);
+        return table_.at(id);
+    }
+
+    symbol_type find(view_type s) const {
+        size_t h = table_.hash(s);
+        read_lock lk(mut_);
+        return table_.find_hashed(h, s);
+    }
+
+    bool contains(view_type s) const {
+        return find(s) != npos;
+    }
+
+    symbol_type intern(view_type s) {
+        size_t h = table_.hash(s);
+        {
+            read_lock lk(mut_);
+            symbol_type id = table_.find_hashed(h, s);
+            if (id != npos) return id;
+        }
+        // another thread may have interned s in between,
+        // which intern_hashed takes care of
+        write_lock lk(mut_);
+        return table_.intern_hashed(h, s);
+    }
+
+    view_type intern_view(view_type s) {
+        size_t h = table_.hash(s);
+        {
+            read_lock lk(mut_);
+            symbol_type id = table_.find_hashed(h, s);
+            if (id != npos) return table_.str(id);
+        }
+        write_lock lk(mut_);
+        return table_.str(table_.intern_hashed(h, s));
+    }
+
+    void reserve(size_type n) {
+        write_lock lk(mut_);
+        table_.reserve(n);
+    }
+
+    // copy the views of all symbols (in the order of ids)
+    std::vector<view_type> snapshot() const {
+        read_lock lk(mut_);
+        return std::vector<view_type>(table_.begin(), table_.end());
+    }
+
+    void clear() {
+        write_lock lk(mut_);
+        table_.clear();
+    }
+};
+
+template<class charT, class Traits>
+constexpr typename basic_concurrent_symbol_table<charT, Traits>::symbol_type
+basic_concurrent_symbol_table<charT, Traits>::npos;
+
+
+typedef basic_symbol_table<char>    symbol_table;
+typedef basic_symbol_table<wchar_t> wsymbol_table;
+
+typedef basic_concurrent_symbol_table<char>    concurrent_symbol_table;
+typedef basic_concurrent_symbol_table<wchar_t> wconcurrent_symbol_table;
+
+} // end namespace clue
+
+#endif
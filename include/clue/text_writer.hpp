@@ -0,0 +1,333 @@
+/**
+ * @file text_writer.hpp
+ *
+ * A buffered text writer, which appends text and numbers into a growable
+ * buffer in memory, or into a buffer that is written to a file when it
+ * is full or flushed.
+ *
+ * Unlike std::ostream, it has no locale, no virtual dispatch, and no
+ * sentry objects, so each append costs little more than copying the
+ * characters. Numbers are converted with to_chars (see charconv.hpp).
+ */
+
+#ifndef CLUE_TEXT_WRITER__
+#define CLUE_TEXT_WRITER__
+
+#include <clue/common.hpp>
+#include <clue/string_view.hpp>
+#include <clue/charconv.hpp>
+#include <clue/sformat.hpp>
+#include <clue/stemplate.hpp>
+#include <clue/textio.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace clue {
+
+class text_writer {
+public:
+    static constexpr size_t default_buffer_size = 64 * 1024;
+
+private:
+    std::unique_ptr<char[]> buf_;
+    size_t len_;
+    size_t cap_;
+    int fd_;            // -1 for writing into memory
+    bool own_fd_;
+
+public:
+    // write into a growable buffer in memory
+    text_writer()
+        : len_(0), cap_(0), fd_(-1), own_fd_(false) {}
+
+#ifdef CLUE_HAS_POSIX_IO
+    // write to a file descriptor (which is not closed by the writer),
+    // through a buffer of bufsize bytes
+    explicit text_writer(int fd, size_t bufsize = default_buffer_size)
+        : buf_(new char[bufsize > 64 ? bufsize : 64])
+        , len_(0)
+        , cap_(bufsize > 64 ? bufsize : 64)
+        , fd_(fd), own_fd_(false) {}
+
+    // write to a file, which is created or truncated
+    explicit text_writer(const std::string& filename, size_t bufsize = default_buffer_size)
+        : text_writer(open_(filename), bufsize) {
+        own_fd_ = true;
+    }
+#endif
+
+    text_writer(const text_writer&) = delete;
+    text_writer& operator=(const text_writer&) = delete;
+
+    text_writer(text_writer&& other) noexcept
+        : buf_(std::move(other.buf_))
+        , len_(other.len_), cap_(other.cap_)
+        , fd_(other.fd_), own_fd_(other.own_fd_) {
+        other.len_ = other.cap_ = 0;
+        other.fd_ = -1;
+        other.own_fd_ = false;
+    }
+
+    // the current target is closed (as by close()) first
+    text_writer& operator=(text_writer&& other) {
+        if (this != &other) {
+            close();
+            buf_ = std::move(other.buf_);
+            len_ = other.len_;
+            cap_ = other.cap_;
+            fd_ = other.fd_;
+            own_fd_ = other.own_fd_;
+            other.len_ = other.cap_ = 0;
+            other.fd_ = -1;
+            other.own_fd_ = false;
+        }
+        return *this;
+    }
+
+    // the buffered text is flushed, and errors are ignored
+    // (call flush() or close() to detect them)
+    ~text_writer() {
+        try {
+            close();
+        } catch (...) {}
+    }
+
+public:
+    // the text buffered (for a writer in memory, all the text written)
+    string_view view() const noexcept {
+        return string_view(buf_.get(), len_);
+    }
+
+    std::string str() const {
+        return std::string(buf_.get(), len_);
+    }
+
+    size_t size() const noexcept {
+        return len_;
+    }
+
+    bool empty() const noexcept {
+        return len_ == 0;
+    }
+
+    // discard the text buffered
+    void clear() noexcept {
+        len_ = 0;
+    }
+
+    // make sure that n more characters can be buffered without growing
+    // (or, for a file, without flushing)
+    void reserve(size_t n) {
+        if (CLUE_UNLIKELY(cap_ - len_ < n)) make_room_(n);
+    }
+
+    // write the text buffered to the file (no-op for a writer in memory)
+    void flush() {
+#ifdef CLUE_HAS_POSIX_IO
+        if (fd_ < 0) return;
+        const char* p = buf_.get();
+        size_t n = len_;
+        len_ = 0;
+        write_fd_(p, n);
+#endif
+    }
+
+    // flush, and close the file if it is opened by the writer
+    void close() {
+        flush();
+#ifdef CLUE_HAS_POSIX_IO
+        if (own_fd_) {
+            own_fd_ = false;
+            int fd = fd_;
+            fd_ = -1;
+            if (::close(fd) != 0)
+                throw std::runtime_error("text_writer: failed to close file.");
+        }
+#endif
+    }
+
+public:
+    text_writer& put(char c) {
+        if (CLUE_UNLIKELY(len_ == cap_)) make_room_(1);
+        buf_[len_++] = c;
+        return *this;
+    }
+
+    text_writer& write(const char* s, size_t n) {
+        if (CLUE_UNLIKELY(cap_ - len_ < n)) {
+#ifdef CLUE_HAS_POSIX_IO
+            // a large piece is written to the file directly
+            if (fd_ >= 0 && n >= cap_) {
+                flush();
+                write_fd_(s, n);
+                return *this;
+            }
+#endif
+            make_room_(n);
+        }
+        std::memcpy(buf_.get() + len_, s, n);
+        len_ += n;
+        return *this;
+    }
+
+    text_writer& write(string_view s) {
+        return write(s.data(), s.size());
+    }
+
+    text_writer& operator<< (char c) {
+        return put(c);
+    }
+
+    text_writer& operator<< (const char* s) {
+        return write(s, std::strlen(s));
+    }
+
+    text_writer& operator<< (string_view s) {
+        return write(s.data(), s.size());
+    }
+
+    text_writer& operator<< (const std::string& s) {
+        return write(s.data(), s.size());
+    }
+
+    text_writer& operator<< (bool x) {
+        return x ? write("true", 4) : write("false", 5);
+    }
+
+    // integers (other than char and bool)
+    template<class T>
+    enable_if_t<std::is_integral<T>::value, text_writer&>
+    operator<< (T x) {
+        return put_number_(x);
+    }
+
+    // floating point numbers, written with the fewest digits that read
+    // back exactly (e.g. 0.1 as "0.1", and 1.0/3 as "0.3333333333333333")
+    text_writer& operator<< (double x) {
+        return put_number_(x);
+    }
+
+    text_writer& operator<< (float x) {
+        return put_number_(x);
+    }
+
+    // long double, in the shortest form as double if it is exactly a
+    // double, and otherwise with enough digits to read back exactly
+    text_writer& operator<< (long double x) {
+        const double d = static_cast<double>(x);
+        if (static_cast<long double>(d) == x || x != x) return put_number_(d);
+        reserve(64);
+        char* p = buf_.get() + len_;
+        int n = std::snprintf(p, cap_ - len_, "%.*Lg",
+            std::numeric_limits<long double>::max_digits10, x);
+        // the decimal point is always '.', regardless of the C locale
+        for (int i = 0; i < n; ++i) {
+            if (p[i] != '-' && p[i] != '+' && p[i] != 'e' && (p[i] < '0' || p[i] > '9'))
+                p[i] = '.';
+        }
+        len_ += static_cast<size_t>(n);
+        return *this;
+    }
+
+    // printf-style formatting, directly into the buffer
+    template<class... Ts>
+    text_writer& printf(const char* fmt, const Ts&... xs) {
+        reserve(64);
+        int n = std::snprintf(buf_.get() + len_, cap_ - len_, fmt, xs...);
+        if (n < 0)
+            throw std::invalid_argument("text_writer::printf: invalid format.");
+        if (static_cast<size_t>(n) >= cap_ - len_) {
+            reserve(static_cast<size_t>(n) + 1);
+            std::snprintf(buf_.get() + len_, cap_ - len_, fmt, xs...);
+        }
+        len_ += static_cast<size_t>(n);
+        return *this;
+    }
+
+private:
+    template<typename T>
+    text_writer& put_number_(T x) {
+        reserve(24);
+        char* p = buf_.get();
+        len_ = static_cast<size_t>(to_chars(p + len_, p + cap_, x).ptr - p);
+        return *this;
+    }
+
+    void make_room_(size_t n) {
+#ifdef CLUE_HAS_POSIX_IO
+        if (fd_ >= 0) {
+            flush();
+            if (n <= cap_) return;
+        }
+#endif
+        size_t c = cap_ > 0 ? cap_ * 2 : 256;
+        while (c - len_ < n) c *= 2;
+        std::unique_ptr<char[]> b(new char[c]);
+        if (len_ > 0) std::memcpy(b.get(), buf_.get(), len_);
+        buf_ = std::move(b);
+        cap_ = c;
+    }
+
+#ifdef CLUE_HAS_POSIX_IO
+    static int open_(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw
+            std::runtime_error(std::string("Failed to open file ") + filename);
+        return fd;
+    }
+
+    void write_fd_(const char* p, size_t n) {
+        while (n > 0) {
+            ssize_t r = ::write(fd_, p, n);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("text_writer: failed to write file.");
+            }
+            p += r;
+            n -= static_cast<size_t>(r);
+        }
+    }
+#endif
+};
+
+
+// writing the helpers of sformat.hpp and stemplate.hpp
+
+template<class Seq>
+inline text_writer& operator << (text_writer& out, const Delimits<Seq>& a) {
+    auto it = a.seq.begin();
+    auto it_end = a.seq.end();
+    if (it != it_end) {
+        out << *it;
+        ++it;
+        for(;it != it_end; ++it)
+            out << a.delimiter << *it;
+    }
+    return out;
+}
+
+template<typename T>
+inline text_writer& operator << (text_writer& out, const shortest_t<T>& a) {
+    return out << a.value;
+}
+
+template<typename T>
+inline text_writer& operator << (text_writer& out, const cfmt_t<T>& a) {
+    return out.printf(a.format, a.value);
+}
+
+template<class Dict>
+inline text_writer& operator << (text_writer& out, const stemplate_wrap<Dict>& w) {
+    w.templ.render(out, w.dict);
+    return out;
+}
+
+} // end namespace clue
+
+#endif
@@ -3,10 +3,24 @@
 
 #include <clue/common.hpp>
 #include <clue/stringex.hpp>
+#include <clue/memory.hpp>
+#include <clue/memscan.hpp>
+#include <clue/fast_vector.hpp>
+#include <cerrno>
 #include <cstring>
+#include <iterator>
 #include <fstream>
 #include <stdexcept>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CLUE_HAS_MMAP 1
+#define CLUE_HAS_POSIX_IO 1
+#endif
+
 namespace clue {
 
 // read file content entirely into a string
@@ -30,6 +44,335 @@ inline std::string read_file_content(const std::string& filename) {
 }
 
 
+#ifdef CLUE_HAS_MMAP
+
+// A file mapped into memory (read-only), which owns the mapping.
+//
+// Unlike read_file_content, this neither copies the content nor
+// allocates memory for it: pages are loaded by the OS on demand
+// (and can be evicted under memory pressure), so opening takes O(1)
+// time regardless of the file size.
+
+class mapped_file {
+public:
+    // access hints, which can be combined with |
+    enum advice : unsigned {
+        normal     = 0,
+        sequential = 1,     // read ahead aggressively, drop pages behind
+        random     = 2,     // no read-ahead
+        willneed   = 4,     // start loading the whole file now
+        hugepage   = 8      // back with huge pages where supported
+    };
+
+private:
+    void* addr_;
+    size_t len_;
+
+public:
+    mapped_file() noexcept
+        : addr_(nullptr), len_(0) {}
+
+    explicit mapped_file(const char* filename, unsigned adv = normal)
+        : addr_(nullptr), len_(0) {
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0) throw
+            std::runtime_error(std::string("Failed to open file ") + filename);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error(std::string("Failed to stat file ") + filename);
+        }
+        len_ = static_cast<size_t>(st.st_size);
+        if (len_ > 0) {
+            addr_ = ::mmap(nullptr, len_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr_ == MAP_FAILED) {
+                addr_ = nullptr;
+                len_ = 0;
+                ::close(fd);
+                throw std::runtime_error(std::string("Failed to map file ") + filename);
+            }
+        }
+        ::close(fd);
+        advise(adv);
+    }
+
+    explicit mapped_file(const std::string& filename, unsigned adv = normal)
+        : mapped_file(filename.c_str(), adv) {}
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+        : addr_(other.addr_), len_(other.len_) {
+        other.addr_ = nullptr;
+        other.len_ = 0;
+    }
+
+    mapped_file& operator=(mapped_file&& other) noexcept {
+        if (this != &other) {
+            unmap_();
+            addr_ = other.addr_;
+            len_ = other.len_;
+            other.addr_ = nullptr;
+            other.len_ = 0;
+        }
+        return *this;
+    }
+
+    ~mapped_file() {
+        unmap_();
+    }
+
+public:
+    const char* data() const noexcept {
+        return static_cast<const char*>(addr_);
+    }
+
+    size_t size() const noexcept {
+        return len_;
+    }
+
+    bool empty() const noexcept {
+        return len_ == 0;
+    }
+
+    string_view view() const noexcept {
+        return string_view(data(), len_);
+    }
+
+    operator string_view() const noexcept {
+        return view();
+    }
+
+    // give access hints for the whole mapping (failures are ignored,
+    // as the hints do not affect the content)
+    void advise(unsigned adv) const noexcept {
+        if (!addr_) return;
+        if (adv & sequential) ::madvise(addr_, len_, MADV_SEQUENTIAL);
+        if (adv & random)     ::madvise(addr_, len_, MADV_RANDOM);
+        if (adv & willneed)   ::madvise(addr_, len_, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+        if (adv & hugepage)   ::madvise(addr_, len_, MADV_HUGEPAGE);
+#endif
+    }
+
+private:
+    void unmap_() noexcept {
+        if (addr_) ::munmap(addr_, len_);
+    }
+};
+
+#endif
+
+
+#ifdef CLUE_HAS_POSIX_IO
+
+namespace details {
+
+// an input iterator over the lines produced by a reader,
+// which provides bool next(string_view& line)
+template<class Reader>
+class line_input_iterator {
+public:
+    typedef string_view value_type;
+    typedef string_view reference;
+    typedef const string_view* pointer;
+    typedef std::ptrdiff_t difference_type;
+    typedef std::input_iterator_tag iterator_category;
+
+private:
+    Reader* r_;
+    string_view line_;
+
+public:
+    explicit line_input_iterator(Reader* r) : r_(r) {
+        next_();
+    }
+
+    bool operator==(const line_input_iterator& other) const noexcept {
+        return r_ == other.r_;
+    }
+
+    bool operator!=(const line_input_iterator& other) const noexcept {
+        return r_ != other.r_;
+    }
+
+    string_view operator* () const noexcept {
+        return line_;
+    }
+
+    const string_view* operator->() const noexcept {
+        return &line_;
+    }
+
+    line_input_iterator& operator++() {
+        next_();
+        return *this;
+    }
+
+private:
+    void next_() {
+        if (r_ && !r_->next(line_)) r_ = nullptr;
+    }
+};
+
+} // end namespace details
+
+
+// Read the lines of a file through a reusable fixed-size buffer, with
+// read(2), so that the memory use does not depend on the file size.
+//
+// A line that spans the boundary of two chunks is carried forward to
+// the front of the buffer before reading the next chunk. The buffer
+// grows only when a single line does not fit in half of it.
+//
+// Like line_stream, each line includes its delimiter '\n' (except
+// possibly the last one). A line is valid until the next one is read.
+
+class file_line_reader {
+public:
+    static constexpr size_t default_buffer_size = 1024 * 1024;
+
+    // the alignment of the buffer, file offsets and read sizes,
+    // as required by O_DIRECT
+    static constexpr size_t io_align = 4096;
+
+    using iterator = details::line_input_iterator<file_line_reader>;
+
+private:
+    int fd_;
+    bool direct_;
+    bool eof_;
+    char* buf_;
+    size_t cap_;
+    size_t beg_;    // the start of the pending data
+    size_t scan_;   // [beg_, scan_) has been scanned, without '\n'
+    size_t end_;    // the end of the data read
+
+public:
+    // bufsize: the size of the buffer (rounded up to a multiple of io_align)
+    // direct:  whether to bypass the page cache with O_DIRECT, which is
+    //          ignored where it is unsupported (by the OS or the file system)
+    explicit file_line_reader(const std::string& filename,
+                              size_t bufsize = default_buffer_size,
+                              bool direct = false)
+        : fd_(-1), direct_(false), eof_(false), buf_(nullptr)
+        , cap_(round_up_(bufsize > 0 ? bufsize : 1))
+        , beg_(0), scan_(0), end_(0) {
+#ifdef O_DIRECT
+        if (direct) {
+            fd_ = ::open(filename.c_str(), O_RDONLY | O_DIRECT);
+            direct_ = fd_ >= 0;
+        }
+#else
+        (void)direct;
+#endif
+        if (fd_ < 0) fd_ = ::open(filename.c_str(), O_RDONLY);
+        if (fd_ < 0) throw
+            std::runtime_error(std::string("Failed to open file ") + filename);
+#ifdef POSIX_FADV_SEQUENTIAL
+        if (!direct_) ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        try {
+            buf_ = static_cast<char*>(aligned_alloc(cap_, io_align));
+        } catch (...) {
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    file_line_reader(const file_line_reader&) = delete;
+    file_line_reader& operator=(const file_line_reader&) = delete;
+
+    ~file_line_reader() {
+        aligned_free(buf_);
+        ::close(fd_);
+    }
+
+public:
+    // whether the file is read with O_DIRECT
+    bool direct() const noexcept {
+        return direct_;
+    }
+
+    // the current size of the buffer
+    size_t buffer_size() const noexcept {
+        return cap_;
+    }
+
+    // read the next line, returning false at the end of the file
+    bool next(string_view& line) {
+        for(;;) {
+            const char* p = find_byte(buf_ + scan_, end_ - scan_, '\n');
+            if (p) {
+                size_t e = static_cast<size_t>(p - buf_) + 1;
+                line = string_view(buf_ + beg_, e - beg_);
+                beg_ = scan_ = e;
+                return true;
+            }
+            scan_ = end_;
+            if (eof_) {
+                if (beg_ == end_) return false;
+                line = string_view(buf_ + beg_, end_ - beg_);
+                beg_ = end_;
+                return true;
+            }
+            fill_();
+        }
+    }
+
+    iterator begin() {
+        return iterator(this);
+    }
+
+    iterator end() {
+        return iterator(nullptr);
+    }
+
+private:
+    static size_t round_up_(size_t n) noexcept {
+        return (n + (io_align - 1)) & ~(io_align - 1);
+    }
+
+    // move the pending data to the front, and read the next chunk after it
+    void fill_() {
+        const size_t tail = end_ - beg_;
+        if (tail > cap_ / 2 || (direct_ && round_up_(tail) == cap_))
+            grow_(round_up_(tail) * 2);
+
+        // with O_DIRECT, reads must start at an aligned address,
+        // so the pending data is placed to end at one
+        const size_t off = direct_ ? round_up_(tail) - tail : 0;
+        if (beg_ != off) {
+            std::memmove(buf_ + off, buf_ + beg_, tail);
+            scan_ = scan_ - beg_ + off;
+            beg_ = off;
+            end_ = off + tail;
+        }
+
+        size_t n = cap_ - end_;
+        if (direct_) n &= ~(io_align - 1);
+        ssize_t r;
+        do {
+            r = ::read(fd_, buf_ + end_, n);
+        } while (r < 0 && errno == EINTR);
+        if (r < 0) throw std::runtime_error("Failed to read file.");
+        if (r == 0) eof_ = true;
+        end_ += static_cast<size_t>(r);
+    }
+
+    void grow_(size_t c) {
+        char* nb = static_cast<char*>(aligned_alloc(c, io_align));
+        std::memcpy(nb + beg_, buf_ + beg_, end_ - beg_);
+        aligned_free(buf_);
+        buf_ = nb;
+        cap_ = c;
+    }
+};
+
+#endif
+
+
 // turn a multiline string to a stream of lines
 
 class line_stream {
@@ -81,14 +424,10 @@ public:
         void next_() noexcept {
             if (beg_ < len_) {
                 beg_ = end_;
-                while (end_ < len_ && !is_line_delim(end_)) end_++;
-                if (end_ < len_) end_++;
+                const char* p = find_byte(text_ + end_, len_ - end_, '\n');
+                end_ = p ? static_cast<size_t>(p - text_) + 1 : len_;
             }
         }
-
-        bool is_line_delim(size_t i) const noexcept {
-            return text_[i] == '\n';
-        }
     };
 
     typedef iterator const_iterator;
@@ -107,6 +446,15 @@ public:
     explicit line_stream(const std::string& str)
         : text_(str.c_str()), len_(str.size()) {}
 
+    explicit line_stream(string_view sv)
+        : text_(sv.data()), len_(sv.size()) {}
+
+#ifdef CLUE_HAS_MMAP
+    // the mapped file must outlive the stream
+    explicit line_stream(const mapped_file& f)
+        : text_(f.data()), len_(f.size()) {}
+#endif
+
     iterator begin() const {
         iterator it(text_, len_, 0, 0);
         return ++it;
@@ -126,6 +474,29 @@ public:
 };
 
 
+// the offsets of the beginnings of all lines in a text, in one pass
+// (line i spans [offsets[i], offsets[i+1]), or to the end of the text
+// for the last line; the lines are the same as those of line_stream)
+
+inline void line_offsets(string_view text, fast_vector<uint32_t>& offsets) {
+    const size_t n = text.size();
+    if (n > static_cast<size_t>(UINT32_MAX)) throw
+        std::length_error("line_offsets: the text is too long for 32-bit offsets.");
+    offsets.clear();
+    if (n == 0) return;
+    offsets.push_back(0);
+    foreach_byte(text.data(), n, '\n', [&offsets](size_t i) {
+        offsets.push_back(static_cast<uint32_t>(i + 1));
+    });
+    if (offsets.back() == n) offsets.pop_back();
+}
+
+inline fast_vector<uint32_t> line_offsets(string_view text) {
+    fast_vector<uint32_t> offsets;
+    line_offsets(text, offsets);
+    return offsets;
+}
+
 }
 
 #endif
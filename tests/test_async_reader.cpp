@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <clue/async_reader.hpp>
+#include <clue/sformat.hpp>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef CLUE_HAS_POSIX_IO
+
+using namespace clue;
+
+std::string write_test_file(const std::string& text) {
+    std::string fname = sstr("/tmp/clue_test_async_", time(NULL), ".txt");
+    std::ofstream out(fname, std::ios::binary);
+    out << text;
+    return fname;
+}
+
+std::string make_text() {
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        text += sstr("line ", i, ' ', std::string((i * 37) % 200, 'a' + i % 26));
+        if (i % 1000 == 5) text += std::string(30000, 'z');
+        text += '\n';
+    }
+    text += "last";
+    return text;
+}
+
+TEST(AsyncReader, Blocks) {
+    std::string text = make_text();
+    std::string fname = write_test_file(text);
+
+    for (size_t bsize: {100, 4096, 10000, 1 << 20}) {
+        for (size_t nbufs: {2, 3}) {
+            async_file_reader rdr(fname, bsize, nbufs);
+            ASSERT_EQ(bsize, rdr.block_size());
+            ASSERT_EQ(nbufs, rdr.num_buffers());
+
+            std::string s;
+            async_file_reader::block b;
+            while (rdr.next(b)) {
+                ASSERT_EQ(s.size(), b.offset());
+                ASSERT_LE(b.size(), bsize);
+                s.append(b.data(), b.size());
+            }
+            ASSERT_TRUE(b.empty());
+            ASSERT_FALSE(rdr.next(b));
+            ASSERT_EQ(text, s);
+        }
+    }
+
+    // holding a block while reading the next one, and moving blocks
+    {
+        async_file_reader rdr(fname, 4096, 3);
+        async_file_reader::block b1, b2;
+        ASSERT_TRUE(rdr.next(b1));
+        ASSERT_TRUE(rdr.next(b2));
+        ASSERT_EQ(text.substr(0, 4096), b1.view());
+        ASSERT_EQ(text.substr(4096, 4096), b2.view());
+        async_file_reader::block b3(std::move(b1));
+        ASSERT_TRUE(b1.empty());
+        ASSERT_EQ(0, b3.offset());
+        b3.release();
+        ASSERT_TRUE(rdr.next(b1));
+        ASSERT_EQ(8192, b1.offset());
+    }
+
+    // destroying the reader before the end
+    {
+        async_file_reader rdr(fname, 4096, 2);
+        async_file_reader::block b;
+        ASSERT_TRUE(rdr.next(b));
+    }
+
+    std::remove(fname.c_str());
+    ASSERT_THROW(async_file_reader{fname}, std::runtime_error);
+    ASSERT_THROW(async_file_reader(fname, 4096, 1), std::invalid_argument);
+}
+
+TEST(AsyncReader, Lines) {
+    std::string text = make_text();
+    std::string fname = write_test_file(text);
+
+    line_stream ls(text);
+    std::vector<std::string> expected(ls.begin(), ls.end());
+    ASSERT_EQ(3001, expected.size());
+
+    for (size_t bsize: {100, 4096, 1 << 20}) {
+        async_line_reader rdr(fname, bsize);
+        std::vector<std::string> lines;
+        for (string_view line: rdr) lines.push_back(line.to_string());
+        ASSERT_EQ(expected, lines);
+    }
+
+    // an empty file
+    std::ofstream(fname).close();
+    {
+        async_line_reader rdr(fname);
+        string_view line;
+        ASSERT_FALSE(rdr.next(line));
+    }
+    std::remove(fname.c_str());
+}
+
+#endif
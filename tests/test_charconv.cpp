@@ -0,0 +1,341 @@
+#include <gtest/gtest.h>
+#include <clue/charconv.hpp>
+#include <clue/stringex.hpp>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace clue;
+
+template<typename T>
+void test_int(const char* s, std::errc ec, size_t nused, T expect) {
+    T x = static_cast<T>(7);
+    from_chars_result r = from_chars(s, s + std::strlen(s), x);
+    ASSERT_TRUE(ec == r.ec) << s;
+    ASSERT_EQ(s + nused, r.ptr) << s;
+    ASSERT_EQ(ec == std::errc() ? expect : static_cast<T>(7), x) << s;
+}
+
+TEST(CharConv, Integers) {
+    const std::errc ok = std::errc();
+    const std::errc inv = std::errc::invalid_argument;
+    const std::errc oor = std::errc::result_out_of_range;
+
+    test_int<int>("0", ok, 1, 0);
+    test_int<int>("123", ok, 3, 123);
+    test_int<int>("-123", ok, 4, -123);
+    test_int<int>("000123", ok, 6, 123);
+    test_int<int>("12a", ok, 2, 12);
+    test_int<int>("2147483647", ok, 10, 2147483647);
+    test_int<int>("-2147483648", ok, 11, std::numeric_limits<int>::min());
+    test_int<int>("2147483648", oor, 10, 0);
+    test_int<int>("-2147483649", oor, 11, 0);
+    test_int<int>("", inv, 0, 0);
+    test_int<int>("-", inv, 0, 0);
+    test_int<int>("+1", inv, 0, 0);
+    test_int<int>(" 1", inv, 0, 0);
+
+    test_int<unsigned>("-1", inv, 0, 0);
+    test_int<unsigned char>("255", ok, 3, 255);
+    test_int<unsigned char>("256", oor, 3, 0);
+    test_int<signed char>("-128", ok, 4, -128);
+
+    test_int<int64_t>("9223372036854775807", ok, 19, INT64_MAX);
+    test_int<int64_t>("-9223372036854775808", ok, 20, INT64_MIN);
+    test_int<int64_t>("9223372036854775808", oor, 19, 0);
+    test_int<uint64_t>("18446744073709551615", ok, 20, UINT64_MAX);
+    test_int<uint64_t>("18446744073709551616", oor, 20, 0);
+    test_int<uint64_t>("99999999999999999999999", oor, 23, 0);
+    test_int<uint64_t>("0000000000000000000000000001", ok, 28, 1);
+    test_int<uint64_t>("1234567812345678", ok, 16, 1234567812345678ULL);
+
+    // the digits are bounded by the range
+    const char* s = "12345678901234567890";
+    for (size_t n = 1; n <= 18; ++n) {
+        int64_t x = 0;
+        from_chars_result r = from_chars(s, s + n, x);
+        ASSERT_TRUE(r.ec == std::errc());
+        ASSERT_EQ(s + n, r.ptr);
+        ASSERT_EQ(std::strtoll(std::string(s, n).c_str(), nullptr, 10), x);
+    }
+
+    // other bases
+    int x = 0;
+    const char* h = "7fFfz";
+    ASSERT_TRUE(from_chars(h, h + 5, x, 16).ptr == h + 4);
+    ASSERT_EQ(0x7fff, x);
+    const char* b = "-1012";
+    ASSERT_TRUE(from_chars(b, b + 5, x, 2).ptr == b + 4);
+    ASSERT_EQ(-5, x);
+}
+
+TEST(CharConv, FloatsSpecial) {
+    double x = 7;
+    const char* s;
+
+    s = "1.5e3x";
+    ASSERT_EQ(s + 5, from_chars(s, s + 6, x).ptr);
+    ASSERT_EQ(1500.0, x);
+
+    s = "2e";       // the exponent is incomplete
+    ASSERT_EQ(s + 1, from_chars(s, s + 2, x).ptr);
+    ASSERT_EQ(2.0, x);
+
+    s = "-.5";
+    ASSERT_EQ(s + 3, from_chars(s, s + 3, x).ptr);
+    ASSERT_EQ(-0.5, x);
+
+    s = "5.";
+    ASSERT_EQ(s + 2, from_chars(s, s + 2, x).ptr);
+    ASSERT_EQ(5.0, x);
+
+    s = "-0";
+    from_chars(s, s + 2, x);
+    ASSERT_TRUE(x == 0 && std::signbit(x));
+
+    s = "Infinity";
+    ASSERT_EQ(s + 8, from_chars(s, s + 8, x).ptr);
+    ASSERT_TRUE(std::isinf(x) && x > 0);
+    s = "-inf";
+    ASSERT_EQ(s + 4, from_chars(s, s + 4, x).ptr);
+    ASSERT_TRUE(std::isinf(x) && x < 0);
+    s = "nan(123)";
+    ASSERT_EQ(s + 8, from_chars(s, s + 8, x).ptr);
+    ASSERT_TRUE(std::isnan(x));
+
+    x = 7;
+    for (const char* t: {"", ".", "-", "e5", "+1", " 1", "in"}) {
+        from_chars_result r = from_chars(t, t + std::strlen(t), x);
+        ASSERT_TRUE(r.ec == std::errc::invalid_argument) << t;
+        ASSERT_EQ(t, r.ptr);
+        ASSERT_EQ(7.0, x);
+    }
+    for (const char* t: {"1e400", "-1e400", "1e-400"}) {
+        from_chars_result r = from_chars(t, t + std::strlen(t), x);
+        ASSERT_TRUE(r.ec == std::errc::result_out_of_range) << t;
+        ASSERT_EQ(7.0, x);
+    }
+    float f = 7;
+    s = "1e39";
+    ASSERT_TRUE(from_chars(s, s + 4, f).ec == std::errc::result_out_of_range);
+}
+
+template<typename T>
+void check_float(const std::string& s) {
+    T expect = sizeof(T) == 4 ? static_cast<T>(std::strtof(s.c_str(), nullptr))
+                              : static_cast<T>(std::strtod(s.c_str(), nullptr));
+    T x = 0;
+    from_chars_result r = from_chars(s.data(), s.data() + s.size(), x);
+    if (std::isinf(expect) || (expect == 0 && s.find_first_of("123456789") < s.find_first_of("eE"))) {
+        ASSERT_TRUE(r.ec == std::errc::result_out_of_range) << s;
+    } else {
+        ASSERT_TRUE(r.ec == std::errc()) << s;
+        ASSERT_EQ(0, std::memcmp(&expect, &x, sizeof(T))) << s;
+    }
+}
+
+TEST(CharConv, FloatsRounding) {
+    // hard cases: halfway points, subnormals, boundaries, many digits
+    const char* hard[] = {
+        "0.1", "1e23", "9007199254740993", "9007199254740995",
+        "2.2250738585072011e-308", "2.2250738585072014e-308",
+        "4.9406564584124654e-324", "2.4703282292062327e-324",
+        "2.4703282292062328e-324", "1.7976931348623157e308",
+        "1.7976931348623158e308", "1.7976931348623159e308",
+        "123456789012345678901234567890",
+        "0.000000000000000000000000000001234567890123456789012",
+        "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124",
+        "1.00000000000000011102230246251565404236316680908203126",
+        "7.038531e-26", "3.4028235e38", "3.4028236e38",
+        "1.00000005960464477550", "1.4e-45", "7e-46", "8.589973e9"};
+    for (const char* s: hard) {
+        check_float<double>(s);
+        check_float<float>(s);
+    }
+
+    // random values, printed with random precisions
+    std::mt19937_64 rng(42);
+    char buf[64];
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t bits = rng();
+        double x;
+        std::memcpy(&x, &bits, 8);
+        if (std::isnan(x) || std::isinf(x)) continue;
+        std::snprintf(buf, sizeof(buf), "%.*g", static_cast<int>(rng() % 19) + 1, x);
+        check_float<double>(buf);
+        check_float<float>(buf);
+        std::snprintf(buf, sizeof(buf), "%llu.%llue%d",
+            static_cast<unsigned long long>(rng() % 100000),
+            static_cast<unsigned long long>(rng()), static_cast<int>(rng() % 80) - 40);
+        check_float<double>(buf);
+        check_float<float>(buf);
+    }
+}
+
+TEST(CharConv, TryParseBounded) {
+    // the characters beyond the view are not read
+    const char* s = "12345";
+    int x = 0;
+    ASSERT_TRUE(try_parse(string_view(s, 3), x));
+    ASSERT_EQ(123, x);
+    double y = 0;
+    ASSERT_TRUE(try_parse(string_view("1.25e3", 4), y));
+    ASSERT_EQ(1.25, y);
+    bool z = false;
+    ASSERT_TRUE(try_parse(string_view("truex", 4), z));
+    ASSERT_TRUE(z);
+
+    // prefixes, as strtol with base 0
+    ASSERT_TRUE(try_parse(" 0x1F ", x));
+    ASSERT_EQ(31, x);
+    ASSERT_TRUE(try_parse("-010", x));
+    ASSERT_EQ(-8, x);
+    ASSERT_TRUE(try_parse("+5", x));
+    ASSERT_EQ(5, x);
+    ASSERT_FALSE(try_parse("08", x));
+    ASSERT_FALSE(try_parse("0x", x));
+
+    // out of range
+    x = 1;
+    ASSERT_FALSE(try_parse("2147483648", x));
+    ASSERT_FALSE(try_parse("-2147483649", x));
+    ASSERT_EQ(1, x);
+    unsigned u = 1;
+    ASSERT_FALSE(try_parse("-1", u));
+    ASSERT_TRUE(try_parse("4294967295", u));
+    ASSERT_EQ(4294967295u, u);
+    ASSERT_FALSE(try_parse("1e999", y));
+
+    // floating point forms
+    ASSERT_TRUE(try_parse("+1.5", y));
+    ASSERT_EQ(1.5, y);
+    ASSERT_FALSE(try_parse("+-1.5", y));
+    ASSERT_TRUE(try_parse(" 0x1p4\n", y));
+    ASSERT_EQ(16.0, y);
+    ASSERT_TRUE(try_parse("-inf", y));
+    ASSERT_TRUE(std::isinf(y) && y < 0);
+    long double ld = 0;
+    ASSERT_TRUE(try_parse("2.5", ld));
+    ASSERT_EQ(2.5L, ld);
+
+    // the same under a locale with ',' as the decimal point (if installed)
+    const char* names[] = {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8"};
+    for (const char* name: names) {
+        if (!std::setlocale(LC_NUMERIC, name)) continue;
+        ASSERT_TRUE(try_parse("2.5", ld));
+        ASSERT_EQ(2.5L, ld);
+        ASSERT_TRUE(try_parse("0x1.8p1", y));
+        ASSERT_EQ(3.0, y);
+        std::setlocale(LC_NUMERIC, "C");
+        break;
+    }
+}
+
+template<typename T>
+std::string to_str(T x) {
+    char buf[64];
+    to_chars_result r = to_chars(buf, buf + sizeof(buf), x);
+    EXPECT_TRUE(r.ec == std::errc());
+    return std::string(buf, r.ptr);
+}
+
+TEST(CharConv, ToCharsIntegers) {
+    ASSERT_EQ("0", to_str(0));
+    ASSERT_EQ("-1", to_str(-1));
+    ASSERT_EQ("2147483647", to_str(std::numeric_limits<int>::max()));
+    ASSERT_EQ("-9223372036854775808", to_str(std::numeric_limits<int64_t>::min()));
+    ASSERT_EQ("18446744073709551615", to_str(std::numeric_limits<uint64_t>::max()));
+    ASSERT_EQ("-128", to_str(static_cast<signed char>(-128)));
+
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 10000; ++i) {
+        int64_t x = static_cast<int64_t>(rng()) >> (rng() % 64);
+        ASSERT_EQ(std::to_string(x), to_str(x));
+    }
+
+    char buf[64];
+    to_chars_result r = to_chars(buf, buf + 64, 255, 16);
+    ASSERT_EQ("ff", std::string(buf, r.ptr));
+    r = to_chars(buf, buf + 64, -5, 2);
+    ASSERT_EQ("-101", std::string(buf, r.ptr));
+
+    // insufficient room
+    r = to_chars(buf, buf + 3, 1234);
+    ASSERT_TRUE(r.ec == std::errc::value_too_large);
+    ASSERT_EQ(buf + 3, r.ptr);
+    r = to_chars(buf, buf + 4, -123);
+    ASSERT_TRUE(r.ec == std::errc());
+    ASSERT_EQ("-123", std::string(buf, r.ptr));
+}
+
+TEST(CharConv, ToCharsFloats) {
+    ASSERT_EQ("0", to_str(0.0));
+    ASSERT_EQ("-0", to_str(-0.0));
+    ASSERT_EQ("inf", to_str(std::numeric_limits<double>::infinity()));
+    ASSERT_EQ("-inf", to_str(-std::numeric_limits<float>::infinity()));
+    ASSERT_EQ("nan", to_str(std::numeric_limits<double>::quiet_NaN()));
+    ASSERT_EQ("0.1", to_str(0.1));
+    ASSERT_EQ("0.30000000000000004", to_str(0.1 + 0.2));
+    ASSERT_EQ("1234.5", to_str(1234.5));
+    ASSERT_EQ("123456789", to_str(123456789.0));
+    ASSERT_EQ("1e+15", to_str(1.0e15));
+    ASSERT_EQ("1e-05", to_str(1.0e-5));
+    ASSERT_EQ("0.001", to_str(1.0e-3));
+    ASSERT_EQ("1e+23", to_str(1.0e23));
+    ASSERT_EQ("9007199254740992", to_str(9007199254740992.0));
+    ASSERT_EQ("5e-324", to_str(std::numeric_limits<double>::denorm_min()));
+    ASSERT_EQ("1.7976931348623157e+308", to_str(std::numeric_limits<double>::max()));
+    ASSERT_EQ("2.2250738585072014e-308", to_str(std::numeric_limits<double>::min()));
+    ASSERT_EQ("0.1", to_str(0.1f));
+    ASSERT_EQ("0.33333334", to_str(1.0f / 3));
+    ASSERT_EQ("1e-45", to_str(std::numeric_limits<float>::denorm_min()));
+    ASSERT_EQ("3.4028235e+38", to_str(std::numeric_limits<float>::max()));
+
+    // insufficient room
+    char buf[4];
+    to_chars_result r = to_chars(buf, buf + 4, 0.125);
+    ASSERT_TRUE(r.ec == std::errc::value_too_large);
+    r = to_chars(buf, buf + 4, 0.5);
+    ASSERT_EQ("0.5", std::string(buf, r.ptr));
+
+    // random values read back exactly, and have no more digits than the
+    // shortest "%.*e" that reads back
+    std::mt19937_64 rng(42);
+    char ref[64];
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t bits = rng();
+        double x;
+        std::memcpy(&x, &bits, 8);
+        if (std::isnan(x) || std::isinf(x)) continue;
+        std::string s = to_str(x);
+        double y = std::strtod(s.c_str(), nullptr);
+        ASSERT_EQ(0, std::memcmp(&x, &y, 8)) << s;
+        int p = 1;
+        for (; p < 17; ++p) {
+            std::snprintf(ref, sizeof(ref), "%.*e", p - 1, x);
+            if (std::strtod(ref, nullptr) == x) break;
+        }
+        size_t b = s.find_first_of("123456789");
+        size_t e = std::min(s.find('e'), s.size());
+        if (s.find_first_of(".e") == std::string::npos) {
+            // an integer, whose trailing zeros are not significant
+            while (s[e - 1] == '0') --e;
+        }
+        size_t nd = e - b - (s.find('.') < e ? 1 : 0);
+        ASSERT_LE(nd, static_cast<size_t>(p)) << s;
+
+        float f;
+        uint32_t fbits = static_cast<uint32_t>(rng());
+        std::memcpy(&f, &fbits, 4);
+        if (std::isnan(f) || std::isinf(f)) continue;
+        s = to_str(f);
+        float g = std::strtof(s.c_str(), nullptr);
+        ASSERT_EQ(0, std::memcmp(&f, &g, 4)) << s;
+    }
+}
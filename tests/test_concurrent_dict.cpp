@@ -0,0 +1,172 @@
+#include <clue/concurrent_dict.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+using cdict = clue::concurrent_dict<std::string, int>;
+
+void test_basics() {
+    std::printf("testing basics ...\n");
+
+    cdict d(4);
+    assert(d.shard_count() == 4);
+    assert(d.empty());
+    assert(d.size() == 0);
+    assert(!d.find("a"));
+
+    assert(d.insert("a", 1));
+    assert(d.insert("b", 2));
+    assert(!d.insert("a", 10));
+    assert(d.size() == 2);
+    assert(*d.find("a") == 1);
+    assert(d.count("b") == 1);
+    assert(d.count("c") == 0);
+
+    assert(!d.insert_or_assign("a", 3));
+    assert(d.insert_or_assign("c", 4));
+    int v = 0;
+    assert(d.find("a", v) && v == 3);
+    assert(!d.find("x", v) && v == 3);
+
+    int seen = 0;
+    assert(d.visit("c", [&](const int& x){ seen = x; }));
+    assert(seen == 4);
+    assert(!d.visit("x", [&](const int& x){ seen = x; }));
+
+    d.update("c", [](int& x){ x += 10; });
+    d.update("d", [](int& x){ x += 5; });
+    assert(*d.find("c") == 14);
+    assert(*d.find("d") == 5);
+
+    assert(d.erase("b") == 1);
+    assert(d.erase("b") == 0);
+    assert(!d.contains("b"));
+    assert(d.size() == 3);
+
+    int sum = 0;
+    size_t cnt = 0;
+    d.for_each([&](const std::pair<std::string, int>& e){
+        sum += e.second;
+        ++cnt;
+    });
+    assert(cnt == 3);
+    assert(sum == 3 + 14 + 5);
+
+    auto s = d.snapshot();
+    std::sort(s.begin(), s.end());
+    assert(s.size() == 3);
+    assert(s[0].first == "a" && s[1].first == "c" && s[2].first == "d");
+
+    d.clear();
+    assert(d.empty());
+    assert(!d.find("a"));
+}
+
+void test_concurrent_insert(size_t nt) {
+    std::printf("testing concurrent_insert with %lu threads ...\n", nt);
+
+    clue::concurrent_dict<int, int> d;
+    const int N = 10000;
+
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < nt; ++t) {
+        writers.emplace_back([&d,t,N](){
+            for (int i = 0; i < N; ++i) {
+                int k = static_cast<int>(t) * N + i;
+                d.insert(k, k * 2);
+            }
+        });
+    }
+    for (size_t t = 0; t < nt; ++t) {
+        writers.at(t).join();
+    }
+
+    assert(d.size() == nt * N);
+    for (int k = 0; k < static_cast<int>(nt) * N; ++k) {
+        auto v = d.find(k);
+        assert(v && *v == k * 2);
+    }
+}
+
+void test_concurrent_update(size_t nt) {
+    std::printf("testing concurrent_update with %lu threads ...\n", nt);
+
+    clue::concurrent_dict<int, long> d;
+    const int N = 20000;
+    const int K = 100;
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < nt; ++t) {
+        workers.emplace_back([&d,N,K](){
+            for (int i = 0; i < N; ++i) {
+                d.update(i % K, [](long& x){ ++x; });
+            }
+        });
+    }
+    for (size_t t = 0; t < nt; ++t) {
+        workers.at(t).join();
+    }
+
+    assert(d.size() == (size_t)K);
+    long total = 0;
+    d.for_each([&](const std::pair<int, long>& e){
+        assert(e.second == (long)(nt * (N / K)));
+        total += e.second;
+    });
+    assert(total == (long)(nt * N));
+}
+
+void test_readers_and_writers(size_t nt) {
+    std::printf("testing readers_and_writers with %lu threads ...\n", nt);
+
+    // writers repeatedly assign k -> 3k and erase k; readers must
+    // only ever observe either nothing or 3k for key k
+    clue::concurrent_dict<int, int> d(8);
+    const int K = 512;
+    const int R = 20;
+
+    std::vector<std::thread> threads;
+    std::vector<int> bad(nt, 0);
+    for (size_t t = 0; t < nt; ++t) {
+        threads.emplace_back([&d,K,R](){
+            for (int r = 0; r < R; ++r) {
+                for (int k = 0; k < K; ++k) d.insert_or_assign(k, 3 * k);
+                for (int k = 0; k < K; k += 2) d.erase(k);
+            }
+        });
+        int& b = bad[t];
+        threads.emplace_back([&d,&b,K,R](){
+            for (int r = 0; r < R * 4; ++r) {
+                for (int k = 0; k < K; ++k) {
+                    auto v = d.find(k);
+                    if (v && *v != 3 * k) ++b;
+                }
+                d.for_each([&](const std::pair<int, int>& e){
+                    if (e.second != 3 * e.first) ++b;
+                });
+            }
+        });
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads.at(i).join();
+    }
+
+    for (size_t t = 0; t < nt; ++t) {
+        assert(bad[t] == 0);
+    }
+    for (int k = 0; k < K; ++k) {
+        assert(d.count(k) == (k % 2 == 0 ? 0u : 1u));
+    }
+}
+
+int main() {
+    size_t nt = 4;
+    test_basics();
+    test_concurrent_insert(nt);
+    test_concurrent_update(nt);
+    test_readers_and_writers(nt);
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <clue/csv.hpp>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+typedef std::vector<std::string> strs_t;
+
+std::vector<strs_t> read_all(string_view text, csv_format fmt = csv_format()) {
+    csv_reader rdr(text, fmt);
+    csv_row row;
+    std::vector<strs_t> rows;
+    while (rdr.next(row)) {
+        strs_t r;
+        for (size_t i = 0; i < row.size(); ++i) r.push_back(row.str(i));
+        rows.push_back(r);
+    }
+    return rows;
+}
+
+TEST(CSV, Simple) {
+    std::vector<strs_t> expected{
+        {"a", "b", "c"},
+        {"1", "", "3"},
+        {"", ""},
+        {"x"}
+    };
+    ASSERT_EQ(expected, read_all("a,b,c\n1,,3\n,\nx\n"));
+    ASSERT_EQ(expected, read_all("a,b,c\n1,,3\n,\nx"));
+    ASSERT_EQ(expected, read_all("a,b,c\r\n1,,3\r\n,\r\nx\r\n"));
+
+    // blank lines are skipped
+    ASSERT_EQ(expected, read_all("\na,b,c\n\n1,,3\n,\n\r\nx\n\n"));
+
+    ASSERT_EQ(0, read_all("").size());
+    ASSERT_EQ(0, read_all("\n\n").size());
+    ASSERT_EQ((std::vector<strs_t>{{"", ""}}), read_all(","));
+}
+
+TEST(CSV, Views) {
+    std::string text = "id,name\n1,\"a,b\"\n2,\"say \"\"hi\"\"\"\n";
+    csv_reader rdr(text);
+    csv_row row;
+
+    ASSERT_TRUE(rdr.next(row));
+    ASSERT_EQ(1, row.index_of("name"));
+    ASSERT_EQ(2, row.index_of("other"));
+
+    ASSERT_TRUE(rdr.next(row));
+    ASSERT_EQ(2, row.size());
+    ASSERT_EQ("a,b", row[1]);
+    ASSERT_FALSE(row.escaped(1));
+    // the fields refer to the text
+    ASSERT_EQ(text.data() + 11, row[1].data());
+
+    ASSERT_TRUE(rdr.next(row));
+    ASSERT_EQ("say \"\"hi\"\"", row[1]);
+    ASSERT_TRUE(row.escaped(1));
+    ASSERT_EQ("say \"hi\"", row.str(1));
+    ASSERT_THROW(row.at(2), std::out_of_range);
+
+    ASSERT_FALSE(rdr.next(row));
+    ASSERT_EQ(3, rdr.rows_read());
+}
+
+TEST(CSV, Quoting) {
+    std::vector<strs_t> expected{
+        {"multi\nline", "x"},
+        {"", "a\"b", "c,d\r\ne"},
+        {"end"}
+    };
+    ASSERT_EQ(expected, read_all(
+        "\"multi\nline\",x\n"
+        "\"\",\"a\"\"b\",\"c,d\r\ne\"\r\n"
+        "\"end\""));
+
+    // an empty quoted field is not a blank line
+    ASSERT_EQ((std::vector<strs_t>{{""}}), read_all("\"\"\n"));
+}
+
+TEST(CSV, LongRows) {
+    // fields and quoted sections across 64-byte blocks
+    std::string text;
+    std::vector<strs_t> expected;
+    for (int i = 0; i < 300; ++i) {
+        strs_t r;
+        for (int j = 0; j < i % 7 + 1; ++j) {
+            std::string f(static_cast<size_t>((i * 13 + j * 29) % 90), static_cast<char>('a' + j));
+            bool quoted = (i + j) % 3 == 0;
+            if (quoted && f.size() > 2) {
+                f[1] = ',';
+                f[2] = '\n';
+            }
+            if (j > 0) text += ',';
+            if (quoted) {
+                text += '"';
+                text += f;
+                text += '"';
+            } else {
+                text += f;
+            }
+            r.push_back(f);
+        }
+        if (r.size() == 1 && r[0].empty() && (i % 3) != 0) {
+            // a blank line
+        } else {
+            expected.push_back(r);
+        }
+        text += '\n';
+    }
+    ASSERT_EQ(expected, read_all(text));
+}
+
+TEST(CSV, TSV) {
+    std::vector<strs_t> expected{
+        {"a", "\"b\"", "c,d"},
+        {"1", "2", ""}
+    };
+    ASSERT_EQ(expected, read_all("a\t\"b\"\tc,d\n1\t2\t\n", csv_format::tsv()));
+    ASSERT_EQ((std::vector<strs_t>{{"a", "b"}}), read_all("a;b\n", csv_format(';')));
+    ASSERT_THROW(csv_reader("", csv_format('\n')), std::invalid_argument);
+}
+
+TEST(CSV, Columns) {
+    std::string text =
+        "id,name,score\n"
+        "1,alice,3.5\n"
+        "2,\"bob, jr\",4\n"
+        "3,\"c\"\"d\",-1.25\n";
+
+    csv_reader rdr(text);
+    csv_row header;
+    ASSERT_TRUE(rdr.next(header));
+
+    fast_vector<int> ids;
+    fast_vector<double> scores;
+    std::vector<std::string> names;
+    size_t n = read_csv_columns(rdr,
+        csv_column(0, ids),
+        csv_column(header.index_of("score"), scores),
+        csv_column(1, names));
+
+    ASSERT_EQ(3, n);
+    ASSERT_EQ((std::vector<int>{1, 2, 3}), std::vector<int>(ids.begin(), ids.end()));
+    ASSERT_EQ((std::vector<double>{3.5, 4.0, -1.25}),
+              std::vector<double>(scores.begin(), scores.end()));
+    ASSERT_EQ((strs_t{"alice", "bob, jr", "c\"d"}), names);
+
+    fast_vector<string_view> vs;
+    csv_reader r2("x\nyy\n");
+    read_csv_columns(r2, csv_column(0, vs));
+    ASSERT_EQ(2, vs.size());
+    ASSERT_EQ("yy", vs[1]);
+
+    // invalid values
+    csv_reader r3("1,2\n3,x\n");
+    fast_vector<int> a, b;
+    ASSERT_THROW(read_csv_columns(r3, csv_column(0, a), csv_column(1, b)), std::invalid_argument);
+    csv_reader r4("1,2\n3\n");
+    ASSERT_THROW(read_csv_columns(r4, csv_column(0, a), csv_column(1, b)), std::invalid_argument);
+}
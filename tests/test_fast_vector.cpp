@@ -1086,3 +1086,52 @@ TYPED_TEST(FastVectorsTest, Resize_and_Shrink) {
         ENSURE_CLEANUP;
     }
 }
+
+TEST(FastVectors, MemoryUsage) {
+    fast_vector<int, 4> a;
+    auto u0 = a.memory_usage();
+    ASSERT_EQ(0, u0.elements);
+    ASSERT_EQ(4 * sizeof(int), u0.slack);
+    ASSERT_EQ(0, u0.overhead);
+
+    a.assign({1, 2, 3});
+    auto u1 = a.memory_usage();
+    ASSERT_EQ(3 * sizeof(int), u1.elements);
+    ASSERT_EQ(1 * sizeof(int), u1.slack);
+    ASSERT_EQ(0, u1.index);
+
+    a.reserve(100);
+    auto u2 = a.memory_usage();
+    ASSERT_TRUE(a.use_dynamic());
+    ASSERT_EQ(3 * sizeof(int), u2.elements);
+    ASSERT_EQ((a.capacity() - 3) * sizeof(int), u2.slack);
+    ASSERT_GT(u2.overhead, 0);
+    ASSERT_EQ(u2.elements + u2.slack + u2.overhead, u2.total());
+}
+
+struct fvec_tag {};
+
+TEST(FastVectors, CountingAllocator) {
+    using stats = allocation_stats<fvec_tag>;
+    ASSERT_EQ(0, stats::live_bytes());
+    {
+        fast_vector<long, 2, true, counting_allocator<long, fvec_tag>> a{1, 2};
+        ASSERT_EQ(0, stats::live_bytes());
+
+        a.reserve(10);
+        size_t c1 = a.capacity();
+        ASSERT_EQ(c1 * sizeof(long), stats::live_bytes());
+        a.reserve(c1 * 4);
+        size_t c2 = a.capacity();
+        ASSERT_EQ(c2 * sizeof(long), stats::live_bytes());
+        ASSERT_EQ((c1 + c2) * sizeof(long), stats::peak_bytes());
+        a.shrink_to_fit();
+        ASSERT_EQ(2, a.size());
+        ASSERT_EQ(0, stats::live_bytes());
+    }
+    ASSERT_EQ(0, stats::live_bytes());
+    ASSERT_EQ(2, stats::num_allocations());
+
+    stats::reset_peak();
+    ASSERT_EQ(0, stats::peak_bytes());
+}
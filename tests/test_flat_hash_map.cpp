@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <clue/flat_hash_map.hpp>
+#include <clue/string_view.hpp>
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace clue;
+
+using std::string;
+using fhmap = flat_hash_map<string, int>;
+using entry = fhmap::value_type;
+
+template<class Map>
+std::map<string, int> to_stdmap(const Map& m) {
+    return std::map<string, int>(m.begin(), m.end());
+}
+
+TEST(FlatHashMap, Empty) {
+    fhmap m;
+
+    ASSERT_TRUE(m.empty());
+    ASSERT_EQ(0, m.size());
+    ASSERT_EQ(0, m.capacity());
+    ASSERT_TRUE(m.begin() == m.end());
+    ASSERT_TRUE(m.cbegin() == m.cend());
+
+    ASSERT_TRUE(m.find("a") == m.end());
+    ASSERT_EQ(0, m.count("a"));
+    ASSERT_THROW(m.at("a"), std::out_of_range);
+    ASSERT_EQ(0, m.erase("a"));
+
+    ASSERT_TRUE(m == fhmap());
+}
+
+void verify_fhmap(const fhmap& m) {
+    ASSERT_FALSE(m.empty());
+    ASSERT_EQ(3, m.size());
+
+    std::map<string, int> r{{"a", 1}, {"b", 3}, {"c", 2}};
+    ASSERT_EQ(r, to_stdmap(m));
+    ASSERT_EQ(3, std::distance(m.begin(), m.end()));
+
+    ASSERT_EQ(1, m.at("a"));
+    ASSERT_EQ(3, m.at("b"));
+    ASSERT_EQ(2, m.at("c"));
+    ASSERT_THROW(m.at("x"), std::out_of_range);
+
+    ASSERT_EQ(1, m.count("a"));
+    ASSERT_EQ(0, m.count("x"));
+    ASSERT_EQ((entry{"b", 3}), *m.find("b"));
+    ASSERT_TRUE(m.find("x") == m.end());
+}
+
+TEST(FlatHashMap, Insert) {
+    fhmap m;
+    auto r0 = m.insert(entry{"a", 1});
+    auto r1 = m.emplace("b", 3);
+    auto r2 = m.try_emplace("c", 2);
+    auto r3 = m.try_emplace("a", 10);
+    auto r4 = m.emplace("b", 30);
+
+    ASSERT_TRUE(r0.second);
+    ASSERT_TRUE(r1.second);
+    ASSERT_TRUE(r2.second);
+    ASSERT_FALSE(r3.second);
+    ASSERT_FALSE(r4.second);
+    ASSERT_EQ(1, r3.first->second);
+    ASSERT_EQ(3, r4.first->second);
+
+    verify_fhmap(m);
+}
+
+TEST(FlatHashMap, ConstructAndAssign) {
+    fhmap m{{"a", 1}, {"b", 3}, {"c", 2}, {"a", 5}};
+    verify_fhmap(m);
+
+    std::vector<entry> src{{"a", 1}, {"b", 3}, {"c", 2}};
+    fhmap m2(src.begin(), src.end());
+    verify_fhmap(m2);
+    ASSERT_TRUE(m == m2);
+
+    fhmap mc(m);
+    verify_fhmap(mc);
+
+    fhmap mm(std::move(mc));
+    verify_fhmap(mm);
+    ASSERT_TRUE(mc.empty());
+    ASSERT_TRUE(mc.find("a") == mc.end());
+
+    fhmap ma;
+    ma = m;
+    verify_fhmap(ma);
+    ma = {{"x", 0}};
+    ASSERT_EQ(1, ma.size());
+    ASSERT_TRUE(ma != m);
+
+    using std::swap;
+    swap(ma, mm);
+    verify_fhmap(ma);
+    ASSERT_EQ(0, mm.at("x"));
+}
+
+TEST(FlatHashMap, SqBrackets) {
+    fhmap m;
+    m["a"] = 10;
+    m["b"] = 3;
+    m["c"] = 2;
+    string a("a");
+    m[a] = 1;
+    verify_fhmap(m);
+}
+
+TEST(FlatHashMap, Erase) {
+    fhmap m{{"a", 1}, {"b", 3}, {"x", 0}, {"c", 2}};
+    ASSERT_EQ(1, m.erase("x"));
+    ASSERT_EQ(0, m.erase("x"));
+    verify_fhmap(m);
+
+    size_t n = 0;
+    for (auto it = m.begin(); it != m.end();) {
+        it = m.erase(it);
+        ++n;
+    }
+    ASSERT_EQ(3, n);
+    ASSERT_TRUE(m.empty());
+    ASSERT_TRUE(m.begin() == m.end());
+}
+
+TEST(FlatHashMap, ManyEntries) {
+    flat_hash_map<int, int> m;
+    const int n = 20000;
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(m.emplace(i * 7, i).second);
+    }
+    ASSERT_EQ(n, m.size());
+    ASSERT_LE(m.load_factor(), 0.875f);
+
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i, m.at(i * 7));
+    }
+    ASSERT_EQ(0, m.count(1));
+
+    // erase half, then re-insert: deleted slots are reclaimed
+    for (int i = 0; i < n; i += 2) {
+        ASSERT_EQ(1, m.erase(i * 7));
+    }
+    ASSERT_EQ(n / 2, m.size());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i % 2, static_cast<int>(m.count(i * 7)));
+    }
+    size_t cap = m.capacity();
+    for (int i = 0; i < n; i += 2) {
+        m[i * 7] = i;
+    }
+    ASSERT_EQ(n, m.size());
+    ASSERT_EQ(cap, m.capacity());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i, m.at(i * 7));
+    }
+}
+
+TEST(FlatHashMap, Reserve) {
+    flat_hash_map<int, int> m;
+    m.reserve(1000);
+    size_t cap = m.capacity();
+    ASSERT_GE(cap * 7, 1000 * 8);
+    for (int i = 0; i < 1000; ++i) m[i] = i;
+    ASSERT_EQ(cap, m.capacity());
+}
+
+TEST(FlatHashMap, HeterogeneousLookup) {
+    using smap = flat_hash_map<string, int, string_hash, string_equal_to>;
+    smap m{{"a", 1}, {"b", 3}, {"c", 2}};
+
+    string_view sv("xbx");
+    string_view b = sv.substr(1, 1);
+
+    ASSERT_EQ(3, m.at(b));
+    ASSERT_EQ(1, m.count(b));
+    ASSERT_EQ("b", m.find(b)->first);
+    ASSERT_EQ(m.end(), m.find(sv));
+    ASSERT_EQ(0, m.count(sv));
+    ASSERT_THROW(m.at(sv), std::out_of_range);
+    ASSERT_EQ(2, m.at("c"));
+
+    const smap& cm = m;
+    ASSERT_EQ(3, cm.find(b)->second);
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <clue/flat_map.hpp>
+#include <clue/string_view.hpp>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+using std::string;
+using fmap = flat_map<string, int>;
+using entry = fmap::value_type;
+
+TEST(FlatMap, Empty) {
+    fmap m;
+
+    ASSERT_TRUE(m.empty());
+    ASSERT_EQ(0, m.size());
+    ASSERT_TRUE(m.begin() == m.end());
+    ASSERT_TRUE(m.cbegin() == m.cend());
+
+    ASSERT_EQ(m.end(), m.find("a"));
+    ASSERT_EQ(0, m.count("a"));
+    ASSERT_THROW(m.at("a"), std::out_of_range);
+    ASSERT_EQ(m.end(), m.lower_bound("a"));
+    ASSERT_EQ(m.end(), m.upper_bound("a"));
+
+    ASSERT_TRUE(m == m);
+}
+
+void verify_fmap(const fmap& m) {
+    ASSERT_FALSE(m.empty());
+    ASSERT_EQ(3, m.size());
+
+    std::vector<entry> vref{{"a", 1}, {"b", 3}, {"c", 2}};
+    ASSERT_EQ(vref, std::vector<entry>(m.begin(), m.end()));
+
+    ASSERT_EQ(1, m.at("a"));
+    ASSERT_EQ(3, m.at("b"));
+    ASSERT_EQ(2, m.at("c"));
+    ASSERT_THROW(m.at("x"), std::out_of_range);
+
+    ASSERT_EQ(1, m.count("a"));
+    ASSERT_EQ(0, m.count("x"));
+
+    ASSERT_EQ((entry{"b", 3}), *m.find("b"));
+    ASSERT_EQ(m.end(), m.find("bb"));
+
+    ASSERT_EQ(m.begin(), m.lower_bound(""));
+    ASSERT_EQ(m.begin() + 1, m.lower_bound("b"));
+    ASSERT_EQ(m.begin() + 2, m.lower_bound("bb"));
+    ASSERT_EQ(m.begin() + 2, m.upper_bound("b"));
+    ASSERT_EQ(m.end(), m.upper_bound("c"));
+}
+
+TEST(FlatMap, ConstructFromRange) {
+    std::vector<entry> src{{"c", 2}, {"a", 1}, {"b", 3}, {"a", 5}, {"c", 7}};
+    fmap m(src.begin(), src.end());
+    verify_fmap(m);
+}
+
+TEST(FlatMap, ConstructFromSorted) {
+    std::vector<entry> src{{"a", 1}, {"b", 3}, {"c", 2}};
+    fmap m(sorted_unique, src.begin(), src.end());
+    verify_fmap(m);
+}
+
+TEST(FlatMap, ConstructFromInitList) {
+    fmap m{{"b", 3}, {"a", 1}, {"c", 2}, {"b", 4}};
+    verify_fmap(m);
+}
+
+TEST(FlatMap, Insert) {
+    fmap m;
+    auto r0 = m.insert(entry{"c", 2});
+    auto r1 = m.insert(entry{"a", 1});
+    auto r2 = m.emplace("b", 3);
+    auto r3 = m.try_emplace("a", 10);
+    auto r4 = m.emplace("c", 20);
+
+    ASSERT_TRUE(r0.second);
+    ASSERT_TRUE(r1.second);
+    ASSERT_TRUE(r2.second);
+    ASSERT_FALSE(r3.second);
+    ASSERT_FALSE(r4.second);
+    ASSERT_EQ("a", r3.first->first);
+    ASSERT_EQ("c", r4.first->first);
+
+    verify_fmap(m);
+}
+
+TEST(FlatMap, InsertRange) {
+    fmap m{{"b", 3}};
+    std::vector<entry> src{{"c", 2}, {"b", 30}, {"a", 1}, {"c", 20}};
+    m.insert(src.begin(), src.end());
+    verify_fmap(m);
+}
+
+TEST(FlatMap, SqBrackets) {
+    fmap m;
+    m["c"] = 2;
+    m["a"] = 10;
+    m["b"] = 3;
+    m["a"] = 1;
+    verify_fmap(m);
+}
+
+TEST(FlatMap, Erase) {
+    fmap m{{"a", 1}, {"b", 3}, {"x", 0}, {"c", 2}};
+    ASSERT_EQ(1, m.erase("x"));
+    ASSERT_EQ(0, m.erase("x"));
+    verify_fmap(m);
+
+    auto it = m.erase(m.find("a"));
+    ASSERT_EQ("b", it->first);
+    ASSERT_EQ(2, m.size());
+}
+
+TEST(FlatMap, HeterogeneousLookup) {
+    using smap = flat_map<string, int, string_less>;
+    smap m{{"a", 1}, {"b", 3}, {"c", 2}};
+
+    string_view sv("xbx");
+    string_view b = sv.substr(1, 1);
+
+    ASSERT_EQ(3, m.at(b));
+    ASSERT_EQ(1, m.count(b));
+    ASSERT_EQ(m.begin() + 1, m.find(b));
+    ASSERT_EQ(m.end(), m.find(sv));
+    ASSERT_EQ(m.begin() + 1, m.lower_bound(b));
+    ASSERT_EQ(m.begin() + 2, m.upper_bound(b));
+    ASSERT_EQ(2, m.at("c"));
+    ASSERT_THROW(m.at(sv), std::out_of_range);
+}
+
+TEST(FlatMap, LargeRandom) {
+    const int n = 1000;
+    std::vector<std::pair<int, int>> src;
+    for (int i = 0; i < n; ++i) {
+        int k = (i * 7919) % n;
+        src.emplace_back(k, i);
+        src.emplace_back(k, -1);
+    }
+
+    flat_map<int, int> m(src.begin(), src.end());
+    ASSERT_EQ(n, m.size());
+    for (int k = 0; k < n; ++k) {
+        auto it = m.find(k);
+        ASSERT_TRUE(it != m.end());
+        ASSERT_EQ(k, it->first);
+        ASSERT_GE(it->second, 0);
+        ASSERT_EQ(it, m.lower_bound(k));
+        ASSERT_EQ(it + 1, m.upper_bound(k));
+    }
+    ASSERT_EQ(m.end(), m.find(n));
+    ASSERT_EQ(m.end(), m.find(-1));
+}
+
+
+using fset = flat_set<string>;
+
+TEST(FlatSet, Empty) {
+    fset s;
+    ASSERT_TRUE(s.empty());
+    ASSERT_EQ(0, s.size());
+    ASSERT_TRUE(s.begin() == s.end());
+    ASSERT_EQ(s.end(), s.find("a"));
+    ASSERT_EQ(0, s.count("a"));
+}
+
+TEST(FlatSet, Basics) {
+    fset s{"c", "a", "b", "a"};
+    std::vector<string> vref{"a", "b", "c"};
+
+    ASSERT_EQ(3, s.size());
+    ASSERT_EQ(vref, std::vector<string>(s.begin(), s.end()));
+    ASSERT_EQ(1, s.count("b"));
+    ASSERT_EQ(0, s.count("x"));
+    ASSERT_EQ(s.begin() + 2, s.find("c"));
+
+    auto r0 = s.insert("b");
+    auto r1 = s.insert("bb");
+    ASSERT_FALSE(r0.second);
+    ASSERT_TRUE(r1.second);
+    ASSERT_EQ("bb", *r1.first);
+    ASSERT_EQ(4, s.size());
+
+    std::vector<string> more{"z", "a", "y", "z"};
+    s.insert(more.begin(), more.end());
+    std::vector<string> vref2{"a", "b", "bb", "c", "y", "z"};
+    ASSERT_EQ(vref2, std::vector<string>(s.begin(), s.end()));
+
+    ASSERT_EQ(1, s.erase("bb"));
+    ASSERT_EQ(5, s.size());
+}
+
+TEST(FlatSet, HeterogeneousLookup) {
+    flat_set<string, string_less> s{"abc", "xyz"};
+    string_view sv("--abc--", 7);
+    ASSERT_EQ(s.begin(), s.find(sv.substr(2, 3)));
+    ASSERT_EQ(s.end(), s.find(sv));
+    ASSERT_EQ(1, s.count(sv.substr(2, 3)));
+}
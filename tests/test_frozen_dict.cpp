@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <clue/frozen_dict.hpp>
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace clue;
+
+using std::string;
+using fdict = frozen_dict<string, int>;
+using entry = fdict::value_type;
+
+TEST(FrozenDict, Empty) {
+    fdict d;
+
+    ASSERT_TRUE(d.empty());
+    ASSERT_EQ(0, d.size());
+    ASSERT_TRUE(d.begin() == d.end());
+    ASSERT_EQ(d.end(), d.find("a"));
+    ASSERT_EQ(0, d.count("a"));
+    ASSERT_THROW(d.at("a"), std::out_of_range);
+
+    fdict d2({});
+    ASSERT_TRUE(d2.empty());
+    ASSERT_TRUE(d == d2);
+}
+
+void verify_fdict(const fdict& d) {
+    ASSERT_FALSE(d.empty());
+    ASSERT_EQ(3, d.size());
+
+    ASSERT_EQ(1, d.at("a"));
+    ASSERT_EQ(3, d.at("b"));
+    ASSERT_EQ(2, d.at("c"));
+    ASSERT_THROW(d.at("x"), std::out_of_range);
+
+    ASSERT_EQ(1, d.count("a"));
+    ASSERT_EQ(0, d.count("x"));
+    ASSERT_EQ((entry{"b", 3}), *d.find("b"));
+    ASSERT_EQ(d.end(), d.find("bb"));
+
+    std::map<string, int> m(d.begin(), d.end());
+    std::map<string, int> mref{{"a", 1}, {"b", 3}, {"c", 2}};
+    ASSERT_EQ(mref, m);
+}
+
+TEST(FrozenDict, ConstructFromInitList) {
+    fdict d{{"a", 1}, {"b", 3}, {"c", 2}, {"a", 10}};
+    verify_fdict(d);
+}
+
+TEST(FrozenDict, ConstructFromRange) {
+    std::vector<entry> src{{"c", 2}, {"a", 1}, {"b", 3}, {"c", 20}};
+    fdict d(src.begin(), src.end());
+    verify_fdict(d);
+
+    fdict d2{{"b", 3}, {"c", 2}, {"a", 1}};
+    ASSERT_TRUE(d == d2);
+    fdict d3{{"b", 3}, {"c", 2}, {"a", 0}};
+    ASSERT_TRUE(d != d3);
+}
+
+TEST(FrozenDict, ConstructFromOrderedDict) {
+    ordered_dict<string, int> od{{"a", 1}, {"x", 0}, {"b", 3}, {"c", 2}};
+    od.erase("x");
+    fdict d(od);
+    verify_fdict(d);
+}
+
+TEST(FrozenDict, ManyEntries) {
+    for (int n: {1, 2, 5, 100, 1000, 50000}) {
+        std::vector<std::pair<int, int>> src;
+        for (int i = 0; i < n; ++i) src.emplace_back(i * 37 - 1000, i);
+        frozen_dict<int, int> d(src.begin(), src.end());
+        ASSERT_EQ(n, d.size());
+        ASSERT_EQ(static_cast<size_t>((n + 3) / 4), d.bucket_count());
+        for (int i = 0; i < n; ++i) {
+            ASSERT_EQ(i, d.at(i * 37 - 1000));
+        }
+        ASSERT_EQ(0, d.count(1));
+        ASSERT_EQ(0, d.count(n * 37));
+    }
+}
+
+TEST(FrozenDict, StringKeys) {
+    const int n = 10000;
+    std::vector<entry> src;
+    for (int i = 0; i < n; ++i) src.emplace_back("key_" + std::to_string(i), i);
+    fdict d(src.begin(), src.end());
+    ASSERT_EQ(n, d.size());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i, d.at("key_" + std::to_string(i)));
+    }
+    ASSERT_EQ(0, d.count("key_" + std::to_string(n)));
+}
+
+struct bad_hash {
+    size_t operator()(const string& s) const {
+        return s.size();
+    }
+};
+
+TEST(FrozenDict, CollidingHashes) {
+    using bdict = frozen_dict<string, int, bad_hash>;
+    bdict d{{"a", 1}, {"ab", 2}, {"a", 3}};
+    ASSERT_EQ(2, d.size());
+    ASSERT_EQ(1, d.at("a"));
+    ASSERT_THROW((bdict{{"a", 1}, {"b", 2}}), std::invalid_argument);
+}
+
+TEST(FrozenDict, HeterogeneousLookup) {
+    frozen_dict<string, int, string_hash, string_equal_to> d{
+        {"a", 1}, {"b", 3}, {"c", 2}};
+
+    string_view sv("xbx");
+    ASSERT_EQ(3, d.at(sv.substr(1, 1)));
+    ASSERT_EQ(1, d.count(sv.substr(1, 1)));
+    ASSERT_EQ(d.end(), d.find(sv));
+    ASSERT_THROW(d.at(sv), std::out_of_range);
+}
+
+TEST(StaticDict, Basics) {
+    constexpr auto d = make_static_dict<int>({
+        {"red", 1}, {"green", 2}, {"blue", 3}, {"red", 4}});
+
+    static_assert(d.size() == 4, "static_dict: size");
+    static_assert(d.at("red") == 1, "static_dict: at");
+    static_assert(d.at("blue") == 3, "static_dict: at");
+    static_assert(d.count("green") == 1, "static_dict: count");
+    static_assert(d.count("gree") == 0, "static_dict: count");
+    static_assert(d.index_of("black") == 4, "static_dict: index_of");
+
+    ASSERT_EQ(2, d.at(string("green")));
+    ASSERT_EQ(2, d.at(string_view("--green--", 9).substr(2, 5)));
+    ASSERT_EQ(1, d.index_of(string("green")));
+    ASSERT_EQ(0, d.count(string("yellow")));
+    ASSERT_THROW(d.at("yellow"), std::out_of_range);
+
+    ASSERT_EQ("blue", d[2].key);
+    ASSERT_EQ(4, d.end() - d.begin());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <clue/hash.hpp>
+#include <clue/string_view.hpp>
+#include <string>
+#include <vector>
+#include <set>
+#include <tuple>
+#include <unordered_set>
+
+using namespace clue;
+
+TEST(Hash, HashBytes) {
+    std::string s(300, '\0');
+    for (size_t i = 0; i < s.size(); ++i) s[i] = static_cast<char>(i * 31 + 7);
+
+    // deterministic, and dependent on the length, the content and the seed
+    std::set<uint64_t> hs;
+    for (size_t n = 0; n <= s.size(); ++n) {
+        uint64_t h = hash_bytes(s.data(), n);
+        ASSERT_EQ(h, hash_bytes(s.data(), n));
+        ASSERT_NE(h, hash_bytes(s.data(), n, 1));
+        hs.insert(h);
+    }
+    ASSERT_EQ(s.size() + 1, hs.size());
+
+    // the same bytes at different addresses
+    std::string t = "xx" + s;
+    for (size_t n: {0, 1, 3, 4, 8, 15, 16, 17, 48, 49, 100, 300}) {
+        ASSERT_EQ(hash_bytes(s.data(), n), hash_bytes(t.data() + 2, n));
+    }
+}
+
+TEST(Hash, Avalanche) {
+    // flipping any single input bit flips about half of the output bits
+    for (size_t n: {1, 3, 4, 8, 12, 16, 24, 40, 64, 100}) {
+        std::vector<unsigned char> buf(n, 0x5a);
+        uint64_t h0 = hash_bytes(buf.data(), n);
+        size_t total = 0;
+        for (size_t i = 0; i < n * 8; ++i) {
+            buf[i / 8] ^= static_cast<unsigned char>(1u << (i % 8));
+            uint64_t h = hash_bytes(buf.data(), n);
+            buf[i / 8] ^= static_cast<unsigned char>(1u << (i % 8));
+            ASSERT_NE(h0, h);
+            total += __builtin_popcountll(h0 ^ h);
+        }
+        double avg = static_cast<double>(total) / (n * 8);
+        ASSERT_GT(avg, 24.0);
+        ASSERT_LT(avg, 40.0);
+    }
+}
+
+TEST(Hash, NoCollisions) {
+    std::unordered_set<uint64_t> hs;
+    const int n = 100000;
+    for (int i = 0; i < n; ++i) {
+        std::string k = "key_" + std::to_string(i);
+        hs.insert(hash_bytes(k.data(), k.size()));
+    }
+    ASSERT_EQ(static_cast<size_t>(n), hs.size());
+}
+
+TEST(Hash, HashSpan) {
+    std::vector<int> a{1, 2, 3, 4, 5};
+    ASSERT_EQ(hash_bytes(a.data(), a.size() * sizeof(int)), hash_span(a.data(), a.size()));
+    ASSERT_NE(hash_span(a.data(), 4), hash_span(a.data(), 5));
+    ASSERT_NE(hash_span(a.data(), 5, 0), hash_span(a.data(), 5, 1));
+}
+
+TEST(Hash, StringViews) {
+    std::string s("hello world");
+    string_view sv("--hello world--");
+    string_view sub = sv.substr(2, s.size());
+
+    std::hash<string_view> h;
+    ASSERT_EQ(h(sub), string_hash()(s));
+    ASSERT_EQ(h(sub), string_hash()(sub));
+    ASSERT_EQ(h(sub), hash_bytes(s.data(), s.size()));
+    ASSERT_NE(h(sub), h(sv));
+
+    std::wstring ws(L"abc");
+    ASSERT_EQ(std::hash<wstring_view>()(wstring_view(ws)), wstring_hash()(ws));
+
+    std::unordered_set<string_view> us{"a", "b", "c"};
+    ASSERT_EQ(1, us.count(string_view("xax").substr(1, 1)));
+    ASSERT_EQ(0, us.count("d"));
+}
+
+TEST(Hash, Combine) {
+    size_t s1 = 0, s2 = 0;
+    hash_combine(s1, 1);
+    hash_combine(s1, 2);
+    hash_combine(s2, 2);
+    hash_combine(s2, 1);
+    ASSERT_NE(s1, s2);
+    ASSERT_EQ(s1, hash_values(1, 2));
+    ASSERT_EQ(s2, hash_values(2, 1));
+    ASSERT_NE(hash_values(1), hash_values(1, 0));
+
+    tuple_hash th;
+    ASSERT_EQ(hash_values(1, std::string("a")), th(std::make_pair(1, std::string("a"))));
+    ASSERT_EQ(hash_values(1, 2.5, 'c'), th(std::make_tuple(1, 2.5, 'c')));
+    ASSERT_EQ(hash_values(), th(std::tuple<>()));
+
+    std::unordered_set<std::pair<int, int>, tuple_hash> ps;
+    for (int i = 0; i < 100; ++i) {
+        for (int j = 0; j < 100; ++j) ps.emplace(i, j);
+    }
+    ASSERT_EQ(10000, ps.size());
+    ASSERT_EQ(1, ps.count(std::make_pair(42, 17)));
+}
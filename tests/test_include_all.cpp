@@ -21,6 +21,8 @@ using clue::floats::is_nan;
 // memory
 using clue::aligned_alloc;
 using clue::aligned_free;
+using clue::memory_usage_info;
+using clue::counting_allocator;
 
 // array_view
 using clue::array_view;
@@ -28,6 +30,7 @@ using clue::array_view;
 // formatting
 using clue::cfmt;
 using clue::sstr;
+using clue::shortest;
 
 // meta
 using clue::meta::type_;
@@ -35,6 +38,10 @@ using clue::meta::type_;
 // meta_seq
 using clue::meta::seq_;
 
+// hash
+using clue::hash_bytes;
+using clue::hash_combine;
+
 // optional
 using clue::optional;
 
@@ -56,9 +63,35 @@ using clue::ordered_dict;
 // keyed_vector
 using clue::keyed_vector;
 
+// flat_map
+using clue::flat_map;
+using clue::flat_set;
+
+// flat_hash_map
+using clue::flat_hash_map;
+
+// frozen_dict
+using clue::frozen_dict;
+using clue::static_dict;
+
+// snapshot
+using clue::snapshot_view;
+using clue::save_snapshot;
+
 // stringex
 using clue::trim;
 using clue::foreach_token_of;
+using clue::split_into;
+using clue::split_select;
+using clue::try_parse;
+
+// charconv
+using clue::from_chars;
+using clue::to_chars;
+
+// symbol_table
+using clue::symbol_table;
+using clue::concurrent_symbol_table;
 
 // timing
 using clue::stop_watch;
@@ -76,6 +109,17 @@ using clue::string_view;
 // textio
 using clue::read_file_content;
 using clue::line_stream;
+using clue::mapped_file;
+using clue::file_line_reader;
+using clue::line_offsets;
+using clue::find_byte;
+using clue::text_writer;
+using clue::line_index;
+
+// csv
+using clue::csv_reader;
+using clue::read_csv_columns;
+using clue::parse_numbers;
 
 // type_name
 using clue::demangle;
@@ -89,12 +133,23 @@ using clue::shared_lock;
 // concurrent_queue
 using clue::concurrent_queue;
 
+// concurrent_dict
+using clue::concurrent_dict;
+
 // concurrent_counter
 using clue::concurrent_counter;
 
 // thread_pool
 using clue::thread_pool;
 
+// parallel_lines
+using clue::line_chunks;
+using clue::parallel_lines;
+
+// async_reader
+using clue::async_file_reader;
+using clue::async_line_reader;
+
 int main() {
     return 0;
 }
@@ -0,0 +1,15 @@
+// a second translation unit including <clue/clue.hpp>, which is linked
+// with test_include_all.cpp, to ensure that the headers define nothing
+// that breaks the one definition rule in a program of several units
+
+#include <clue/clue.hpp>
+
+// use a few components, so that their members are emitted in this unit
+int clue_include_all_tu2() {
+    clue::concurrent_dict<int, int> d;
+    d.insert(1, 2);
+    clue::symbol_table syms;
+    syms.intern("a");
+    return static_cast<int>(d.size() + syms.size()) +
+        static_cast<int>(clue::sstr(12).size());
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <clue/keyed_vector.hpp>
+#include <clue/flat_hash_map.hpp>
+#include <clue/string_view.hpp>
+#include <clue/thread_pool.hpp>
 #include <string>
 
 using namespace clue;
@@ -7,6 +10,8 @@ using namespace clue;
 using std::string;
 using val_t = std::pair<int, int>;
 using kvec_t = keyed_vector<val_t, string>;
+using fkvec_t = keyed_vector<val_t, string, std::hash<string>,
+                             std::allocator<val_t>, flat_hash_map>;
 
 TEST(KeyedVectors, Empty) {
     kvec_t s;
@@ -27,8 +32,9 @@ TEST(KeyedVectors, Empty) {
 }
 
 
-void verify_kvec(kvec_t& a) {
-    const kvec_t& a_c = a;
+template<class KV>
+void verify_kvec(KV& a) {
+    const KV& a_c = a;
 
     ASSERT_EQ(3, a.size());
     ASSERT_FALSE(a.empty());
@@ -80,7 +86,7 @@ void verify_kvec(kvec_t& a) {
     ASSERT_TRUE(a == a_c);
     ASSERT_TRUE(a_c == a);
     ASSERT_FALSE(a != a);
-    ASSERT_FALSE(a_c == kvec_t());
+    ASSERT_FALSE(a_c == KV());
 }
 
 
@@ -267,3 +273,143 @@ TEST(KeyedVectors, Clear) {
     ASSERT_EQ(0, a.size());
     ASSERT_TRUE(a.begin() == a.end());
 }
+
+TEST(KeyedVectors, FlatIndex) {
+    fkvec_t a;
+    ASSERT_TRUE(a.empty());
+    ASSERT_TRUE(a.find("a") == a.end());
+    ASSERT_THROW(a.by("a"), std::out_of_range);
+
+    a.reserve(3);
+    a.push_back("a", val_t{1, 10});
+    a.emplace_back("b", 3, 30);
+    a.push_back("c", val_t{2, 20});
+    ASSERT_THROW(a.push_back("a", val_t{0, 0}), std::invalid_argument);
+    verify_kvec(a);
+
+    fkvec_t ac(a);
+    verify_kvec(ac);
+
+    fkvec_t am(std::move(ac));
+    verify_kvec(am);
+    ASSERT_TRUE(ac.find("a") == ac.end());
+
+    a.clear();
+    ASSERT_TRUE(a.empty());
+    ASSERT_TRUE(a.find("a") == a.end());
+}
+
+TEST(KeyedVectors, FlatIndexMany) {
+    keyed_vector<int, int, std::hash<int>, std::allocator<int>, flat_hash_map> a;
+    const int n = 10000;
+    for (int i = 0; i < n; ++i) {
+        a.push_back(i * 3, i);
+    }
+    ASSERT_EQ(n, a.size());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i, a.by(i * 3));
+        ASSERT_EQ(a.begin() + i, a.find(i * 3));
+    }
+    ASSERT_TRUE(a.find(1) == a.end());
+    ASSERT_THROW(a.push_back(3, 0), std::invalid_argument);
+}
+
+TEST(KeyedVectors, HeterogeneousLookup) {
+    keyed_vector<int, string, string_hash, std::allocator<int>, flat_hash_map> a;
+    a.push_back("a", 1);
+    a.push_back("b", 3);
+    a.push_back("c", 2);
+    ASSERT_THROW(a.push_back("b", 0), std::invalid_argument);
+
+    string_view sv("xbx");
+    string_view b = sv.substr(1, 1);
+
+    ASSERT_EQ(3, a.by(b));
+    ASSERT_EQ(a.begin() + 1, a.find(b));
+    ASSERT_EQ(a.end(), a.find(sv));
+    ASSERT_THROW(a.by(sv), std::out_of_range);
+    ASSERT_EQ(2, a.by("c"));
+    ASSERT_EQ(1, a.by(string("a")));
+}
+
+TEST(KeyedVectors, BulkExtend) {
+    kvec_t a;
+    a.push_back("a", val_t{1, 10});
+
+    std::vector<std::pair<string, val_t>> src{
+        {"b", val_t{2, 20}}, {"x", val_t{0, 0}}, {"b", val_t{3, 30}}};
+    ASSERT_THROW(a.extend(src.begin(), src.end()), std::invalid_argument);
+    ASSERT_EQ(1, a.size());
+    ASSERT_TRUE(a.find("b") == a.end());
+    ASSERT_TRUE(a.find("x") == a.end());
+
+    src.pop_back();
+    src.emplace_back("a", val_t{3, 30});
+    ASSERT_THROW(a.extend(src.begin(), src.end()), std::invalid_argument);
+    ASSERT_EQ(1, a.size());
+    ASSERT_EQ(val_t(1, 10), a.by("a"));
+
+    src.pop_back();
+    src.emplace_back("c", val_t{3, 30});
+    a.extend(src.begin(), src.end());
+    ASSERT_EQ(4, a.size());
+    ASSERT_EQ(val_t(0, 0), a[2]);
+    ASSERT_EQ(val_t(3, 30), a.by("c"));
+}
+
+template<class KVec>
+void test_parallel_extend(size_t nthreads) {
+    const size_t n = 20000;
+    std::vector<std::pair<string, size_t>> src;
+    for (size_t i = 0; i < n; ++i) {
+        src.emplace_back(std::to_string(i * 7), i);
+    }
+
+    thread_pool pool(nthreads);
+    KVec a;
+    a.push_back("x", n);
+    a.extend(src.begin(), src.end(), pool);
+    ASSERT_EQ(n + 1, a.size());
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(i, a[i + 1]);
+        ASSERT_EQ(i, a.by(src[i].first));
+    }
+
+    src.emplace_back("7", 0);
+    KVec b;
+    ASSERT_THROW(b.extend(src.begin(), src.end(), pool), std::invalid_argument);
+    ASSERT_TRUE(b.empty());
+    ASSERT_TRUE(b.find("0") == b.end());
+    pool.wait_done();
+}
+
+TEST(KeyedVectors, ParallelExtend) {
+    using skvec_t = keyed_vector<size_t, string>;
+    using sfkvec_t = keyed_vector<size_t, string, std::hash<string>,
+                                  std::allocator<size_t>, flat_hash_map>;
+    test_parallel_extend<skvec_t>(1);
+    test_parallel_extend<skvec_t>(4);
+    test_parallel_extend<sfkvec_t>(1);
+    test_parallel_extend<sfkvec_t>(4);
+}
+
+TEST(KeyedVectors, MemoryUsage) {
+    kvec_t a;
+    ASSERT_EQ(0, a.memory_usage().elements);
+
+    a.reserve(20);
+    for (int i = 0; i < 10; ++i) a.push_back(std::to_string(i), val_t(i, i));
+    auto u = a.memory_usage();
+    ASSERT_EQ(10 * sizeof(val_t), u.elements);
+    ASSERT_EQ((a.capacity() - 10) * sizeof(val_t), u.slack);
+    ASSERT_GE(u.index, 10 * sizeof(std::pair<const string, size_t>));
+    ASSERT_GT(u.overhead, 0);
+
+    using fkvec_t = keyed_vector<val_t, string, std::hash<string>,
+                                 std::allocator<val_t>, flat_hash_map>;
+    fkvec_t b;
+    for (int i = 0; i < 10; ++i) b.push_back(std::to_string(i), val_t(i, i));
+    auto ub = b.memory_usage();
+    ASSERT_EQ(10 * sizeof(val_t), ub.elements);
+    ASSERT_GE(ub.index, 16 * (1 + sizeof(std::pair<string, size_t>)));
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <clue/line_index.hpp>
+#include <clue/sformat.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+std::string make_lines(size_t first, size_t n) {
+    std::string s;
+    for (size_t i = first; i < first + n; ++i) {
+        s += "line " + std::to_string(i) + std::string(i % 7, 'x') + "\n";
+    }
+    return s;
+}
+
+// the offsets of all lines, by a plain scan
+std::vector<uint64_t> all_offsets(const std::string& s) {
+    std::vector<uint64_t> r{0};
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '\n') r.push_back(i + 1);
+    }
+    return r;
+}
+
+void verify_index(const line_index& idx, const std::string& s) {
+    std::vector<uint64_t> offs = all_offsets(s);
+    const uint64_t nl = offs.size() - 1;
+    ASSERT_EQ(nl, idx.num_lines());
+    ASSERT_EQ(offs[nl], idx.indexed_size());
+    ASSERT_EQ(nl / idx.stride() + 1, idx.num_entries());
+    for (uint64_t n = 0; n <= nl; ++n) {
+        ASSERT_EQ(offs[n / idx.stride() * idx.stride()], idx.seek_offset(n));
+    }
+    ASSERT_THROW(idx.seek_offset(nl + 1), std::out_of_range);
+}
+
+TEST(LineIndex, Empty) {
+    line_index idx(4);
+    ASSERT_EQ(4, idx.stride());
+    ASSERT_EQ(0, idx.num_lines());
+    ASSERT_EQ(0, idx.indexed_size());
+    ASSERT_EQ(1, idx.num_entries());
+    ASSERT_EQ(0, idx.seek_offset(0));
+
+    idx.extend("");
+    ASSERT_EQ(0, idx.num_lines());
+    idx.extend("abc");      // an incomplete line
+    ASSERT_EQ(0, idx.num_lines());
+    ASSERT_EQ(0, idx.indexed_size());
+
+    ASSERT_THROW(line_index(0), std::invalid_argument);
+}
+
+TEST(LineIndex, Extend) {
+    for (size_t k: {1, 3, 16}) {
+        std::string s = make_lines(0, 100);
+        line_index idx(k);
+        idx.extend(s);
+        verify_index(idx, s);
+
+        // appending, including an incomplete line completed later
+        s += make_lines(100, 50) + "partial";
+        idx.extend(s);
+        verify_index(idx, s.substr(0, s.rfind('\n') + 1));
+        s += " line\n" + make_lines(150, 10);
+        idx.extend(s);
+        verify_index(idx, s);
+
+        // a text that does not extend the indexed one
+        std::string t = s;
+        t[t.size() - 3] = '?';
+        ASSERT_FALSE(idx.extended_by(t));
+        ASSERT_THROW(idx.extend(t), std::invalid_argument);
+        ASSERT_THROW(idx.extend(s.substr(0, 10)), std::invalid_argument);
+    }
+}
+
+TEST(LineIndex, ParallelExtend) {
+    std::string s = make_lines(0, 50000);
+    for (size_t nthreads: {0, 3}) {
+        thread_pool pool(nthreads);
+        line_index idx(100);
+        idx.extend(pool, s.substr(0, 123457));
+        idx.extend(pool, s);
+        pool.wait_done();
+        verify_index(idx, s);
+    }
+}
+
+TEST(LineIndex, SaveLoad) {
+    std::string s = make_lines(0, 1000);
+    line_index idx(10);
+    idx.extend(s);
+
+    std::stringstream ss;
+    idx.save(ss);
+    line_index idx2 = line_index::load(ss);
+    ASSERT_EQ(idx.stride(), idx2.stride());
+    ASSERT_TRUE(idx2.extended_by(s));
+    verify_index(idx2, s);
+
+    std::string bad = ss.str();
+    bad[0] = 'X';
+    std::istringstream in1(bad);
+    ASSERT_THROW(line_index::load(in1), std::invalid_argument);
+    std::istringstream in2(ss.str().substr(0, ss.str().size() - 1));
+    ASSERT_THROW(line_index::load(in2), std::invalid_argument);
+}
+
+#ifdef CLUE_HAS_MMAP
+
+TEST(LineIndex, ReaderAndUpdate) {
+    std::string tname = sstr("/tmp/clue_test_line_index_", time(NULL), ".txt");
+    std::string iname = tname + ".idx";
+    std::remove(iname.c_str());
+
+    std::string s = make_lines(0, 300);
+    {
+        std::ofstream out(tname, std::ios::binary);
+        out << s;
+    }
+    line_index idx = update_line_index(tname, iname, 8);
+    verify_index(idx, s);
+
+    // append, and read without updating the index file
+    {
+        std::ofstream out(tname, std::ios::binary | std::ios::app);
+        out << make_lines(300, 20) << "last";
+    }
+    s += make_lines(300, 20) + "last";
+    std::vector<uint64_t> offs = all_offsets(s);
+
+    indexed_line_reader rdr(tname, line_index::load(iname));
+    ASSERT_EQ(321, rdr.num_lines());
+    for (uint64_t n = 0; n < 320; ++n) {
+        ASSERT_EQ(string_view(s).substr(offs[n], offs[n + 1] - offs[n]), rdr.line(n));
+    }
+    ASSERT_EQ("last", rdr.line(320));
+    ASSERT_EQ(string_view(s).substr(offs[5], offs[20] - offs[5]), rdr.lines(5, 20));
+    ASSERT_EQ("", rdr.lines(7, 7));
+    ASSERT_EQ("", rdr.lines(321, 321));
+    ASSERT_EQ(s.size(), static_cast<size_t>(rdr.lines(321, 321).data() - rdr.text().data()));
+    ASSERT_EQ("last", rdr.lines(320, 321));
+    ASSERT_THROW(rdr.line(321), std::out_of_range);
+    ASSERT_THROW(rdr.lines(3, 2), std::out_of_range);
+
+    // incremental update, in parallel
+    thread_pool pool(2);
+    line_index idx2 = update_line_index(tname, iname, 8, &pool);
+    pool.wait_done();
+    verify_index(idx2, s.substr(0, s.rfind('\n') + 1));
+    verify_index(line_index::load(iname), s.substr(0, s.rfind('\n') + 1));
+
+    // a rewritten file is indexed anew
+    s = make_lines(1000, 30);
+    {
+        std::ofstream out(tname, std::ios::binary | std::ios::trunc);
+        out << s;
+    }
+    verify_index(update_line_index(tname, iname, 8), s);
+
+    std::remove(tname.c_str());
+    std::remove(iname.c_str());
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <clue/memscan.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+std::vector<size_t> naive_positions(const char* p, size_t n, char c) {
+    std::vector<size_t> r;
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] == c) r.push_back(i);
+    }
+    return r;
+}
+
+TEST(MemScan, Basics) {
+    const char* s = "a,b,,c";
+    ASSERT_EQ(s + 1, find_byte(s, 6, ','));
+    ASSERT_EQ(s + 5, find_byte(s, 6, 'c'));
+    ASSERT_TRUE(find_byte(s, 6, 'x') == nullptr);
+    ASSERT_TRUE(find_byte(s, 0, 'a') == nullptr);
+    ASSERT_EQ(3, count_byte(s, 6, ','));
+    ASSERT_EQ(0, count_byte(s, 0, ','));
+
+    // bytes with the highest bit set
+    std::string t(100, 'a');
+    t[77] = '\xff';
+    ASSERT_EQ(t.data() + 77, find_byte(t.data(), t.size(), '\xff'));
+}
+
+TEST(MemScan, Random) {
+    std::mt19937 rng(1234);
+    std::string buf(5000, '\0');
+    for (char& c: buf) c = static_cast<char>("ab\n,"[rng() % 4]);
+
+    // various lengths and alignments, across the vector widths
+    for (size_t off: {0, 1, 7, 15, 16, 31, 33}) {
+        for (size_t n: {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000, 4900}) {
+            const char* p = buf.data() + off;
+            for (char c: {'\n', ','}) {
+                std::vector<size_t> expected = naive_positions(p, n, c);
+                std::vector<size_t> r;
+                foreach_byte(p, n, c, [&r](size_t i){ r.push_back(i); });
+                ASSERT_EQ(expected, r);
+                ASSERT_EQ(expected.size(), count_byte(p, n, c));
+                const char* q = find_byte(p, n, c);
+                if (expected.empty()) {
+                    ASSERT_TRUE(q == nullptr);
+                } else {
+                    ASSERT_EQ(p + expected[0], q);
+                }
+            }
+        }
+    }
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <clue/ordered_dict.hpp>
+#include <clue/string_view.hpp>
+#include <clue/thread_pool.hpp>
 #include <string>
 
 using namespace clue;
@@ -272,3 +274,233 @@ TEST(OrderedDict, SqBrackets) {
 
     verify_odict(d);
 }
+
+TEST(OrderedDict, Erase) {
+    odict d{{"a", 1}, {"x", 0}, {"b", 3}, {"y", 0}, {"c", 2}};
+
+    ASSERT_EQ(1, d.erase("x"));
+    ASSERT_EQ(0, d.erase("x"));
+    ASSERT_EQ(4, d.size());
+    ASSERT_EQ(d.end(), d.find("x"));
+
+    auto it = d.erase(d.find("y"));
+    ASSERT_EQ("c", it->first);
+    verify_odict(d);
+
+    ASSERT_EQ((entry{"c", 2}), *std::prev(d.end()));
+
+    // re-inserting an erased key appends it at the end
+    d["x"] = 5;
+    ASSERT_EQ(4, d.size());
+    ASSERT_EQ((entry{"x", 5}), d.at_pos(3));
+    ASSERT_EQ((entry{"x", 5}), *std::prev(d.end()));
+
+    odict d2{{"a", 1}, {"b", 3}, {"c", 2}, {"x", 5}};
+    ASSERT_TRUE(d == d2);
+
+    ASSERT_EQ(1, d.erase("a"));
+    ASSERT_EQ("b", d.begin()->first);
+    ASSERT_EQ(3, d.size());
+
+    d.compact();
+    std::vector<entry> vref{{"b", 3}, {"c", 2}, {"x", 5}};
+    ASSERT_EQ(vref, std::vector<entry>(d.begin(), d.end()));
+    ASSERT_EQ(5, d.at("x"));
+    ASSERT_EQ((entry{"c", 2}), d.at_pos(1));
+}
+
+TEST(OrderedDict, EraseWhileIterating) {
+    const int n = 1000;
+    ordered_dict<int, int> d;
+    for (int i = 0; i < n; ++i) d.emplace(i, i * 2);
+
+    // erase all odd keys, with automatic compaction along the way
+    for (auto it = d.begin(); it != d.end(); ) {
+        if (it->first % 2) {
+            it = d.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    ASSERT_EQ(n / 2, d.size());
+    int k = 0;
+    for (const auto& e: d) {
+        ASSERT_EQ(k, e.first);
+        ASSERT_EQ(k * 2, e.second);
+        k += 2;
+    }
+    ASSERT_EQ(n, k);
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i % 2 ? 0 : 1, d.count(i));
+    }
+
+    // erase everything by key, then refill
+    for (int i = 0; i < n; i += 2) {
+        ASSERT_EQ(1, d.erase(i));
+    }
+    ASSERT_TRUE(d.empty());
+    ASSERT_TRUE(d.begin() == d.end());
+
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(d.emplace(i, -i).second);
+        if (i % 3 == 0) d.erase(i);
+    }
+    ASSERT_EQ(n - (n + 2) / 3, d.size());
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i % 3 ? 1 : 0, d.count(i));
+    }
+    ASSERT_THROW(d.at_pos(d.size()), std::out_of_range);
+}
+
+TEST(OrderedDict, IteratorsSkipLaterErasures) {
+    // iterators obtained before the first erasure skip the entries
+    // erased afterwards (without compaction)
+    odict d{{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}};
+    auto it = d.begin();
+    auto cit = d.cend();
+    d.erase("b");
+    d.erase("c");
+
+    ASSERT_EQ("a", it->first);
+    ++it;
+    ASSERT_EQ("d", it->first);
+    --it;
+    ASSERT_EQ("a", it->first);
+    --cit;
+    ASSERT_EQ("d", cit->first);
+    --cit;
+    ASSERT_EQ("a", cit->first);
+}
+
+TEST(OrderedDict, ManyEntries) {
+    const int n = 5000;
+    ordered_dict<int, int> d;
+    for (int i = 0; i < n; ++i) {
+        auto r = d.emplace(i * 37, i);
+        ASSERT_TRUE(r.second);
+        ASSERT_EQ(i, r.first->second);
+    }
+    ASSERT_EQ(n, d.size());
+
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(i, d.at(i * 37));
+        ASSERT_EQ(1, d.count(i * 37));
+        ASSERT_EQ(i, d.at_pos(i).second);
+        ASSERT_FALSE(d.try_emplace(i * 37, -1).second);
+    }
+    ASSERT_EQ(0, d.count(1));
+    ASSERT_EQ(0, d.count(-37));
+
+    ordered_dict<int, int> dc(d);
+    ASSERT_TRUE(dc == d);
+    ASSERT_EQ(n - 1, dc.at((n - 1) * 37));
+}
+
+struct bad_hash {
+    size_t operator()(const string& s) const {
+        return s.size();
+    }
+};
+
+TEST(OrderedDict, CollidingHashes) {
+    ordered_dict<string, int, bad_hash> d;
+    d.reserve(100);
+    for (int i = 0; i < 100; ++i) {
+        d[std::to_string(i)] = i;
+    }
+    ASSERT_EQ(100, d.size());
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(i, d.at(std::to_string(i)));
+    }
+    ASSERT_EQ(d.end(), d.find("100"));
+    ASSERT_EQ(d.end(), d.find("x"));
+}
+
+TEST(OrderedDict, HeterogeneousLookup) {
+    using sdict = ordered_dict<string, int, string_hash, string_equal_to>;
+    sdict d{{"a", 1}, {"b", 3}, {"c", 2}};
+
+    string_view sv("xbx");
+    string_view b = sv.substr(1, 1);
+
+    ASSERT_EQ(3, d.at(b));
+    ASSERT_EQ(1, d.count(b));
+    ASSERT_EQ(std::next(d.begin()), d.find(b));
+    ASSERT_EQ(d.end(), d.find(sv));
+    ASSERT_EQ(0, d.count(sv));
+    ASSERT_THROW(d.at(sv), std::out_of_range);
+    ASSERT_EQ(2, d.at("c"));
+
+    const sdict& cd = d;
+    ASSERT_EQ(std::next(cd.begin()), cd.find(b));
+    ASSERT_EQ(3, cd.at(b));
+
+    d.at(b) = 30;
+    ASSERT_EQ(30, d.at("b"));
+}
+
+TEST(OrderedDict, ParallelInsert) {
+    const int n = 20000;
+    std::vector<std::pair<string, int>> src;
+    for (int i = 0; i < n; ++i) {
+        src.emplace_back(std::to_string(i % (n / 2)), i);
+    }
+
+    thread_pool pool(4);
+    odict d{{"x", -1}, {"7", -7}};
+    d.insert(src.begin(), src.end(), pool);
+    pool.wait_done();
+
+    ASSERT_EQ(n / 2 + 1, d.size());
+    ASSERT_EQ(-1, d.at("x"));
+    ASSERT_EQ(-7, d.at("7"));
+    ASSERT_EQ(0, d.at("0"));
+    ASSERT_EQ(n / 2 - 1, d.at(std::to_string(n / 2 - 1)));
+    ASSERT_EQ("8", d.at_pos(9).first);
+
+    odict d2{{"x", -1}, {"7", -7}};
+    d2.insert(src.begin(), src.end());
+    ASSERT_TRUE(d == d2);
+}
+
+TEST(OrderedDict, MemoryUsage) {
+    odict d;
+    ASSERT_EQ(0, d.memory_usage().total());
+
+    d.reserve(100);
+    for (int i = 0; i < 50; ++i) d[std::to_string(i)] = i;
+    auto u = d.memory_usage();
+    const size_t es = sizeof(entry);
+    ASSERT_EQ(50 * es, u.elements);
+    ASSERT_EQ(50 * es, u.slack);
+    // the index includes a dead flag per entry
+    ASSERT_GE(u.index, 100 * (sizeof(uint64_t) + 1));
+    ASSERT_GT(u.overhead, 0);
+
+    // erased entries count as slack until compaction
+    d.erase("1");
+    auto u2 = d.memory_usage();
+    ASSERT_EQ(49 * es, u2.elements);
+    ASSERT_EQ(51 * es, u2.slack);
+    ASSERT_EQ(u.index, u2.index);
+}
+
+struct odict_tag {};
+
+TEST(OrderedDict, CountingAllocator) {
+    using alloc_t = counting_allocator<std::pair<int, int>, odict_tag>;
+    using stats = allocation_stats<odict_tag>;
+    {
+        ordered_dict<int, int, std::hash<int>, std::equal_to<int>, alloc_t> d;
+        for (int i = 0; i < 1000; ++i) d[i] = i;
+        ASSERT_EQ(1000, d.size());
+
+        // both the entries and the index are attributed to the tag
+        auto u = d.memory_usage();
+        ASSERT_EQ(u.elements + u.slack + u.index, stats::live_bytes());
+        ASSERT_GE(stats::peak_bytes(), stats::live_bytes());
+    }
+    ASSERT_EQ(0, stats::live_bytes());
+    ASSERT_GT(stats::num_allocations(), 0);
+}
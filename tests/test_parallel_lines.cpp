@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <clue/parallel_lines.hpp>
+#include <clue/sformat.hpp>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+std::string make_text(size_t nlines) {
+    std::string text;
+    for (size_t i = 0; i < nlines; ++i) {
+        text += sstr("line ", i, ' ', std::string(i % 50, 'x'), '\n');
+    }
+    return text;
+}
+
+TEST(ParallelLines, LineChunks) {
+    std::string text = make_text(1000);
+    for (size_t n: {1, 2, 3, 7, 64, 5000}) {
+        std::vector<string_view> chunks = line_chunks(text, n);
+        ASSERT_LE(chunks.size(), n);
+        ASSERT_GE(chunks.size(), std::min(n, size_t(1000)) / 2);
+
+        // contiguous, covering the text, and aligned to lines
+        const char* p = text.data();
+        for (string_view c: chunks) {
+            ASSERT_EQ(p, c.data());
+            ASSERT_FALSE(c.empty());
+            ASSERT_EQ('\n', c.back());
+            p += c.size();
+        }
+        ASSERT_EQ(text.data() + text.size(), p);
+    }
+
+    // a line longer than a chunk, and no trailing newline
+    std::string t2 = std::string(100, 'a') + "\nb\nc";
+    std::vector<string_view> c2 = line_chunks(t2, 10);
+    ASSERT_EQ(2, c2.size());
+    ASSERT_EQ(101, c2[0].size());
+    ASSERT_EQ("b\nc", c2[1]);
+
+    ASSERT_EQ(0, line_chunks("", 4).size());
+}
+
+TEST(ParallelLines, Reduce) {
+    const size_t nlines = 50000;
+    std::string text = make_text(nlines);
+    thread_pool pool(4);
+
+    // count lines by their length, with a map per chunk
+    typedef std::map<size_t, size_t> hist_t;
+    hist_t h = parallel_lines(pool, text, hist_t(),
+        [](hist_t& s, string_view line) {
+            s[line.size()] += 1;
+        },
+        [](hist_t& r, hist_t&& s) {
+            for (const auto& e: s) r[e.first] += e.second;
+        });
+
+    hist_t expected;
+    for (string_view line: line_stream(text)) expected[line.size()] += 1;
+    ASSERT_EQ(expected, h);
+
+    // the results are merged in order
+    std::vector<std::string> firsts = parallel_lines(pool, text,
+        std::vector<std::string>(),
+        [](std::vector<std::string>& s, string_view line) {
+            s.push_back(line.to_string());
+        },
+        [](std::vector<std::string>& r, std::vector<std::string>&& s) {
+            r.insert(r.end(), s.begin(), s.end());
+        });
+    ASSERT_EQ(nlines, firsts.size());
+    ASSERT_EQ("line 0 \n", firsts[0]);
+    ASSERT_EQ(sstr("line ", nlines - 1, ' ', std::string((nlines - 1) % 50, 'x'), '\n'),
+              firsts.back());
+
+    // without reduction states
+    std::atomic<size_t> nbytes(0);
+    parallel_lines(pool, text, [&nbytes](string_view line) {
+        nbytes += line.size();
+    });
+    ASSERT_EQ(text.size(), nbytes.load());
+
+    // exceptions are propagated
+    ASSERT_THROW(parallel_lines(pool, text, [](string_view line) {
+        if (line.substr(0, 9) == "line 4242") throw std::runtime_error("bad line");
+    }), std::runtime_error);
+
+    // the pool remains usable
+    size_t n = parallel_lines(pool, text, size_t(0),
+        [](size_t& s, string_view) { ++s; },
+        [](size_t& r, size_t s) { r += s; });
+    ASSERT_EQ(nlines, n);
+
+    // bool states (updated concurrently, so they must not share bytes)
+    bool found = parallel_lines(pool, text, false,
+        [](bool& s, string_view line) { s = s || line.substr(0, 10) == "line 49999"; },
+        [](bool& r, bool s) { r = r || s; });
+    ASSERT_TRUE(found);
+
+    pool.wait_done();
+}
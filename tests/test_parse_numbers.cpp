@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <clue/parse_numbers.hpp>
+#include <clue/stringex.hpp>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace clue;
+
+// the numbers by tokenizing and try_parse
+template<typename T>
+std::vector<T> parse_by_tokens(const std::string& s, const char* delims) {
+    std::vector<T> r;
+    foreach_token_of(view(s), delims, [&](const char* p, size_t n) {
+        T x;
+        EXPECT_TRUE(try_parse(string_view(p, n), x));
+        r.push_back(x);
+        return true;
+    });
+    return r;
+}
+
+template<typename T, size_t S>
+std::vector<T> to_vec(const fast_vector<T, S>& v) {
+    return std::vector<T>(v.begin(), v.end());
+}
+
+TEST(ParseNumbers, Basics) {
+    fast_vector<int> xs;
+    parse_numbers_result r = parse_numbers("1,2, 3\n-4,,+5\n", ", \n", xs);
+    ASSERT_TRUE(r.ok());
+    ASSERT_EQ(5u, r.count);
+    ASSERT_EQ(14u, r.pos);
+    ASSERT_EQ((std::vector<int>{1, 2, 3, -4, 5}), to_vec(xs));
+
+    // values are appended
+    r = parse_numbers("  6 ", " ", xs);
+    ASSERT_TRUE(r.ok());
+    ASSERT_EQ(1u, r.count);
+    ASSERT_EQ(6u, xs.size());
+    ASSERT_EQ(6, xs[5]);
+
+    r = parse_numbers("", ",", xs);
+    ASSERT_TRUE(r.ok());
+    ASSERT_EQ(0u, r.count);
+
+    fast_vector<double> ys;
+    r = parse_numbers("0.5\t1e3\t-2.25\tinf", "\t", ys);
+    ASSERT_TRUE(r.ok());
+    ASSERT_EQ((std::vector<double>{0.5, 1000.0, -2.25, HUGE_VAL}), to_vec(ys));
+
+    // a token ending with the text at a block boundary
+    std::string s;
+    for (int i = 0; i < 8; ++i) s += "1234567,";
+    s.back() = '9';
+    fast_vector<long> zs;
+    r = parse_numbers(s, ",", zs);
+    ASSERT_TRUE(r.ok());
+    ASSERT_EQ(8u, zs.size());
+    ASSERT_EQ(12345679L, zs[7]);
+
+    ASSERT_THROW(parse_numbers("1", "", xs), std::invalid_argument);
+}
+
+TEST(ParseNumbers, Errors) {
+    fast_vector<int> xs;
+    parse_numbers_result r = parse_numbers("10,20,3x,40", ",", xs);
+    ASSERT_FALSE(r.ok());
+    ASSERT_TRUE(r.ec == std::errc::invalid_argument);
+    ASSERT_EQ(2u, r.count);
+    ASSERT_EQ(6u, r.pos);
+    ASSERT_EQ((std::vector<int>{10, 20}), to_vec(xs));
+
+    xs.clear();
+    r = parse_numbers("1 99999999999 2", " ", xs);
+    ASSERT_TRUE(r.ec == std::errc::result_out_of_range);
+    ASSERT_EQ(2u, r.pos);
+
+    fast_vector<unsigned> us;
+    r = parse_numbers("1 -2", " ", us);
+    ASSERT_TRUE(r.ec == std::errc::invalid_argument);
+    ASSERT_EQ(2u, r.pos);
+
+    r = parse_numbers("+ 1", " ", us);
+    ASSERT_EQ(0u, r.pos);
+    r = parse_numbers("+-1", " ", us);
+    ASSERT_EQ(0u, r.pos);
+}
+
+TEST(ParseNumbers, LongText) {
+    // many delimiters (beyond the SIMD path), and tokens across blocks
+    std::mt19937_64 rng(3);
+    std::string s;
+    const char* delims = " ,;:|\t\r\n/";
+    for (int i = 0; i < 20000; ++i) {
+        s += std::to_string(static_cast<long>(rng() % 2000000000) - 1000000000);
+        s += delims[rng() % 9];
+        if (rng() % 4 == 0) s += delims[rng() % 9];
+    }
+    fast_vector<long> xs;
+    parse_numbers_result r = parse_numbers(s, delims, xs);
+    ASSERT_TRUE(r.ok());
+    ASSERT_EQ(parse_by_tokens<long>(s, delims), to_vec(xs));
+
+    fast_vector<double> ys;
+    r = parse_numbers(s, ",;\n", ys);
+    ASSERT_FALSE(r.ok());
+    ASSERT_TRUE(ys.size() < 20000u);
+}
+
+TEST(ParseNumbers, Parallel) {
+    std::mt19937_64 rng(5);
+    std::string s;
+    char buf[32];
+    for (int i = 0; i < 200000; ++i) {
+        std::snprintf(buf, sizeof(buf), "%.6g", (rng() % 10000000) * 1.0e-3);
+        s += buf;
+        s += (i % 10 == 9) ? '\n' : ',';
+    }
+
+    thread_pool pool(4);
+    fast_vector<double> xs, ys;
+    parse_numbers_result r = parse_numbers(s, ",\n", xs);
+    parse_numbers_result rp = parse_numbers(pool, s, ",\n", ys);
+    ASSERT_TRUE(r.ok());
+    ASSERT_TRUE(rp.ok());
+    ASSERT_EQ(200000u, rp.count);
+    ASSERT_EQ(s.size(), rp.pos);
+    ASSERT_EQ(to_vec(xs), to_vec(ys));
+
+    // an error in the middle is reported at the same position
+    s[s.size() * 2 / 3] = 'x';
+    xs.clear();
+    ys.clear();
+    r = parse_numbers(s, ",\n", xs);
+    rp = parse_numbers(pool, s, ",\n", ys);
+    ASSERT_FALSE(rp.ok());
+    ASSERT_EQ(r.pos, rp.pos);
+    ASSERT_EQ(r.count, rp.count);
+    ASSERT_EQ(to_vec(xs), to_vec(ys));
+
+    pool.wait_done();
+}
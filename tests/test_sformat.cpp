@@ -1,12 +1,31 @@
 #include <clue/sformat.hpp>
 #include <gtest/gtest.h>
 
+struct thousands_punct : public std::numpunct<char> {
+    char do_thousands_sep() const { return ','; }
+    std::string do_grouping() const { return "\3"; }
+};
+
 TEST(SFormat, SStr) {
     using clue::sstr;
 
     ASSERT_EQ("", sstr());
     ASSERT_EQ("123", sstr(123));
     ASSERT_EQ("1 + 2 = 3", sstr(1, " + ", 2, " = ", 3));
+    ASSERT_EQ("-5:7:a", sstr(-5L, ':', 7u, ':', 'a'));
+    ASSERT_EQ("x", sstr(static_cast<unsigned char>('x')));
+
+    // stream formats are respected
+    std::ostringstream ss;
+    ss << std::hex;
+    clue::details::insert_to_stream(ss, 255, ' ', std::dec, 255);
+    ASSERT_EQ("ff 255", ss.str());
+
+    // so is the digit grouping of the locale
+    std::ostringstream gs;
+    gs.imbue(std::locale(gs.getloc(), new thousands_punct()));
+    clue::details::insert_to_stream(gs, 1234567, ' ', 12);
+    ASSERT_EQ("1,234,567 12", gs.str());
 }
 
 TEST(SFormat, Delims) {
@@ -19,6 +38,15 @@ TEST(SFormat, Delims) {
     ASSERT_EQ("1, 2, 3", sstr(delimits(xs1, ", ")));
 }
 
+TEST(SFormat, Shortest) {
+    using clue::shortest;
+
+    ASSERT_EQ("0.1", sstr(shortest(0.1)));
+    ASSERT_EQ("0.30000000000000004", sstr(shortest(0.1 + 0.2)));
+    ASSERT_EQ("1e+100", sstr(shortest(1.0e100)));
+    ASSERT_EQ("0.33333334", sstr(shortest(1.0f / 3)));
+}
+
 
 TEST(SFormat, CFmt) {
     using clue::cfmt;
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <clue/snapshot.hpp>
+#include <clue/flat_hash_map.hpp>
+#include <clue/sformat.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+using namespace clue;
+
+struct point3 {
+    double x, y, z;
+    int tag;
+};
+
+// copy the bytes into an 8-byte aligned buffer
+std::vector<uint64_t> to_buffer(const std::string& s) {
+    std::vector<uint64_t> buf((s.size() + 7) / 8 + 1, 0);
+    std::memcpy(buf.data(), s.data(), s.size());
+    return buf;
+}
+
+std::string save_to_string(const ordered_dict<std::string, point3>& d) {
+    std::ostringstream out;
+    save_snapshot(out, d);
+    return out.str();
+}
+
+TEST(Snapshot, Empty) {
+    ordered_dict<std::string, point3> d;
+    std::string s = save_to_string(d);
+    auto buf = to_buffer(s);
+
+    snapshot_view<point3> v(buf.data(), s.size());
+    ASSERT_TRUE(v.empty());
+    ASSERT_EQ(0, v.size());
+    ASSERT_EQ(0, v.count("a"));
+    ASSERT_TRUE(v.find("a") == nullptr);
+    ASSERT_THROW(v.at("a"), std::out_of_range);
+    ASSERT_EQ(0, v.values().size());
+}
+
+TEST(Snapshot, OrderedDict) {
+    ordered_dict<std::string, point3> d;
+    for (int i = 0; i < 1000; ++i) {
+        d[sstr("key-", i * 37)] = point3{i * 1.0, i * 2.0, i * 3.0, i};
+    }
+    d.erase("key-0");
+    d.erase("key-370");
+    ASSERT_EQ(998, d.size());
+
+    std::string s = save_to_string(d);
+    auto buf = to_buffer(s);
+    snapshot_view<point3> v(buf.data(), s.size());
+    ASSERT_EQ(d.size(), v.size());
+
+    size_t i = 0;
+    for (const auto& e: d) {
+        ASSERT_EQ(string_view(e.first), v.key(i));
+        ASSERT_EQ(e.second.tag, v.value(i).tag);
+        ASSERT_EQ(e.second.tag, v.values()[i].tag);
+
+        ASSERT_EQ(i, v.index_of(e.first));
+        const point3* p = v.find(e.first);
+        ASSERT_TRUE(p != nullptr);
+        ASSERT_EQ(e.second.x, p->x);
+        ASSERT_EQ(e.second.z, v.at(e.first).z);
+        ASSERT_EQ(1, v.count(e.first));
+        ++i;
+    }
+
+    ASSERT_EQ(0, v.count("key-0"));
+    ASSERT_EQ(0, v.count("key-370"));
+    ASSERT_EQ(0, v.count(""));
+    ASSERT_EQ(v.size(), v.index_of("key-1"));
+    ASSERT_THROW(v.at("key-1"), std::out_of_range);
+}
+
+TEST(Snapshot, KeyedVector) {
+    keyed_vector<int, std::string, string_hash,
+                 std::allocator<int>, flat_hash_map> a;
+    a.push_back("x", 10);
+    a.push_back("y", 20);
+    a.push_back("", 30);
+    a.push_back("zz", 40);
+
+    std::ostringstream out;
+    save_snapshot(out, a);
+    std::string s = out.str();
+    auto buf = to_buffer(s);
+
+    snapshot_view<int> v(buf.data(), s.size());
+    ASSERT_EQ(4, v.size());
+    std::vector<int> vals(v.values().begin(), v.values().end());
+    ASSERT_EQ((std::vector<int>{10, 20, 30, 40}), vals);
+    ASSERT_EQ("y", v.key(1));
+    ASSERT_EQ("", v.key(2));
+    ASSERT_EQ(30, v.at(""));
+    ASSERT_EQ(40, v.at("zz"));
+    ASSERT_EQ(0, v.count("z"));
+}
+
+TEST(Snapshot, Validation) {
+    ordered_dict<std::string, int> d{{"a", 1}, {"b", 2}};
+    std::ostringstream out;
+    save_snapshot(out, d);
+    std::string s = out.str();
+
+    auto buf = to_buffer(s);
+    ASSERT_NO_THROW(snapshot_view<int>(buf.data(), s.size()));
+
+    // truncated
+    ASSERT_THROW(snapshot_view<int>(buf.data(), s.size() - 1), std::invalid_argument);
+    ASSERT_THROW(snapshot_view<int>(buf.data(), 16), std::invalid_argument);
+
+    // mismatched value type
+    ASSERT_THROW(snapshot_view<double>(buf.data(), s.size()), std::invalid_argument);
+
+    // misaligned
+    std::vector<uint64_t> buf2(buf.size() + 1);
+    char* p = reinterpret_cast<char*>(buf2.data()) + 4;
+    std::memcpy(p, s.data(), s.size());
+    ASSERT_THROW(snapshot_view<int>(p, s.size()), std::invalid_argument);
+
+    // bad magic
+    std::string s2 = s;
+    s2[0] = 'X';
+    auto buf3 = to_buffer(s2);
+    ASSERT_THROW(snapshot_view<int>(buf3.data(), s2.size()), std::invalid_argument);
+}
+
+TEST(Snapshot, CraftedHeader) {
+    ordered_dict<std::string, point3> d;
+    d["a"] = point3{1.0, 2.0, 3.0, 1};
+    d["b"] = point3{4.0, 5.0, 6.0, 2};
+    std::string s = save_to_string(d);
+    details::snapshot_header hdr;
+    std::memcpy(&hdr, s.data(), sizeof(hdr));
+
+    // sizes that would wrap around when multiplied
+    details::snapshot_header h1 = hdr;
+    h1.count = uint64_t(1) << 60;
+    h1.index_cap = uint64_t(1) << 62;
+    std::string s1 = s;
+    std::memcpy(&s1[0], &h1, sizeof(h1));
+    auto buf1 = to_buffer(s1);
+    ASSERT_THROW(snapshot_view<point3>(buf1.data(), s1.size()), std::invalid_argument);
+
+    details::snapshot_header h2 = hdr;
+    h2.index_cap = 0;
+    std::string s2 = s;
+    std::memcpy(&s2[0], &h2, sizeof(h2));
+    auto buf2 = to_buffer(s2);
+    ASSERT_THROW(snapshot_view<point3>(buf2.data(), s2.size()), std::invalid_argument);
+
+    // an index with no empty slot, and slots out of range
+    std::string s3 = s;
+    for (uint64_t j = 0; j < hdr.index_cap; ++j) {
+        uint32_t v = j % 2 ? 1 : 1000;
+        std::memcpy(&s3[hdr.index_off + j * sizeof(uint32_t)], &v, sizeof(v));
+    }
+    auto buf3 = to_buffer(s3);
+    snapshot_view<point3> v3(buf3.data(), s3.size());
+    ASSERT_EQ(2, v3.size());
+    ASSERT_EQ(nullptr, v3.find("x"));
+
+    // keys beyond the string section
+    std::string s4 = s;
+    details::snapshot_entry e;
+    std::memcpy(&e, &s4[hdr.entries_off], sizeof(e));
+    e.key_off = hdr.strings_size;
+    std::memcpy(&s4[hdr.entries_off], &e, sizeof(e));
+    auto buf4 = to_buffer(s4);
+    snapshot_view<point3> v4(buf4.data(), s4.size());
+    ASSERT_EQ(nullptr, v4.find("a"));
+    ASSERT_EQ(4.0, v4.at("b").x);
+}
+
+#ifdef CLUE_HAS_MMAP
+
+TEST(Snapshot, MappedFile) {
+    ordered_dict<std::string, point3> d;
+    for (int i = 0; i < 100; ++i) {
+        d[sstr("p", i)] = point3{0.5 * i, 0.0, 1.0, i};
+    }
+
+    const char* fname = "test_snapshot.tmp";
+    save_snapshot(fname, d);
+
+    {
+        mapped_snapshot<point3> m(fname);
+        ASSERT_EQ(100, m.size());
+        ASSERT_EQ(42, m.at("p42").tag);
+        ASSERT_EQ(21.0, m.find("p42")->x);
+        ASSERT_EQ("p7", m.key(7));
+        ASSERT_TRUE(m.find("q") == nullptr);
+
+        mapped_snapshot<point3> m2(std::move(m));
+        ASSERT_EQ(0, m.size());
+        ASSERT_EQ(100, m2.size());
+        ASSERT_EQ(99, m2.at("p99").tag);
+    }
+
+    ASSERT_THROW(mapped_snapshot<int>{fname}, std::invalid_argument);
+    std::remove(fname);
+    ASSERT_THROW(mapped_snapshot<point3>{fname}, std::runtime_error);
+}
+
+#endif
@@ -175,6 +175,42 @@ TEST(StringView, Compare) {
     test_strview_compare(s1, s4);
 }
 
+TEST(StringView, MixedCompare) {
+    string_view sv("abcd");
+    std::string s("abcd");
+
+    ASSERT_TRUE(sv == s);
+    ASSERT_TRUE(s == sv);
+    ASSERT_TRUE(sv == "abcd");
+    ASSERT_TRUE("abcd" == sv);
+    ASSERT_TRUE(sv != "abc");
+    ASSERT_TRUE(sv < "abd");
+    ASSERT_TRUE("abd" > sv);
+    ASSERT_TRUE(sv <= s);
+    ASSERT_TRUE(s >= sv);
+}
+
+TEST(StringView, TransparentFunctors) {
+    std::string s("abcd");
+    string_view sv("--abcd--");
+    string_view sub = sv.substr(2, 4);
+
+    stdx::string_hash h;
+    ASSERT_EQ(h(s), h(sub));
+    ASSERT_EQ(h(s), h("abcd"));
+    ASSERT_NE(h(s), h(sv));
+    ASSERT_EQ(h(string_view()), h(""));
+
+    stdx::string_equal_to eq;
+    ASSERT_TRUE(eq(s, sub));
+    ASSERT_TRUE(eq("abcd", sub));
+    ASSERT_FALSE(eq(s, sv));
+
+    stdx::string_less lt;
+    ASSERT_TRUE(lt(sub, "abce"));
+    ASSERT_FALSE(lt(s, sub));
+}
+
 
 TEST(StringView, FindChars) {
 
@@ -252,6 +288,43 @@ TEST(StringView, RfindChars) {
 }
 
 
+TEST(StringView, FindCharSets) {
+    size_t npos = string_view::npos;
+
+    // bytes beyond 127, and '\0' within a set given with its length
+    const char buf[] = "ab\xff\x80 c\0d";
+    string_view s(buf, sizeof(buf) - 1);    // 8 characters
+    ASSERT_EQ(2,    s.find_first_of("\x80\xff"));
+    ASSERT_EQ(3,    s.find_last_of("\x80\xff"));
+    ASSERT_EQ(6,    s.find_first_of(string_view("\0", 1)));
+    ASSERT_EQ(4,    s.find_first_not_of(string_view("ab\x80\xff", 4)));
+    ASSERT_EQ(5,    s.find_last_not_of(string_view("d\0", 2)));
+    ASSERT_EQ(npos, s.find_first_of(""));
+    ASSERT_EQ(0,    s.find_first_not_of(""));
+
+    // a large set, compared with a linear scan
+    const char* delims = " \t\n\r,;:.!?()[]{}<>\"'|/\\-_=+*&^%$#@~`";
+    string_view ds(delims);
+    std::string text;
+    for (int i = 0; i < 1000; ++i) text.push_back(static_cast<char>((i * 37) % 127 + 1));
+    string_view t(text);
+    for (size_t pos = 0; pos < t.size(); pos += 13) {
+        size_t i = pos;
+        while (i < t.size() && ds.find(t[i]) == npos) ++i;
+        ASSERT_EQ(i < t.size() ? i : npos, t.find_first_of(delims, pos));
+        i = pos;
+        while (i < t.size() && ds.find(t[i]) != npos) ++i;
+        ASSERT_EQ(i < t.size() ? i : npos, t.find_first_not_of(ds, pos));
+    }
+
+    // wide characters
+    stdx::wstring_view ws(L"ab\u0101c\u0161");
+    ASSERT_EQ(2, ws.find_first_of(L"\u0161\u0101"));
+    ASSERT_EQ(4, ws.find_last_of(L"\u0161\u0101"));
+    ASSERT_EQ(3, ws.find_first_not_of(L"ab\u0101"));
+}
+
+
 TEST(StringView, FindSubstr) {
 
     string_view s("abcdabc");
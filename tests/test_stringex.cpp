@@ -322,4 +322,55 @@ TEST(StringEx, Tokenize) {
     clue::foreach_token_of(xstr, ";, ", f);
     std::vector<std::string> tks2{"abc", "xy", "uvw"};
     ASSERT_EQ(tks2, v);
+
+    // a large set of delimiters, including bytes beyond 127
+    v.clear();
+    clue::foreach_token_of(string_view("(a+b)*\xa0" "c / [d-e]"), " +-*/()[]{}\xa0", f);
+    std::vector<std::string> tks3{"a", "b", "c", "d", "e"};
+    ASSERT_EQ(tks3, v);
+}
+
+
+TEST(StringEx, SplitInto) {
+    using clue::split_into;
+    using clue::split_select;
+
+    clue::fast_vector<string_view> out;
+    ASSERT_EQ(4u, split_into(string_view(" abc ; xy, uvw ,z"), ";, ", out));
+    std::vector<string_view> tks0{"abc", "xy", "uvw", "z"};
+    ASSERT_EQ(tks0, std::vector<string_view>(out.begin(), out.end()));
+
+    // the contents are replaced, and the capacity is reused
+    const size_t cap = out.capacity();
+    ASSERT_EQ(2u, split_into(string_view("1 2"), ' ', out));
+    ASSERT_EQ("1", out[0]);
+    ASSERT_EQ("2", out[1]);
+    ASSERT_EQ(cap, out.capacity());
+    ASSERT_EQ(0u, split_into(string_view(" , "), ", ", out));
+    ASSERT_TRUE(out.empty());
+
+    // fixed arity, with an early stop
+    std::array<string_view, 3> a;
+    ASSERT_EQ(3u, split_into(string_view("a b c d e"), ' ', a));
+    ASSERT_EQ("a", a[0]);
+    ASSERT_EQ("c", a[2]);
+    ASSERT_EQ(2u, split_into(string_view("x\ty"), " \t", a));
+    ASSERT_EQ("y", a[1]);
+    ASSERT_TRUE(a[2].empty());
+
+    // selected fields
+    std::vector<size_t> idx{1, 3, 6};
+    ASSERT_EQ(2u, split_select(string_view("a,b,c,d,e"), ',', idx, out));
+    ASSERT_EQ(3u, out.size());
+    ASSERT_EQ("b", out[0]);
+    ASSERT_EQ("d", out[1]);
+    ASSERT_TRUE(out[2].empty());
+
+    std::array<size_t, 2> idx2{{0, 2}};
+    ASSERT_EQ(2u, split_select(string_view("10 20 30"), " ", idx2, out));
+    ASSERT_EQ("10", out[0]);
+    ASSERT_EQ("30", out[1]);
+
+    std::vector<size_t> bad{2, 1};
+    ASSERT_THROW(split_select(string_view("a b c"), ' ', bad, out), std::invalid_argument);
 }
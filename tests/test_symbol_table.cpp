@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <clue/symbol_table.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace clue;
+
+using symbol = symbol_table::symbol_type;
+
+TEST(SymbolTable, Empty) {
+    symbol_table t;
+    ASSERT_TRUE(t.empty());
+    ASSERT_EQ(0, t.size());
+    ASSERT_TRUE(t.begin() == t.end());
+    ASSERT_EQ(symbol_table::npos, t.find("a"));
+    ASSERT_FALSE(t.contains("a"));
+    ASSERT_THROW(t.at(0), std::out_of_range);
+}
+
+TEST(SymbolTable, Intern) {
+    symbol_table t;
+    symbol a = t.intern("alpha");
+    symbol b = t.intern("beta");
+    symbol e = t.intern("");
+
+    ASSERT_EQ(0, a);
+    ASSERT_EQ(1, b);
+    ASSERT_EQ(2, e);
+    ASSERT_EQ(3, t.size());
+
+    std::string s("alpha");
+    ASSERT_EQ(a, t.intern(s));
+    ASSERT_EQ(b, t.intern(string_view("--beta--").substr(2, 4)));
+    ASSERT_EQ(e, t.intern(""));
+    ASSERT_EQ(3, t.size());
+
+    ASSERT_EQ("alpha", t.str(a));
+    ASSERT_EQ("beta", t[b]);
+    ASSERT_EQ("", t.at(e));
+    ASSERT_THROW(t.at(3), std::out_of_range);
+    ASSERT_STREQ("beta", t.c_str(b));
+
+    ASSERT_EQ(a, t.find("alpha"));
+    ASSERT_EQ(symbol_table::npos, t.find("alph"));
+    ASSERT_TRUE(t.contains("beta"));
+
+    // interned views point into the table, not to the input
+    string_view v = t.intern_view(s);
+    ASSERT_EQ(t.str(a).data(), v.data());
+    ASSERT_NE(s.data(), v.data());
+
+    std::vector<std::string> all(t.begin(), t.end());
+    ASSERT_EQ((std::vector<std::string>{"alpha", "beta", ""}), all);
+
+    // a failed intern leaves the table (and its usage) unchanged
+    const size_t nb = t.memory_usage().elements;
+    const char* x = "x";
+    ASSERT_THROW(t.intern_hashed(1, string_view(x, size_t(1) << 62)), std::bad_alloc);
+    ASSERT_EQ(3, t.size());
+    ASSERT_EQ(nb, t.memory_usage().elements);
+    ASSERT_EQ(3, t.intern("gamma"));
+}
+
+TEST(SymbolTable, StableViews) {
+    // small blocks, so that many blocks are allocated
+    symbol_table t(64);
+    const int n = 5000;
+    std::vector<string_view> views;
+    for (int i = 0; i < n; ++i) {
+        std::string s = "sym_" + std::to_string(i);
+        if (i % 100 == 0) s += std::string(100, 'x');  // long strings
+        views.push_back(t.intern_view(s));
+    }
+    ASSERT_EQ(n, t.size());
+
+    for (int i = 0; i < n; ++i) {
+        std::string s = "sym_" + std::to_string(i);
+        if (i % 100 == 0) s += std::string(100, 'x');
+        symbol id = t.find(s);
+        ASSERT_EQ(static_cast<symbol>(i), id);
+        ASSERT_EQ(views[i].data(), t.str(id).data());
+        ASSERT_EQ(s, views[i]);
+        ASSERT_EQ('\0', views[i].data()[views[i].size()]);
+    }
+
+    auto u = t.memory_usage();
+    ASSERT_GT(u.elements, 0);
+    ASSERT_GT(u.index, 0);
+
+    // moving keeps the views valid
+    symbol_table t2(std::move(t));
+    ASSERT_EQ(0, t.size());
+    ASSERT_EQ(n, t2.size());
+    ASSERT_EQ(views[10].data(), t2.str(10).data());
+
+    t2.clear();
+    ASSERT_TRUE(t2.empty());
+    ASSERT_EQ(symbol_table::npos, t2.find("sym_1"));
+    ASSERT_EQ(0, t2.intern("sym_1"));
+}
+
+TEST(SymbolTable, WideChars) {
+    wsymbol_table t;
+    ASSERT_EQ(0, t.intern(L"abc"));
+    ASSERT_EQ(1, t.intern(L"xyz"));
+    ASSERT_EQ(0, t.intern(L"abc"));
+    ASSERT_EQ(L"xyz", t.str(1));
+}
+
+TEST(SymbolTable, Concurrent) {
+    concurrent_symbol_table t;
+    const size_t nt = 4;
+    const int n = 2000;
+
+    // all threads intern the same strings (in different orders)
+    std::vector<std::vector<symbol>> ids(nt, std::vector<symbol>(n));
+    std::vector<std::thread> threads;
+    for (size_t k = 0; k < nt; ++k) {
+        threads.emplace_back([&t,&ids,k,n](){
+            for (int j = 0; j < n; ++j) {
+                int i = static_cast<int>((j * 7 + k * 13) % n);
+                ids[k][i] = t.intern("name_" + std::to_string(i));
+            }
+        });
+    }
+    for (std::thread& th: threads) th.join();
+
+    ASSERT_EQ(n, t.size());
+    for (int i = 0; i < n; ++i) {
+        for (size_t k = 1; k < nt; ++k) ASSERT_EQ(ids[0][i], ids[k][i]);
+        ASSERT_EQ("name_" + std::to_string(i), t.str(ids[0][i]));
+        ASSERT_EQ(ids[0][i], t.find("name_" + std::to_string(i)));
+    }
+    ASSERT_EQ(t.str(ids[0][5]).data(), t.intern_view("name_5").data());
+    ASSERT_EQ(concurrent_symbol_table::npos, t.find("other"));
+    ASSERT_EQ(static_cast<size_t>(n), t.snapshot().size());
+}
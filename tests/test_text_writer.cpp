@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <clue/text_writer.hpp>
+#include <clue/textio.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace clue;
+
+template<typename T>
+std::string via_ostream(T x) {
+    std::ostringstream ss;
+    ss << x;
+    return ss.str();
+}
+
+template<typename T>
+std::string via_writer(T x) {
+    text_writer w;
+    w << x;
+    return w.str();
+}
+
+TEST(TextWriter, Strings) {
+    text_writer w;
+    ASSERT_TRUE(w.empty());
+    ASSERT_EQ("", w.str());
+
+    w << 'a' << "bc" << string_view("de") << std::string("fg");
+    w.put('h').write("ijk", 2);
+    ASSERT_EQ(10, w.size());
+    ASSERT_EQ("abcdefghij", w.view());
+
+    w.clear();
+    ASSERT_TRUE(w.empty());
+    w << true << ' ' << false;
+    ASSERT_EQ("true false", w.str());
+
+    // growing
+    text_writer w2;
+    std::string expect;
+    for (int i = 0; i < 1000; ++i) {
+        w2 << "xyz";
+        expect += "xyz";
+    }
+    ASSERT_EQ(expect, w2.str());
+}
+
+TEST(TextWriter, Integers) {
+    std::vector<int64_t> xs{0, 1, 9, 10, 99, 100, 999, 1000, 12345, 99999,
+        123456789, 1000000000, 9876543210LL,
+        std::numeric_limits<int64_t>::max()};
+    for (int64_t x: xs) {
+        ASSERT_EQ(via_ostream(x), via_writer(x));
+        ASSERT_EQ(via_ostream(-x), via_writer(-x));
+        ASSERT_EQ(via_ostream(static_cast<uint64_t>(x)),
+                  via_writer(static_cast<uint64_t>(x)));
+    }
+    ASSERT_EQ(via_ostream(std::numeric_limits<int64_t>::min()),
+              via_writer(std::numeric_limits<int64_t>::min()));
+    ASSERT_EQ(via_ostream(std::numeric_limits<uint64_t>::max()),
+              via_writer(std::numeric_limits<uint64_t>::max()));
+    ASSERT_EQ("-128", via_writer(static_cast<signed char>(-128)));
+    ASSERT_EQ("65535", via_writer(static_cast<unsigned short>(65535)));
+    ASSERT_EQ("-2147483648", via_writer(std::numeric_limits<int>::min()));
+
+    for (int64_t x = -100000; x <= 100000; x += 7) {
+        ASSERT_EQ(std::to_string(x), via_writer(x));
+    }
+}
+
+TEST(TextWriter, Floats) {
+    ASSERT_EQ("0", via_writer(0.0));
+    ASSERT_EQ("1", via_writer(1.0));
+    ASSERT_EQ("-2.5", via_writer(-2.5));
+    ASSERT_EQ("0.1", via_writer(0.1));
+    ASSERT_EQ("1e+100", via_writer(1.0e100));
+    ASSERT_EQ("0.1", via_writer(0.1f));
+    ASSERT_EQ("16777216", via_writer(16777216.0f));
+    ASSERT_EQ("0.33333334", via_writer(1.0f / 3));
+    ASSERT_EQ("0.3333333333333333", via_writer(1.0 / 3));
+    ASSERT_EQ("1e+22", via_writer(1.0e22));
+    ASSERT_EQ("inf", via_writer(std::numeric_limits<double>::infinity()));
+    ASSERT_EQ("nan", via_writer(std::numeric_limits<double>::quiet_NaN()));
+
+    // round trip
+    std::vector<double> xs{1.0 / 3, 0.1 + 0.2, 2.0 / 3 * 1.0e-300,
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::min(),
+        std::numeric_limits<double>::denorm_min()};
+    for (double x: xs) {
+        std::string s = via_writer(x);
+        ASSERT_EQ(x, std::strtod(s.c_str(), nullptr)) << s;
+    }
+
+    // long double
+    ASSERT_EQ("1.5", via_writer(1.5L));
+    ASSERT_EQ("0.1", via_writer(static_cast<long double>(0.1)));
+    ASSERT_EQ("-inf", via_writer(-std::numeric_limits<long double>::infinity()));
+    std::vector<long double> lxs{1.0L / 3, 0.1L, std::numeric_limits<long double>::max()};
+    for (long double x: lxs) {
+        std::string s = via_writer(x);
+        ASSERT_EQ(x, std::strtold(s.c_str(), nullptr)) << s;
+    }
+}
+
+TEST(TextWriter, Helpers) {
+    std::vector<int> xs{1, 2, 3};
+    text_writer w;
+    w << delimits(xs, ", ") << ';' << delimits(std::vector<int>{}, ",") << ';';
+    w << cfmt("%04d", 12) << ' ' << cfmt("%.3f", 2.5);
+    ASSERT_EQ("1, 2, 3;;0012 2.500", w.str());
+
+    // formatting longer than the initial room
+    text_writer w2;
+    w2.printf("%s|%d", std::string(300, 'a').c_str(), 5);
+    ASSERT_EQ(std::string(300, 'a') + "|5", w2.str());
+
+    text_writer w3;
+    std::map<std::string, int> dict{{"a", 1}, {"b", 23}};
+    w3 << stemplate("{{a}} + {{b}}").with(dict);
+    ASSERT_EQ("1 + 23", w3.str());
+}
+
+#ifdef CLUE_HAS_POSIX_IO
+
+TEST(TextWriter, File) {
+    std::string tname = sstr("/tmp/clue_test_text_writer_", time(NULL), ".txt");
+    std::string expect;
+
+    // with a small buffer, so that it is flushed many times
+    {
+        text_writer w(tname, 100);
+        for (int i = 0; i < 1000; ++i) {
+            w << i << ',' << i * 0.5 << '\n';
+            expect += std::to_string(i) + ',' + via_ostream(i * 0.5) + '\n';
+        }
+        std::string big(250, 'z');
+        w << big;   // larger than the buffer
+        expect += big;
+        w << "end";
+        expect += "end";
+    }   // flushed and closed upon destruction
+    ASSERT_EQ(expect, read_file_content(tname));
+
+    {
+        text_writer w(tname);
+        w << "abc";
+        w.close();
+        ASSERT_EQ("abc", read_file_content(tname));
+    }
+
+    // move assignment closes the file of the target first
+    std::string tname2 = tname + ".2";
+    {
+        text_writer w(tname);
+        w << "first";
+        w = text_writer(tname2);
+        ASSERT_EQ("first", read_file_content(tname));
+        w << "second";
+        text_writer m;
+        m << "mem";
+        m = std::move(w);
+        m << '!';
+    }
+    ASSERT_EQ("second!", read_file_content(tname2));
+    std::remove(tname2.c_str());
+    std::remove(tname.c_str());
+
+    ASSERT_THROW(text_writer("/nonexistent_dir/x.txt"), std::runtime_error);
+}
+
+#endif
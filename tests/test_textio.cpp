@@ -40,3 +40,142 @@ TEST(TextIO, LineStream) {
     ASSERT_EQ("xyz\n", lines[3]);
     ASSERT_EQ("12", lines[4]);
 }
+
+TEST(TextIO, LineStreamOfView) {
+    clue::string_view sv("abc\nxyz\n--", 8);
+    clue::line_stream lstr(sv);
+
+    std::vector<std::string> lines(lstr.begin(), lstr.end());
+    ASSERT_EQ(2, lines.size());
+    ASSERT_EQ("abc\n", lines[0]);
+    ASSERT_EQ("xyz\n", lines[1]);
+}
+
+#ifdef CLUE_HAS_MMAP
+
+TEST(TextIO, MappedFile) {
+    std::string tname = clue::sstr(
+        "/tmp/clue_test_mapped_", time(NULL), ".txt");
+    std::ofstream out(tname);
+    out << Text;
+    out.close();
+
+    clue::mapped_file f(tname, clue::mapped_file::sequential |
+                               clue::mapped_file::willneed);
+    ASSERT_EQ(std::strlen(Text), f.size());
+    ASSERT_FALSE(f.empty());
+    ASSERT_EQ(Text, f.view());
+
+    std::vector<std::string> lines;
+    for (clue::string_view line: clue::line_stream(f)) {
+        lines.push_back(line.to_string());
+    }
+    ASSERT_EQ(9, lines.size());
+    ASSERT_EQ("including versions of Lorem Ipsum. \n", lines[8]);
+
+    // moving transfers the mapping
+    const char* p = f.data();
+    clue::mapped_file f2(std::move(f));
+    ASSERT_TRUE(f.empty());
+    ASSERT_EQ(p, f2.data());
+    ASSERT_EQ(Text, clue::string_view(f2));
+
+    // an empty file is mapped to an empty view
+    std::ofstream(tname).close();
+    clue::mapped_file e(tname);
+    ASSERT_TRUE(e.empty());
+    ASSERT_EQ(0, e.view().size());
+    ASSERT_TRUE(clue::line_stream(e).begin() == clue::line_stream(e).end());
+
+    std::remove(tname.c_str());
+    ASSERT_THROW(clue::mapped_file{tname}, std::runtime_error);
+}
+
+#endif
+
+#ifdef CLUE_HAS_POSIX_IO
+
+std::vector<std::string> read_lines_with(const std::string& fname, size_t bufsize, bool direct) {
+    clue::file_line_reader rdr(fname, bufsize, direct);
+    std::vector<std::string> lines;
+    for (clue::string_view line: rdr) {
+        lines.push_back(line.to_string());
+    }
+    return lines;
+}
+
+TEST(TextIO, FileLineReader) {
+    std::string tname = clue::sstr(
+        "/tmp/clue_test_lines_", time(NULL), ".txt");
+
+    // lines of various lengths, some much longer than the buffer
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        text += clue::sstr("line ", i, ' ');
+        text += std::string((i * 37) % 300, 'a' + i % 26);
+        if (i % 500 == 7) text += std::string(20000, 'z');
+        text += '\n';
+    }
+    text += "\n\nlast";
+    {
+        std::ofstream out(tname, std::ios::binary);
+        out << text;
+    }
+
+    clue::line_stream ls(text);
+    std::vector<std::string> expected(ls.begin(), ls.end());
+    ASSERT_EQ(2003, expected.size());
+
+    for (size_t bufsize: {1, 4096, 10000, 1 << 20}) {
+        ASSERT_EQ(expected, read_lines_with(tname, bufsize, false));
+        ASSERT_EQ(expected, read_lines_with(tname, bufsize, true));
+    }
+
+    // the buffer grows only for lines that do not fit
+    {
+        clue::file_line_reader rdr(tname, 8192);
+        clue::string_view line;
+        size_t n = 0;
+        while (rdr.next(line)) ++n;
+        ASSERT_EQ(2003, n);
+        ASSERT_FALSE(rdr.next(line));
+        ASSERT_LE(rdr.buffer_size(), 65536);
+    }
+
+    // an empty file
+    std::ofstream(tname).close();
+    ASSERT_EQ(0, read_lines_with(tname, 4096, false).size());
+
+    std::remove(tname.c_str());
+    ASSERT_THROW(clue::file_line_reader{tname}, std::runtime_error);
+}
+
+#endif
+
+TEST(TextIO, LineOffsets) {
+    using offsets_t = std::vector<uint32_t>;
+    auto offsets = [](const char* s) {
+        clue::fast_vector<uint32_t> r = clue::line_offsets(s);
+        return offsets_t(r.begin(), r.end());
+    };
+
+    ASSERT_EQ(offsets_t{}, offsets(""));
+    ASSERT_EQ(offsets_t{0}, offsets("abc"));
+    ASSERT_EQ(offsets_t{0}, offsets("abc\n"));
+    ASSERT_EQ((offsets_t{0, 4}), offsets("abc\nx"));
+    ASSERT_EQ((offsets_t{0, 1, 2}), offsets("\n\n\n"));
+    ASSERT_EQ((offsets_t{0, 4, 12, 13, 17}), offsets("abc\n  efg  \n\nxyz\n12"));
+
+    // consistent with line_stream
+    std::string text(Text);
+    clue::fast_vector<uint32_t> offs;
+    clue::line_offsets(text, offs);
+    clue::line_stream lstr(text);
+    size_t i = 0;
+    for (clue::string_view line: lstr) {
+        ASSERT_LT(i, offs.size());
+        ASSERT_EQ(text.data() + offs[i], line.data());
+        ++i;
+    }
+    ASSERT_EQ(offs.size(), i);
+}